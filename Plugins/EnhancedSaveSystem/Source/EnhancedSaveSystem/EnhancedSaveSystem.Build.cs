@@ -34,8 +34,12 @@ public class EnhancedSaveSystem : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
+				"CoreOnline",
 				"CoreUObject",
+				"DeveloperSettings",
 				"Engine",
+				"Foliage",
+				"MassEntity",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -0,0 +1,262 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssActorRegistry.h"
+#include "EssSavableInterface.h"
+#include "Engine/Level.h"
+#include "GameFramework/Actor.h"
+
+bool FEssActorRegistry::AddLevel(ULevel* Level)
+{
+	if (!IsValid(Level) || Levels.Contains(Level))
+		return false;
+
+	FEssLevelActors& LevelActors = Levels.Add(Level);
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (!IsValid(Actor) || !IsSavable(Actor))
+			continue;
+
+		LevelActors.Indices.Add(Actor, LevelActors.Actors.Num());
+		LevelActors.Actors.Add(Actor);
+		LevelActors.Keys.Add(Actor);
+		LevelActors.Owners.Add(Actor->GetOwner());
+		AddOwnedActor(Actor->GetOwner(), Actor);
+	}
+
+	return true;
+}
+
+void FEssActorRegistry::RemoveLevel(const ULevel* Level)
+{
+	FEssLevelActors LevelActors;
+	if (!Levels.RemoveAndCopyValue(Level, LevelActors))
+		return;
+
+	// Actors which have already been garbage collected are still removed by their key
+	for (const auto& Pair : LevelActors.Indices)
+		RemoveOwnedActor(LevelActors.Owners[Pair.Value], Pair.Key);
+}
+
+bool FEssActorRegistry::ContainsLevel(const ULevel* Level) const
+{
+	return Levels.Contains(Level);
+}
+
+void FEssActorRegistry::AddActor(AActor* Actor)
+{
+	if (!IsValid(Actor) || !IsSavable(Actor))
+		return;
+
+	// Actors of levels which aren't registered yet are picked up when the level is
+	FEssLevelActors* LevelActors = Levels.Find(Actor->GetLevel());
+	if (!LevelActors || LevelActors->Indices.Contains(Actor))
+		return;
+
+	LevelActors->Indices.Add(Actor, LevelActors->Actors.Num());
+	LevelActors->Actors.Add(Actor);
+	LevelActors->Keys.Add(Actor);
+	LevelActors->Owners.Add(Actor->GetOwner());
+	AddOwnedActor(Actor->GetOwner(), Actor);
+}
+
+void FEssActorRegistry::RemoveActor(const AActor* Actor)
+{
+	if (!Actor)
+		return;
+
+	FEssLevelActors* LevelActors = Levels.Find(Actor->GetLevel());
+	if (!LevelActors)
+		return;
+
+	int32 Index;
+	if (!LevelActors->Indices.RemoveAndCopyValue(Actor, Index) || !LevelActors->Actors.IsValidIndex(Index))
+		return;
+
+	RemoveOwnedActor(LevelActors->Owners[Index], Actor);
+
+	LevelActors->Actors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LevelActors->Keys.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LevelActors->Owners.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// Removal by swap moved the last actor into the freed slot, which must be re-indexed even if it has been garbage collected
+	if (LevelActors->Keys.IsValidIndex(Index))
+		LevelActors->Indices.Add(LevelActors->Keys[Index], Index);
+}
+
+bool FEssActorRegistry::ContainsActor(const AActor* Actor) const
+{
+	const FEssLevelActors* LevelActors = Actor ? Levels.Find(Actor->GetLevel()) : nullptr;
+	return LevelActors && LevelActors->Indices.Contains(Actor);
+}
+
+void FEssActorRegistry::RefreshOwners()
+{
+	for (auto& Pair : Levels)
+	{
+		FEssLevelActors& LevelActors = Pair.Value;
+		for (int32 i = 0; i < LevelActors.Actors.Num(); ++i)
+		{
+			const AActor* Actor = LevelActors.Actors[i].Get();
+			if (!Actor)
+				continue;
+
+			const TObjectKey<AActor> Owner(Actor->GetOwner());
+			if (Owner == LevelActors.Owners[i])
+				continue;
+
+			RemoveOwnedActor(LevelActors.Owners[i], Actor);
+			AddOwnedActor(Owner, Actor);
+			LevelActors.Owners[i] = Owner;
+		}
+	}
+}
+
+void FEssActorRegistry::GetOwners(TArray<AActor*>& OutOwners) const
+{
+	OutOwners.Reset(OwnedActors.Num());
+	for (const auto& Pair : OwnedActors)
+	{
+		AActor* Owner = Pair.Key.ResolveObjectPtr();
+		if (IsValid(Owner))
+			OutOwners.Add(Owner);
+	}
+}
+
+void FEssActorRegistry::GetOwnedActors(const AActor* Owner, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+
+	const TArray<TObjectKey<AActor>>* Actors = OwnedActors.Find(Owner);
+	if (!Actors)
+		return;
+
+	for (const TObjectKey<AActor>& Actor : *Actors)
+	{
+		AActor* ValidActor = Actor.ResolveObjectPtr();
+		if (IsValid(ValidActor))
+			OutActors.Add(ValidActor);
+	}
+}
+
+void FEssActorRegistry::AddOwnedActor(const TObjectKey<AActor> Owner, const TObjectKey<AActor> Actor)
+{
+	if (Owner != TObjectKey<AActor>())
+		OwnedActors.FindOrAdd(Owner).Add(Actor);
+}
+
+void FEssActorRegistry::RemoveOwnedActor(const TObjectKey<AActor> Owner, const TObjectKey<AActor> Actor)
+{
+	TArray<TObjectKey<AActor>>* Actors = OwnedActors.Find(Owner);
+	if (!Actors)
+		return;
+
+	Actors->RemoveSingleSwap(Actor, EAllowShrinking::No);
+	if (Actors->IsEmpty())
+		OwnedActors.Remove(Owner);
+}
+
+void FEssActorRegistry::Reset()
+{
+	Levels.Reset();
+	OwnedActors.Reset();
+}
+
+void FEssActorRegistry::GetActors(const ULevel* Level, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+
+	const FEssLevelActors* LevelActors = Levels.Find(Level);
+	if (!LevelActors)
+		return;
+
+	OutActors.Reserve(LevelActors->Actors.Num());
+	for (const TWeakObjectPtr<AActor>& Actor : LevelActors->Actors)
+	{
+		if (AActor* ValidActor = Actor.Get())
+			OutActors.Add(ValidActor);
+	}
+}
+
+int32 FEssActorRegistry::GetNumActors(const ULevel* Level) const
+{
+	const FEssLevelActors* LevelActors = Levels.Find(Level);
+	return LevelActors ? LevelActors->Actors.Num() : 0;
+}
+
+int32 FEssActorRegistry::GetNumActors() const
+{
+	int32 Num = 0;
+	for (const auto& Pair : Levels)
+		Num += Pair.Value.Actors.Num();
+
+	return Num;
+}
+
+void FEssActorRegistry::SetPlacedActorBaselines(const ULevel* Level, TMap<FName, FEssPlacedActorData>&& Baselines, FEssReferenceTable&& References)
+{
+	if (FEssLevelActors* LevelActors = Levels.Find(Level))
+	{
+		LevelActors->PlacedActorBaselines = MoveTemp(Baselines);
+		LevelActors->PlacedActorBaselineReferences = MoveTemp(References);
+		LevelActors->BaselineFrame = GFrameCounter;
+	}
+}
+
+const TMap<FName, FEssPlacedActorData>* FEssActorRegistry::GetPlacedActorBaselines(const ULevel* Level) const
+{
+	const FEssLevelActors* LevelActors = Levels.Find(Level);
+	return LevelActors ? LevelActors->PlacedActorBaselines.GetPtrOrNull() : nullptr;
+}
+
+FEssReferenceTable* FEssActorRegistry::GetPlacedActorBaselineReferences(const ULevel* Level)
+{
+	FEssLevelActors* LevelActors = Levels.Find(Level);
+	return LevelActors && LevelActors->PlacedActorBaselines.IsSet() ? &LevelActors->PlacedActorBaselineReferences : nullptr;
+}
+
+bool FEssActorRegistry::MatchesPlacedActorBaselines(const ULevel* Level) const
+{
+	const FEssLevelActors* LevelActors = Levels.Find(Level);
+	return LevelActors && LevelActors->PlacedActorBaselines.IsSet() && LevelActors->BaselineFrame == GFrameCounter;
+}
+
+void FEssActorRegistry::MarkRestored(const ULevel* Level)
+{
+	if (FEssLevelActors* LevelActors = Levels.Find(Level))
+		LevelActors->BaselineFrame = MAX_uint64;
+}
+
+void FEssActorRegistry::SetInstanceComponents(const ULevel* Level, TArray<FEssInstanceComponent>&& InstanceComponents)
+{
+	if (FEssLevelActors* LevelActors = Levels.Find(Level))
+		LevelActors->InstanceComponents = MoveTemp(InstanceComponents);
+}
+
+const TArray<FEssInstanceComponent>* FEssActorRegistry::GetInstanceComponents(const ULevel* Level) const
+{
+	const FEssLevelActors* LevelActors = Levels.Find(Level);
+	return LevelActors ? &LevelActors->InstanceComponents : nullptr;
+}
+
+bool FEssActorRegistry::IsSavable(const AActor* Actor)
+{
+	return Actor->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass());
+}
+
+void FEssActorRegistry::ForEachSavableComponent(const AActor* Actor, TFunctionRef<void(UActorComponent*)> Function)
+{
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (!IsValid(Component))
+			continue;
+
+		UClass* Class = Component->GetClass();
+		bool* bSavable = SavableComponentClasses.Find(Class);
+		if (!bSavable)
+			bSavable = &SavableComponentClasses.Add(Class, Class->ImplementsInterface(UEssSavableInterface::StaticClass()));
+
+		if (*bSavable)
+			Function(Component);
+	}
+}
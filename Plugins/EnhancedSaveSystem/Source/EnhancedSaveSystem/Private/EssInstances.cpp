@@ -0,0 +1,214 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssInstances.h"
+#include "EssActorRegistry.h"
+#include "EssSaveData.h"
+#include "EssSettings.h"
+#include "EssStats.h"
+#include "EssUtil.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "InstancedFoliageActor.h"
+
+const FName FEssInstances::ComponentTag(TEXT("EssInstances"));
+
+bool FEssInstances::IsSavable(const UInstancedStaticMeshComponent* Component)
+{
+	if (!IsValid(Component) || Component->IsTemplate())
+		return false;
+
+	// Components are found again by their owner's name, which only placed actors keep across loads
+	const AActor* Owner = Component->GetOwner();
+	if (!IsValid(Owner) || EssUtil::IsRuntimeActor(Owner))
+		return false;
+
+	return Component->ComponentHasTag(ComponentTag) || (GetDefault<UEssSettings>()->bSaveFoliageInstances && Owner->IsA<AInstancedFoliageActor>());
+}
+
+FEssInstanceComponent FEssInstances::CaptureAuthored(UInstancedStaticMeshComponent* Component)
+{
+	FEssInstanceComponent InstanceComponent;
+	InstanceComponent.Component = Component;
+	PackInstances(Component, InstanceComponent.AuthoredInstances);
+	BuildLookup(InstanceComponent.AuthoredInstances, InstanceComponent.AuthoredLookup);
+
+	return InstanceComponent;
+}
+
+bool FEssInstances::Extract(const FEssInstanceComponent& InstanceComponent, FEssInstancesData& OutData)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssExtractInstances);
+
+	const UInstancedStaticMeshComponent* Component = InstanceComponent.Component.Get();
+	if (!IsValid(Component))
+		return false;
+
+	TArray<float> Instances;
+	PackInstances(Component, Instances);
+
+	TArray<int32> AddedIndices;
+	OutData.ActorName = Component->GetOwner()->GetFName();
+	OutData.ComponentName = Component->GetFName();
+	OutData.NumAuthoredInstances = InstanceComponent.AuthoredInstances.Num() / NumPackedFloats;
+	MatchInstances(Instances, InstanceComponent.AuthoredInstances, InstanceComponent.AuthoredLookup, AddedIndices, OutData.RemovedInstances);
+
+	OutData.AddedInstances.Reset(AddedIndices.Num() * NumPackedFloats);
+	for (const int32 Index : AddedIndices)
+		OutData.AddedInstances.Append(&Instances[Index * NumPackedFloats], NumPackedFloats);
+
+	return OutData.RemovedInstances.Num() > 0 || OutData.AddedInstances.Num() > 0;
+}
+
+int32 FEssInstances::Restore(const FEssInstanceComponent& InstanceComponent, const FEssInstancesData* Data)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreInstances);
+
+	UInstancedStaticMeshComponent* Component = InstanceComponent.Component.Get();
+	if (!IsValid(Component))
+		return INDEX_NONE;
+
+	const TArray<float>& AuthoredInstances = InstanceComponent.AuthoredInstances;
+	const int32 NumAuthoredInstances = AuthoredInstances.Num() / NumPackedFloats;
+
+	TArray<float> Instances;
+	if (!Data)
+	{
+		Instances = AuthoredInstances;
+	}
+	else
+	{
+		// Removed indices only make sense for the level-authored instances they were saved against
+		if (Data->NumAuthoredInstances != NumAuthoredInstances)
+		{
+			UE_LOG(LogEss, Warning, TEXT("Instances of %s not loaded. The level has %d authored instances instead of %d."),
+				*Component->GetPathName(), NumAuthoredInstances, Data->NumAuthoredInstances);
+			return INDEX_NONE;
+		}
+
+		Instances.Reserve(AuthoredInstances.Num() + Data->AddedInstances.Num());
+
+		int32 NextRemoved = 0;
+		for (int32 i = 0; i < NumAuthoredInstances; ++i)
+		{
+			if (Data->RemovedInstances.IsValidIndex(NextRemoved) && Data->RemovedInstances[NextRemoved] == i)
+			{
+				++NextRemoved;
+				continue;
+			}
+
+			Instances.Append(&AuthoredInstances[i * NumPackedFloats], NumPackedFloats);
+		}
+
+		Instances.Append(Data->AddedInstances.GetData(), Data->AddedInstances.Num() - Data->AddedInstances.Num() % NumPackedFloats);
+	}
+
+	TArray<float> CurrentInstances;
+	PackInstances(Component, CurrentInstances);
+
+	TMultiMap<uint32, int32> Lookup;
+	BuildLookup(Instances, Lookup);
+
+	// Only the difference to the current instances is applied, so unchanged instances keep their exact transforms
+	TArray<int32> InstancesToRemove;
+	TArray<int32> InstancesToAdd;
+	MatchInstances(CurrentInstances, Instances, Lookup, InstancesToRemove, InstancesToAdd);
+
+	if (InstancesToRemove.Num() > 0)
+		Component->RemoveInstances(InstancesToRemove);
+
+	if (InstancesToAdd.Num() > 0)
+	{
+		TArray<FTransform> Transforms;
+		Transforms.Reserve(InstancesToAdd.Num());
+		for (const int32 Index : InstancesToAdd)
+		{
+			const float* Instance = &Instances[Index * NumPackedFloats];
+			Transforms.Emplace(
+				FQuat(Instance[3], Instance[4], Instance[5], Instance[6]),
+				FVector(Instance[0], Instance[1], Instance[2]),
+				FVector(Instance[7], Instance[8], Instance[9]));
+		}
+
+		Component->AddInstances(Transforms, false);
+	}
+
+	INC_DWORD_STAT_BY(STAT_EssInstancesRestored, InstancesToRemove.Num() + InstancesToAdd.Num());
+	return Instances.Num() / NumPackedFloats;
+}
+
+void FEssInstances::PackInstances(const UInstancedStaticMeshComponent* Component, TArray<float>& OutInstances)
+{
+	const int32 NumInstances = Component->PerInstanceSMData.Num();
+	OutInstances.SetNumUninitialized(NumInstances * NumPackedFloats);
+
+	for (int32 i = 0; i < NumInstances; ++i)
+	{
+		const FTransform Transform(Component->PerInstanceSMData[i].Transform);
+		const FVector Location = Transform.GetLocation();
+		const FQuat Rotation = Transform.GetRotation();
+		const FVector Scale = Transform.GetScale3D();
+
+		float* Instance = &OutInstances[i * NumPackedFloats];
+		Instance[0] = Location.X;
+		Instance[1] = Location.Y;
+		Instance[2] = Location.Z;
+		Instance[3] = Rotation.X;
+		Instance[4] = Rotation.Y;
+		Instance[5] = Rotation.Z;
+		Instance[6] = Rotation.W;
+		Instance[7] = Scale.X;
+		Instance[8] = Scale.Y;
+		Instance[9] = Scale.Z;
+	}
+}
+
+void FEssInstances::BuildLookup(const TArray<float>& Instances, TMultiMap<uint32, int32>& OutLookup)
+{
+	const int32 NumInstances = Instances.Num() / NumPackedFloats;
+	OutLookup.Reset();
+	OutLookup.Reserve(NumInstances);
+
+	for (int32 i = 0; i < NumInstances; ++i)
+		OutLookup.Add(HashInstance(&Instances[i * NumPackedFloats]), i);
+}
+
+void FEssInstances::MatchInstances(const TArray<float>& From, const TArray<float>& To, const TMultiMap<uint32, int32>& ToLookup, TArray<int32>& OutUnmatchedFrom, TArray<int32>& OutUnmatchedTo)
+{
+	const int32 NumFrom = From.Num() / NumPackedFloats;
+	const int32 NumTo = To.Num() / NumPackedFloats;
+
+	OutUnmatchedFrom.Reset();
+	OutUnmatchedTo.Reset();
+
+	// Instances match if their packed floats are exactly the same, every instance of To is matched at most once
+	TBitArray<> Matched(false, NumTo);
+	for (int32 i = 0; i < NumFrom; ++i)
+	{
+		const float* Instance = &From[i * NumPackedFloats];
+
+		bool bFound = false;
+		for (auto It = ToLookup.CreateConstKeyIterator(HashInstance(Instance)); It; ++It)
+		{
+			const int32 ToIndex = It.Value();
+			if (!Matched[ToIndex] && FMemory::Memcmp(Instance, &To[ToIndex * NumPackedFloats], NumPackedFloats * sizeof(float)) == 0)
+			{
+				Matched[ToIndex] = true;
+				bFound = true;
+				break;
+			}
+		}
+
+		if (!bFound)
+			OutUnmatchedFrom.Add(i);
+	}
+
+	for (int32 i = 0; i < NumTo; ++i)
+	{
+		if (!Matched[i])
+			OutUnmatchedTo.Add(i);
+	}
+}
+
+uint32 FEssInstances::HashInstance(const float* Instance)
+{
+	return FCrc::MemCrc32(Instance, NumPackedFloats * sizeof(float));
+}
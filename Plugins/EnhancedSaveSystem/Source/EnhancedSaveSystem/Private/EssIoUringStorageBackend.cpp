@@ -0,0 +1,678 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssStorage.h"
+#include "EssSettings.h"
+#include "EssStats.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace EssIoUring
+{
+	// Kernel ABI of io_uring, declared here because the kernel headers of the toolchain may predate it
+	constexpr long SetupSyscall = 425;
+	constexpr long EnterSyscall = 426;
+	constexpr long RegisterSyscall = 427;
+
+	constexpr uint8 OpFsync = 3;
+	constexpr uint8 OpAsyncCancel = 14;
+	constexpr uint8 OpWrite = 23;
+	constexpr uint8 OpRenameAt = 35;
+
+	constexpr uint8 SqeIoLink = 1 << 2;
+	constexpr uint32 FsyncDataSync = 1;
+	constexpr uint32 EnterGetEvents = 1;
+	constexpr uint32 FeatSingleMmap = 1;
+	constexpr uint32 RegisterProbe = 8;
+	constexpr uint16 OpSupported = 1;
+
+	/** User data of cancellations, which don't belong to any slot. */
+	constexpr uint64 CancelUserData = MAX_uint64;
+
+	constexpr off_t OffSqRing = 0;
+	constexpr off_t OffCqRing = 0x8000000;
+	constexpr off_t OffSqes = 0x10000000;
+
+	struct FSqRingOffsets
+	{
+		uint32 Head;
+		uint32 Tail;
+		uint32 RingMask;
+		uint32 RingEntries;
+		uint32 Flags;
+		uint32 Dropped;
+		uint32 Array;
+		uint32 Resv1;
+		uint64 UserAddr;
+	};
+
+	struct FCqRingOffsets
+	{
+		uint32 Head;
+		uint32 Tail;
+		uint32 RingMask;
+		uint32 RingEntries;
+		uint32 Overflow;
+		uint32 Cqes;
+		uint32 Flags;
+		uint32 Resv1;
+		uint64 UserAddr;
+	};
+
+	struct FParams
+	{
+		uint32 SqEntries;
+		uint32 CqEntries;
+		uint32 Flags;
+		uint32 SqThreadCpu;
+		uint32 SqThreadIdle;
+		uint32 Features;
+		uint32 WqFd;
+		uint32 Resv[3];
+		FSqRingOffsets SqOff;
+		FCqRingOffsets CqOff;
+	};
+
+	struct FSqe
+	{
+		uint8 Opcode;
+		uint8 Flags;
+		uint16 IoPrio;
+		int32 Fd;
+		uint64 Off;
+		uint64 Addr;
+		uint32 Len;
+		uint32 OpFlags;
+		uint64 UserData;
+		uint16 BufIndex;
+		uint16 Personality;
+		int32 SpliceFdIn;
+		uint64 Addr3;
+		uint64 Pad;
+	};
+
+	struct FCqe
+	{
+		uint64 UserData;
+		int32 Res;
+		uint32 Flags;
+	};
+
+	struct FProbeOp
+	{
+		uint8 Op;
+		uint8 Resv;
+		uint16 Flags;
+		uint32 Resv2;
+	};
+
+	struct FProbe
+	{
+		uint8 LastOp;
+		uint8 OpsLen;
+		uint16 Resv;
+		uint32 Resv2[3];
+		FProbeOp Ops[256];
+	};
+
+	static_assert(sizeof(FParams) == 120, "io_uring_params layout mismatch");
+	static_assert(sizeof(FSqe) == 64, "io_uring_sqe layout mismatch");
+	static_assert(sizeof(FCqe) == 16, "io_uring_cqe layout mismatch");
+
+	/** Smallest chunk a slot is written in. Larger slots use larger chunks, so their chain still fits into the ring. */
+	constexpr int64 MinChunkSize = 1024 * 1024;
+
+	/**
+	 * Submission and completion queue shared with the kernel. Only used by the thread which created it.
+	 */
+	class FRing
+	{
+	public:
+		~FRing()
+		{
+			if (Sqes)
+				munmap(Sqes, SqesSize);
+			if (CqRing && CqRing != SqRing)
+				munmap(CqRing, CqRingSize);
+			if (SqRing)
+				munmap(SqRing, SqRingSize);
+			if (Fd >= 0)
+				close(Fd);
+		}
+
+		bool Init(const uint32 Entries)
+		{
+			FParams Params;
+			FMemory::Memzero(Params);
+
+			Fd = syscall(SetupSyscall, Entries, &Params);
+			if (Fd < 0)
+				return false;
+
+			SqRingSize = Params.SqOff.Array + Params.SqEntries * sizeof(uint32);
+			CqRingSize = Params.CqOff.Cqes + Params.CqEntries * sizeof(FCqe);
+			SqesSize = Params.SqEntries * sizeof(FSqe);
+
+			const bool bSingleMmap = (Params.Features & FeatSingleMmap) != 0;
+			if (bSingleMmap)
+				SqRingSize = CqRingSize = FMath::Max(SqRingSize, CqRingSize);
+
+			SqRing = Map(SqRingSize, OffSqRing);
+			CqRing = bSingleMmap ? SqRing : Map(CqRingSize, OffCqRing);
+			Sqes = static_cast<FSqe*>(Map(SqesSize, OffSqes));
+			if (!SqRing || !CqRing || !Sqes)
+				return false;
+
+			uint8* Sq = static_cast<uint8*>(SqRing);
+			SqHead = reinterpret_cast<uint32*>(Sq + Params.SqOff.Head);
+			SqTail = reinterpret_cast<uint32*>(Sq + Params.SqOff.Tail);
+			SqMask = *reinterpret_cast<uint32*>(Sq + Params.SqOff.RingMask);
+			SqArray = reinterpret_cast<uint32*>(Sq + Params.SqOff.Array);
+
+			uint8* Cq = static_cast<uint8*>(CqRing);
+			CqHead = reinterpret_cast<uint32*>(Cq + Params.CqOff.Head);
+			CqTail = reinterpret_cast<uint32*>(Cq + Params.CqOff.Tail);
+			CqMask = *reinterpret_cast<uint32*>(Cq + Params.CqOff.RingMask);
+			Cqes = reinterpret_cast<FCqe*>(Cq + Params.CqOff.Cqes);
+
+			NumEntries = Params.SqEntries;
+			LocalTail = *SqTail;
+			return true;
+		}
+
+		/**
+		 * The completion queue is twice as large as the submission queue, so it can't overflow while no more than this many operations are in flight.
+		 */
+		uint32 GetNumEntries() const { return NumEntries; }
+
+		/**
+		 * @return Cleared entry to fill in, null if the submission queue is full.
+		 */
+		FSqe* GetSqe()
+		{
+			if (LocalTail - __atomic_load_n(SqHead, __ATOMIC_ACQUIRE) >= NumEntries)
+				return nullptr;
+
+			const uint32 Index = LocalTail & SqMask;
+			SqArray[Index] = Index;
+			++LocalTail;
+
+			FSqe* Sqe = &Sqes[Index];
+			FMemory::Memzero(*Sqe);
+			return Sqe;
+		}
+
+		/**
+		 * Submits all queued entries and waits for at least MinComplete completions.
+		 * @return Negative error number on failure.
+		 */
+		int32 Submit(const uint32 MinComplete)
+		{
+			__atomic_store_n(SqTail, LocalTail, __ATOMIC_RELEASE);
+			const uint32 NumToSubmit = LocalTail - __atomic_load_n(SqHead, __ATOMIC_ACQUIRE);
+
+			int32 Result;
+			do
+			{
+				Result = syscall(EnterSyscall, Fd, NumToSubmit, MinComplete, MinComplete > 0 ? EnterGetEvents : 0, nullptr, 0);
+			}
+			while (Result < 0 && errno == EINTR);
+
+			return Result < 0 ? -errno : Result;
+		}
+
+		/**
+		 * Takes back the queued entries the kernel hasn't consumed, after a submission failed.
+		 * @param OutUserData User data of the withdrawn entries.
+		 */
+		void Withdraw(TArray<uint64>& OutUserData)
+		{
+			const uint32 Head = __atomic_load_n(SqHead, __ATOMIC_ACQUIRE);
+			for (uint32 Tail = Head; Tail != LocalTail; ++Tail)
+				OutUserData.Add(Sqes[SqArray[Tail & SqMask]].UserData);
+
+			LocalTail = Head;
+			__atomic_store_n(SqTail, LocalTail, __ATOMIC_RELEASE);
+		}
+
+		bool PopCqe(FCqe& OutCqe)
+		{
+			const uint32 Head = *CqHead;
+			if (Head == __atomic_load_n(CqTail, __ATOMIC_ACQUIRE))
+				return false;
+
+			OutCqe = Cqes[Head & CqMask];
+			__atomic_store_n(CqHead, Head + 1, __ATOMIC_RELEASE);
+			return true;
+		}
+
+		bool SupportsOp(const uint8 Op) const
+		{
+			FProbe Probe;
+			FMemory::Memzero(Probe);
+			if (syscall(RegisterSyscall, Fd, RegisterProbe, &Probe, 256) < 0)
+				return false;
+
+			return Op <= Probe.LastOp && Op < Probe.OpsLen && (Probe.Ops[Op].Flags & OpSupported) != 0;
+		}
+
+	private:
+		void* Map(const SIZE_T Size, const off_t Offset) const
+		{
+			void* Memory = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Fd, Offset);
+			return Memory == MAP_FAILED ? nullptr : Memory;
+		}
+
+		int32 Fd = -1;
+		uint32 NumEntries = 0;
+		uint32 LocalTail = 0;
+
+		void* SqRing = nullptr;
+		SIZE_T SqRingSize = 0;
+		uint32* SqHead = nullptr;
+		uint32* SqTail = nullptr;
+		uint32 SqMask = 0;
+		uint32* SqArray = nullptr;
+		FSqe* Sqes = nullptr;
+		SIZE_T SqesSize = 0;
+
+		void* CqRing = nullptr;
+		SIZE_T CqRingSize = 0;
+		uint32* CqHead = nullptr;
+		uint32* CqTail = nullptr;
+		uint32 CqMask = 0;
+		FCqe* Cqes = nullptr;
+	};
+
+	struct FSupport
+	{
+		bool bAvailable = false;
+
+		/** Renames through io_uring need Linux 5.11, older kernels rename once the chain of a slot has completed. */
+		bool bRenameAt = false;
+	};
+
+	const FSupport& GetSupport()
+	{
+		static const FSupport Support = []()
+		{
+			FSupport Result;
+
+			FRing Ring;
+			if (!Ring.Init(2) || !Ring.SupportsOp(OpWrite) || !Ring.SupportsOp(OpFsync))
+			{
+				UE_LOG(LogEss, Warning, TEXT("io_uring is not available. Slots are written through the save game system."));
+				return Result;
+			}
+
+			Result.bAvailable = true;
+			Result.bRenameAt = Ring.SupportsOp(OpRenameAt);
+			return Result;
+		}();
+
+		return Support;
+	}
+
+	/**
+	 * A single slot of a batch, written as a chain of chunk writes, an optional sync, and the rename over the slot.
+	 */
+	struct FSlot
+	{
+		FEssSlotWrite* Write = nullptr;
+		TArray<ANSICHAR> FilePath;
+		TArray<ANSICHAR> TempFilePath;
+		int32 Fd = -1;
+		int64 ChunkSize = 0;
+		int32 NumChunks = 0;
+		int32 NumOps = 0;
+		int32 NumPendingOps = 0;
+		bool bRenameInRing = false;
+		bool bFailed = false;
+		bool bRenamed = false;
+		bool bFinished = false;
+
+		int64 GetChunkLength(const int32 Chunk) const
+		{
+			return FMath::Min(ChunkSize, Write->Bytes->Num() - Chunk * ChunkSize);
+		}
+	};
+
+	TArray<ANSICHAR> ToNativePath(const FString& Path)
+	{
+		FTCHARToUTF8 Converted(*FPaths::ConvertRelativePathToFull(Path));
+
+		TArray<ANSICHAR> NativePath;
+		NativePath.Append(reinterpret_cast<const ANSICHAR*>(Converted.Get()), Converted.Length() + 1);
+		return NativePath;
+	}
+
+	void FinishSlot(FSlot& Slot)
+	{
+		if (Slot.Fd >= 0)
+		{
+			if (close(Slot.Fd) != 0 && !Slot.bRenamed)
+				Slot.bFailed = true;
+
+			Slot.Fd = -1;
+		}
+
+		if (!Slot.bFailed && !Slot.bRenamed)
+			Slot.bRenamed = rename(Slot.TempFilePath.GetData(), Slot.FilePath.GetData()) == 0;
+
+		if (!Slot.bRenamed)
+			unlink(Slot.TempFilePath.GetData());
+
+		Slot.Write->bSucceeded = Slot.bRenamed && !Slot.bFailed;
+		Slot.bFinished = true;
+	}
+
+	/**
+	 * @return False if the slot has been finished without any operation in the ring.
+	 */
+	bool QueueSlot(FRing& Ring, FSlot& Slot, const uint64 SlotIndex, const bool bSync)
+	{
+		Slot.Fd = open(Slot.TempFilePath.GetData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (Slot.Fd < 0)
+		{
+			Slot.bFailed = true;
+			FinishSlot(Slot);
+			return false;
+		}
+
+		if (Slot.NumOps == 0)
+		{
+			FinishSlot(Slot);
+			return false;
+		}
+
+		const uint8* Bytes = Slot.Write->Bytes->GetData();
+		FSqe* Sqe = nullptr;
+
+		for (int32 Chunk = 0; Chunk < Slot.NumChunks; ++Chunk)
+		{
+			Sqe = Ring.GetSqe();
+			Sqe->Opcode = OpWrite;
+			Sqe->Flags = SqeIoLink;
+			Sqe->Fd = Slot.Fd;
+			Sqe->Off = Chunk * Slot.ChunkSize;
+			Sqe->Addr = reinterpret_cast<uint64>(Bytes + Chunk * Slot.ChunkSize);
+			Sqe->Len = static_cast<uint32>(Slot.GetChunkLength(Chunk));
+			Sqe->UserData = (SlotIndex << 32) | Chunk;
+		}
+
+		if (bSync)
+		{
+			Sqe = Ring.GetSqe();
+			Sqe->Opcode = OpFsync;
+			Sqe->Flags = SqeIoLink;
+			Sqe->Fd = Slot.Fd;
+			Sqe->OpFlags = FsyncDataSync;
+			Sqe->UserData = (SlotIndex << 32) | Slot.NumChunks;
+		}
+
+		if (Slot.bRenameInRing)
+		{
+			Sqe = Ring.GetSqe();
+			Sqe->Opcode = OpRenameAt;
+			Sqe->Fd = AT_FDCWD;
+			Sqe->Addr = reinterpret_cast<uint64>(Slot.TempFilePath.GetData());
+			Sqe->Len = static_cast<uint32>(AT_FDCWD);
+			Sqe->Off = reinterpret_cast<uint64>(Slot.FilePath.GetData());
+			Sqe->UserData = (SlotIndex << 32) | (Slot.NumOps - 1);
+		}
+
+		// A failed or short operation cancels the rest of its chain, so a slot is never replaced by a partial file
+		Sqe->Flags &= ~SqeIoLink;
+		Slot.NumPendingOps = Slot.NumOps;
+		return true;
+	}
+
+	void CompleteOp(FSlot& Slot, const int32 Op, const int32 Result)
+	{
+		if (Result < 0 || (Op < Slot.NumChunks && Result != Slot.GetChunkLength(Op)))
+			Slot.bFailed = true;
+		else if (Slot.bRenameInRing && Op == Slot.NumOps - 1)
+			Slot.bRenamed = true;
+
+		if (--Slot.NumPendingOps == 0)
+			FinishSlot(Slot);
+	}
+
+	/**
+	 * Stops the batch after the ring failed to submit. The kernel keeps reading the paths and bytes of the operations it has consumed,
+	 * so this only returns once every one of them has completed.
+	 */
+	void AbortSlots(FRing& Ring, TArray<FSlot>& Slots, uint32& NumInFlight)
+	{
+		// Entries the kernel hasn't consumed never start, their slots fail right away
+		TArray<uint64> Withdrawn;
+		Ring.Withdraw(Withdrawn);
+		for (const uint64 UserData : Withdrawn)
+		{
+			--NumInFlight;
+			CompleteOp(Slots[UserData >> 32], static_cast<int32>(UserData & 0xffffffff), -ECANCELED);
+		}
+
+		// Operations of a chain complete in order, so cancelling the first pending one fails the rest of its chain as well
+		uint32 NumCancels = 0;
+		for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+		{
+			const FSlot& Slot = Slots[SlotIndex];
+			if (Slot.NumPendingOps == 0)
+				continue;
+
+			FSqe* Sqe = Ring.GetSqe();
+			if (!Sqe)
+				break;
+
+			Sqe->Opcode = OpAsyncCancel;
+			Sqe->Fd = -1;
+			Sqe->Addr = (static_cast<uint64>(SlotIndex) << 32) | (Slot.NumOps - Slot.NumPendingOps);
+			Sqe->UserData = CancelUserData;
+			++NumCancels;
+		}
+
+		while (NumInFlight > 0 || NumCancels > 0)
+		{
+			const int32 Result = Ring.Submit(1);
+			if (Result < 0 && Result != -EAGAIN && Result != -EBUSY)
+			{
+				// Without cancellations the operations still complete on their own, only waiting for them is left
+				Withdrawn.Reset();
+				Ring.Withdraw(Withdrawn);
+				NumCancels -= Withdrawn.Num();
+			}
+
+			FCqe Cqe;
+			while (Ring.PopCqe(Cqe))
+			{
+				if (Cqe.UserData == CancelUserData)
+				{
+					--NumCancels;
+					continue;
+				}
+
+				--NumInFlight;
+				CompleteOp(Slots[Cqe.UserData >> 32], static_cast<int32>(Cqe.UserData & 0xffffffff), Cqe.Res);
+			}
+		}
+	}
+
+	/**
+	 * Syncs the directory of the slots, so the renames survive a crash as well.
+	 */
+	void SyncDirectory(const FString& Directory)
+	{
+		const int32 DirectoryFd = open(ToNativePath(Directory).GetData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (DirectoryFd < 0)
+			return;
+
+		fsync(DirectoryFd);
+		close(DirectoryFd);
+	}
+}
+#endif
+
+bool FEssIoUringStorageBackend::DoesSlotExist(const FString& SlotName, const int32 UserIndex)
+{
+#if PLATFORM_LINUX
+	return IFileManager::Get().FileExists(*GetFilePath(SlotName));
+#else
+	return Fallback.DoesSlotExist(SlotName, UserIndex);
+#endif
+}
+
+bool FEssIoUringStorageBackend::Read(const FString& SlotName, const int32 UserIndex, TArray<uint8>& OutBytes)
+{
+#if PLATFORM_LINUX
+	return FFileHelper::LoadFileToArray(OutBytes, *GetFilePath(SlotName), FILEREAD_Silent);
+#else
+	return Fallback.Read(SlotName, UserIndex, OutBytes);
+#endif
+}
+
+bool FEssIoUringStorageBackend::Delete(const FString& SlotName, const int32 UserIndex)
+{
+#if PLATFORM_LINUX
+	return IFileManager::Get().Delete(*GetFilePath(SlotName), false, true, true);
+#else
+	return Fallback.Delete(SlotName, UserIndex);
+#endif
+}
+
+bool FEssIoUringStorageBackend::ReadRange(const FString& SlotName, const int32 UserIndex, const int64 Offset, const int64 Size, TArray<uint8>& OutBytes)
+{
+#if PLATFORM_LINUX
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*GetFilePath(SlotName), FILEREAD_Silent));
+	if (!Reader || Offset < 0 || Size < 0 || Offset + Size > Reader->TotalSize())
+		return false;
+
+	Reader->Seek(Offset);
+	OutBytes.SetNumUninitialized(Size);
+	Reader->Serialize(OutBytes.GetData(), Size);
+	return !Reader->IsError();
+#else
+	return Fallback.ReadRange(SlotName, UserIndex, Offset, Size, OutBytes);
+#endif
+}
+
+bool FEssIoUringStorageBackend::SupportsRangedReads() const
+{
+	return PLATFORM_LINUX || Fallback.SupportsRangedReads();
+}
+
+void FEssIoUringStorageBackend::WriteBatch(TArrayView<FEssSlotWrite> Writes)
+{
+#if PLATFORM_LINUX
+	const UEssSettings* Settings = GetDefault<UEssSettings>();
+	const EssIoUring::FSupport& Support = EssIoUring::GetSupport();
+
+	EssIoUring::FRing Ring;
+	if (!Support.bAvailable || !Ring.Init(FMath::Clamp(Settings->IoUringQueueDepth, 4, 4096)))
+	{
+		Fallback.WriteBatch(Writes);
+		return;
+	}
+
+	const FString Directory = FPaths::ProjectSavedDir() / TEXT("SaveGames");
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	const bool bSync = Settings->bSyncSlotWrites;
+	const int32 NumFixedOps = (bSync ? 1 : 0) + (Support.bRenameAt ? 1 : 0);
+	const int32 MaxChunks = Ring.GetNumEntries() - NumFixedOps;
+
+	// Paths are read by the kernel while the chains are in flight, so the slots must not move once queued
+	TArray<EssIoUring::FSlot> Slots;
+	Slots.SetNum(Writes.Num());
+
+	for (int32 i = 0; i < Writes.Num(); ++i)
+	{
+		EssIoUring::FSlot& Slot = Slots[i];
+		Slot.Write = &Writes[i];
+		Slot.Write->bSucceeded = false;
+
+		if (!Slot.Write->Bytes)
+		{
+			Slot.Write = nullptr;
+			continue;
+		}
+
+		// Writing next to the slot and renaming it into place means readers never see a partial slot
+		const FString FilePath = GetFilePath(Slot.Write->SlotName);
+		Slot.FilePath = EssIoUring::ToNativePath(FilePath);
+		Slot.TempFilePath = EssIoUring::ToNativePath(FilePath + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp"));
+
+		const int64 NumBytes = Slot.Write->Bytes->Num();
+		Slot.ChunkSize = FMath::Max(EssIoUring::MinChunkSize, FMath::DivideAndRoundUp<int64>(NumBytes, MaxChunks));
+		Slot.NumChunks = FMath::DivideAndRoundUp<int64>(NumBytes, Slot.ChunkSize);
+		Slot.bRenameInRing = Support.bRenameAt;
+		Slot.NumOps = Slot.NumChunks + NumFixedOps;
+	}
+
+	int32 NextSlot = 0;
+	uint32 NumInFlight = 0;
+
+	while (NextSlot < Slots.Num() || NumInFlight > 0)
+	{
+		// Chains are queued as a whole, since a link can't continue into the next submission
+		while (NextSlot < Slots.Num() && NumInFlight + Slots[NextSlot].NumOps <= Ring.GetNumEntries())
+		{
+			EssIoUring::FSlot& Slot = Slots[NextSlot];
+			if (Slot.Write && EssIoUring::QueueSlot(Ring, Slot, NextSlot, bSync))
+				NumInFlight += Slot.NumOps;
+
+			++NextSlot;
+		}
+
+		if (NumInFlight == 0)
+			continue;
+
+		const int32 Result = Ring.Submit(1);
+		if (Result < 0 && Result != -EAGAIN && Result != -EBUSY)
+		{
+			UE_LOG(LogEss, Error, TEXT("Slots not saved. io_uring submission failed with error %d."), -Result);
+			EssIoUring::AbortSlots(Ring, Slots, NumInFlight);
+			break;
+		}
+
+		EssIoUring::FCqe Cqe;
+		while (Ring.PopCqe(Cqe))
+		{
+			--NumInFlight;
+			EssIoUring::CompleteOp(Slots[Cqe.UserData >> 32], static_cast<int32>(Cqe.UserData & 0xffffffff), Cqe.Res);
+		}
+	}
+
+	// Slots left over by an aborted batch are closed and their temporary files removed
+	bool bAnyRenamed = false;
+	for (EssIoUring::FSlot& Slot : Slots)
+	{
+		if (Slot.Write && !Slot.bFinished)
+		{
+			Slot.bFailed = true;
+			EssIoUring::FinishSlot(Slot);
+		}
+
+		bAnyRenamed |= Slot.bRenamed;
+	}
+
+	if (bSync && bAnyRenamed)
+		EssIoUring::SyncDirectory(Directory);
+#else
+	Fallback.WriteBatch(Writes);
+#endif
+}
+
+FString FEssIoUringStorageBackend::GetFilePath(const FString& SlotName)
+{
+	// Same file as the save game system's, so slots stay readable when switching backends
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / SlotName + TEXT(".sav");
+}
@@ -0,0 +1,332 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssMass.h"
+#include "EssSaveData.h"
+#include "EssSettings.h"
+#include "EssStats.h"
+#include "Engine/World.h"
+#include "MassEntityManager.h"
+#include "MassEntityQuery.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutionContext.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+namespace EssMass
+{
+	/**
+	 * Values of a saved column, ready to be copied into the fragments of the recreated entities.
+	 */
+	struct FColumn
+	{
+		const UScriptStruct* Struct = nullptr;
+		bool bRawBytes = false;
+		const uint8* Values = nullptr;
+		TArray<uint8> DeserializedValues;
+	};
+
+	FMassEntityManager* GetEntityManager(UWorld* World)
+	{
+		UMassEntitySubsystem* EntitySubsystem = World ? World->GetSubsystem<UMassEntitySubsystem>() : nullptr;
+		if (!EntitySubsystem)
+			return nullptr;
+
+		// Entities can't be created or destroyed while processors are running
+		FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+		if (EntityManager.IsProcessing())
+		{
+			UE_LOG(LogEss, Warning, TEXT("Mass entities not saved or loaded. Mass processors are running."));
+			return nullptr;
+		}
+
+		return &EntityManager;
+	}
+
+	void GetSavedFragmentTypes(TArray<const UScriptStruct*>& OutTypes)
+	{
+		for (const FSoftObjectPath& Path : GetDefault<UEssSettings>()->MassFragments)
+		{
+			const UScriptStruct* Struct = Cast<UScriptStruct>(Path.TryLoad());
+			if (Struct && Struct->IsChildOf(FMassFragment::StaticStruct()))
+				OutTypes.AddUnique(Struct);
+			else if (!Path.IsNull())
+				UE_LOG(LogEss, Warning, TEXT("Mass fragment %s not saved. It is not a fragment type."), *Path.ToString());
+		}
+	}
+
+	bool LoadTypes(const TArray<FSoftObjectPath>& Paths, TArray<const UScriptStruct*>& OutTypes)
+	{
+		for (const FSoftObjectPath& Path : Paths)
+		{
+			const UScriptStruct* Struct = Cast<UScriptStruct>(Path.TryLoad());
+			if (!Struct)
+				return false;
+
+			OutTypes.Add(Struct);
+		}
+
+		return true;
+	}
+
+	void GetPaths(const TArray<const UScriptStruct*>& Types, TArray<FSoftObjectPath>& OutPaths)
+	{
+		OutPaths.Reserve(Types.Num());
+		for (const UScriptStruct* Type : Types)
+			OutPaths.Add(FSoftObjectPath(Type));
+	}
+
+	bool IsRawBytes(const UScriptStruct* Struct)
+	{
+		const UScriptStruct::ICppStructOps* StructOps = Struct->GetCppStructOps();
+		return StructOps && StructOps->IsPlainOldData();
+	}
+
+	void GetArchetypes(FMassEntityManager& EntityManager, const TArray<const UScriptStruct*>& FragmentTypes, TArray<FMassArchetypeHandle>& OutArchetypes)
+	{
+		FMassFragmentRequirements Requirements(EntityManager.AsShared());
+		for (const UScriptStruct* FragmentType : FragmentTypes)
+			Requirements.AddRequirement(FragmentType, EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Any);
+
+		EntityManager.GetMatchingArchetypes(Requirements, OutArchetypes);
+	}
+
+	/**
+	 * @param Types Fragment and tag types of the archetype the column is restored into.
+	 * @return False if the column doesn't match its struct anymore, or its struct isn't one of the types.
+	 */
+	bool ReadColumn(const FEssMassFragmentData& FragmentData, const int32 NumEntities, const TArray<const UScriptStruct*>& Types, FColumn& OutColumn)
+	{
+		// Checked before deserializing, so values are only ever constructed for columns that are restored
+		const UScriptStruct* Struct = Cast<UScriptStruct>(FragmentData.Struct.TryLoad());
+		if (!Struct || !Types.Contains(Struct))
+			return false;
+
+		OutColumn.Struct = Struct;
+		OutColumn.bRawBytes = FragmentData.bRawBytes;
+
+		if (FragmentData.bRawBytes)
+		{
+			if (!IsRawBytes(Struct) || Struct->GetStructureSize() != FragmentData.StructSize || FragmentData.ByteData.Num() != NumEntities * FragmentData.StructSize)
+				return false;
+
+			OutColumn.Values = FragmentData.ByteData.GetData();
+			return true;
+		}
+
+		OutColumn.DeserializedValues.SetNumUninitialized(NumEntities * Struct->GetStructureSize());
+		uint8* Values = OutColumn.DeserializedValues.GetData();
+		Struct->InitializeStruct(Values, NumEntities);
+
+		FMemoryReader MemoryReader(FragmentData.ByteData);
+		FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
+		for (int32 i = 0; i < NumEntities && !Archive.IsError(); ++i)
+			const_cast<UScriptStruct*>(Struct)->SerializeItem(Archive, Values + i * Struct->GetStructureSize(), nullptr);
+
+		if (Archive.IsError())
+		{
+			Struct->DestroyStruct(Values, NumEntities);
+			OutColumn.DeserializedValues.Empty();
+			return false;
+		}
+
+		OutColumn.Values = Values;
+		return true;
+	}
+}
+
+int32 FEssMass::Extract(UWorld* World, TArray<FEssMassArchetypeData>& OutArchetypesData)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssExtractMassEntities);
+
+	TArray<const UScriptStruct*> SavedTypes;
+	EssMass::GetSavedFragmentTypes(SavedTypes);
+	if (SavedTypes.Num() == 0)
+		return INDEX_NONE;
+
+	FMassEntityManager* EntityManager = EssMass::GetEntityManager(World);
+	if (!EntityManager)
+		return INDEX_NONE;
+
+	TArray<FMassArchetypeHandle> Archetypes;
+	EssMass::GetArchetypes(*EntityManager, SavedTypes, Archetypes);
+
+	int32 NumEntities = 0;
+
+	for (const FMassArchetypeHandle& Archetype : Archetypes)
+	{
+		const FMassArchetypeCompositionDescriptor& Composition = EntityManager->GetArchetypeComposition(Archetype);
+
+		TArray<const UScriptStruct*> FragmentTypes;
+		TArray<const UScriptStruct*> TagTypes;
+		Composition.Fragments.ExportTypes(FragmentTypes);
+		Composition.Tags.ExportTypes(TagTypes);
+
+		FEssMassArchetypeData ArchetypeData;
+		EssMass::GetPaths(FragmentTypes, ArchetypeData.FragmentTypes);
+		EssMass::GetPaths(TagTypes, ArchetypeData.TagTypes);
+
+		FMassEntityQuery Query(EntityManager->AsShared());
+		TArray<const UScriptStruct*> ColumnTypes;
+
+		for (const UScriptStruct* SavedType : SavedTypes)
+		{
+			if (!FragmentTypes.Contains(SavedType))
+				continue;
+
+			ColumnTypes.Add(SavedType);
+			Query.AddRequirement(SavedType, EMassFragmentAccess::ReadOnly);
+
+			FEssMassFragmentData& FragmentData = ArchetypeData.FragmentsData.AddDefaulted_GetRef();
+			FragmentData.Struct = FSoftObjectPath(SavedType);
+			FragmentData.bRawBytes = EssMass::IsRawBytes(SavedType);
+			FragmentData.StructSize = SavedType->GetStructureSize();
+		}
+
+		FMassExecutionContext ExecutionContext(*EntityManager);
+		Query.ForEachEntityChunk(FMassArchetypeEntityCollection(Archetype, FMassArchetypeEntityCollection::GatherAll), *EntityManager, ExecutionContext,
+			[&ArchetypeData, &ColumnTypes](FMassExecutionContext& Context)
+		{
+			const int32 NumChunkEntities = Context.GetNumEntities();
+
+			for (int32 i = 0; i < ColumnTypes.Num(); ++i)
+			{
+				FEssMassFragmentData& FragmentData = ArchetypeData.FragmentsData[i];
+				const FConstStructArrayView View = Context.GetFragmentView(ColumnTypes[i]);
+				const uint8* Values = static_cast<const uint8*>(View.GetData());
+
+				// A chunk stores each fragment type contiguously, so plain old data is copied for the whole chunk at once
+				if (FragmentData.bRawBytes)
+				{
+					FragmentData.ByteData.Append(Values, NumChunkEntities * FragmentData.StructSize);
+					continue;
+				}
+
+				FMemoryWriter MemoryWriter(FragmentData.ByteData, false, true);
+				FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, false);
+				for (int32 Entity = 0; Entity < NumChunkEntities; ++Entity)
+					const_cast<UScriptStruct*>(ColumnTypes[i])->SerializeItem(Archive, const_cast<uint8*>(Values + Entity * View.GetElementSize()), nullptr);
+			}
+
+			ArchetypeData.NumEntities += NumChunkEntities;
+		});
+
+		if (ArchetypeData.NumEntities == 0)
+			continue;
+
+		for (const FEssMassFragmentData& FragmentData : ArchetypeData.FragmentsData)
+			INC_QWORD_STAT_BY(STAT_EssBytesSerialized, FragmentData.ByteData.Num());
+
+		NumEntities += ArchetypeData.NumEntities;
+		OutArchetypesData.Add(MoveTemp(ArchetypeData));
+	}
+
+	return NumEntities;
+}
+
+int32 FEssMass::Restore(UWorld* World, const FEssWorldData& WorldData)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreMassEntities);
+
+	const TArray<FEssMassArchetypeData>& ArchetypesData = WorldData.MassArchetypesData;
+
+	// Saves without Mass entities leave the current entities alone. Saves from before the flag was written only had entities if they hold any
+	TArray<const UScriptStruct*> SavedTypes;
+	EssMass::GetSavedFragmentTypes(SavedTypes);
+	if (SavedTypes.Num() == 0 || (!WorldData.bMassEntitiesSaved && ArchetypesData.Num() == 0))
+		return INDEX_NONE;
+
+	FMassEntityManager* EntityManager = EssMass::GetEntityManager(World);
+	if (!EntityManager)
+		return INDEX_NONE;
+
+	// The saved entities replace every current entity with a saved fragment type
+	TArray<FMassArchetypeHandle> Archetypes;
+	EssMass::GetArchetypes(*EntityManager, SavedTypes, Archetypes);
+	for (const FMassArchetypeHandle& Archetype : Archetypes)
+		EntityManager->BatchDestroyEntityChunks(FMassArchetypeEntityCollection(Archetype, FMassArchetypeEntityCollection::GatherAll));
+
+	int32 NumEntities = 0;
+
+	for (const FEssMassArchetypeData& ArchetypeData : ArchetypesData)
+	{
+		if (ArchetypeData.NumEntities <= 0)
+			continue;
+
+		TArray<const UScriptStruct*> Types;
+		if (!EssMass::LoadTypes(ArchetypeData.FragmentTypes, Types) || !EssMass::LoadTypes(ArchetypeData.TagTypes, Types))
+		{
+			UE_LOG(LogEss, Warning, TEXT("%d Mass entities not loaded. A fragment or tag type of their archetype doesn't exist anymore."), ArchetypeData.NumEntities);
+			continue;
+		}
+
+		TArray<EssMass::FColumn> Columns;
+		Columns.Reserve(ArchetypeData.FragmentsData.Num());
+		for (const FEssMassFragmentData& FragmentData : ArchetypeData.FragmentsData)
+		{
+			EssMass::FColumn& Column = Columns.AddDefaulted_GetRef();
+			if (!EssMass::ReadColumn(FragmentData, ArchetypeData.NumEntities, Types, Column))
+			{
+				UE_LOG(LogEss, Warning, TEXT("Mass fragment %s not loaded. Its struct has changed since saving."), *FragmentData.Struct.ToString());
+				Columns.Pop();
+			}
+		}
+
+		const FMassArchetypeHandle Archetype = EntityManager->CreateArchetype(Types);
+
+		// Observers of the new entities only run once the creation context is released, after the fragments have been filled in
+		TArray<FMassEntityHandle> Entities;
+		TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext =
+			EntityManager->BatchCreateEntities(Archetype, FMassArchetypeSharedFragmentValues(), ArchetypeData.NumEntities, Entities);
+
+		TMap<FMassEntityHandle, int32> Rows;
+		Rows.Reserve(Entities.Num());
+		for (int32 i = 0; i < Entities.Num(); ++i)
+			Rows.Add(Entities[i], i);
+
+		FMassEntityQuery Query(EntityManager->AsShared());
+		for (const EssMass::FColumn& Column : Columns)
+			Query.AddRequirement(Column.Struct, EMassFragmentAccess::ReadWrite);
+
+		FMassExecutionContext ExecutionContext(*EntityManager);
+		Query.ForEachEntityChunk(FMassArchetypeEntityCollection(Archetype, Entities, FMassArchetypeEntityCollection::NoDuplicates), *EntityManager, ExecutionContext,
+			[&Columns, &Rows](FMassExecutionContext& Context)
+		{
+			const TConstArrayView<FMassEntityHandle> ChunkEntities = Context.GetEntities();
+
+			for (int32 i = 0; i < ChunkEntities.Num();)
+			{
+				// Entities created in one batch sit next to each other, so runs of consecutive rows are copied at once
+				const int32 FirstRow = Rows.FindChecked(ChunkEntities[i]);
+				int32 NumRows = 1;
+				while (i + NumRows < ChunkEntities.Num() && Rows.FindChecked(ChunkEntities[i + NumRows]) == FirstRow + NumRows)
+					++NumRows;
+
+				for (const EssMass::FColumn& Column : Columns)
+				{
+					const FStructArrayView View = Context.GetMutableFragmentView(Column.Struct);
+					uint8* Fragments = static_cast<uint8*>(View.GetData()) + i * View.GetElementSize();
+					const uint8* Values = Column.Values + FirstRow * Column.Struct->GetStructureSize();
+
+					if (Column.bRawBytes)
+						FMemory::Memcpy(Fragments, Values, NumRows * Column.Struct->GetStructureSize());
+					else
+						Column.Struct->CopyScriptStruct(Fragments, Values, NumRows);
+				}
+
+				i += NumRows;
+			}
+		});
+
+		for (EssMass::FColumn& Column : Columns)
+		{
+			if (Column.DeserializedValues.Num() > 0)
+				Column.Struct->DestroyStruct(Column.DeserializedValues.GetData(), ArchetypeData.NumEntities);
+		}
+
+		NumEntities += Entities.Num();
+	}
+
+	INC_DWORD_STAT_BY(STAT_EssMassEntitiesRestored, NumEntities);
+	return NumEntities;
+}
@@ -0,0 +1,418 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssRecordIndex.h"
+#include "EssSaveData.h"
+#include "EssStats.h"
+#include "EssStorage.h"
+#include "EssUtil.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace EssRecordIndex
+{
+	constexpr uint32 Magic = 0x49535345; // ESSI
+	constexpr int32 Version = 4;
+
+	struct FHeader
+	{
+		uint32 Magic = EssRecordIndex::Magic;
+		int32 Version = EssRecordIndex::Version;
+		int64 TableOffset = 0;
+		int64 TableSize = 0;
+		FGuid WriteGuid;
+		int64 WriteGuidOffset = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FHeader& Header)
+		{
+			return Ar << Header.Magic << Header.Version << Header.TableOffset << Header.TableSize << Header.WriteGuid << Header.WriteGuidOffset;
+		}
+	};
+
+	constexpr int64 HeaderSize = sizeof(uint32) + sizeof(int32) + 3 * sizeof(int64) + sizeof(FGuid);
+
+	FString GetClassPath(const UClass* Class)
+	{
+		return Class ? Class->GetPathName() : FString();
+	}
+
+	FString GetClassPath(const TSoftClassPtr<AActor>& Class)
+	{
+		return Class.IsNull() ? FString() : Class.ToString();
+	}
+
+	void WriteStruct(FArchive& Archive, UScriptStruct* Struct, const void* Data)
+	{
+		Struct->SerializeItem(Archive, const_cast<void*>(Data), nullptr);
+	}
+
+	/**
+	 * @return Offset of the first occurrence of the bytes at or after Start, INDEX_NONE if there is none.
+	 */
+	int64 FindBytes(const TArray<uint8>& Bytes, const int64 Start, const uint8* Needle, const int64 NeedleSize)
+	{
+		if (NeedleSize <= 0)
+			return INDEX_NONE;
+
+		const uint8* Begin = Bytes.GetData();
+		const uint8* Last = Begin + Bytes.Num() - NeedleSize;
+		for (const uint8* It = Begin + Start; It <= Last; ++It)
+		{
+			It = static_cast<const uint8*>(memchr(It, Needle[0], Last - It + 1));
+			if (!It)
+				return INDEX_NONE;
+
+			if (FMemory::Memcmp(It, Needle, NeedleSize) == 0)
+				return It - Begin;
+		}
+
+		return INDEX_NONE;
+	}
+
+	/**
+	 * Finds the records of a slot, in the order the save game serialized them, by their bytes.
+	 * A struct in a container of the save game is serialized exactly like on its own, so each record is found right after the previous one.
+	 */
+	class FRecordFinder
+	{
+	public:
+		explicit FRecordFinder(const TArray<uint8>& InSlotBytes)
+			: SlotBytes(InSlotBytes)
+		{
+		}
+
+		/**
+		 * @return False if the record isn't in the rest of the slot.
+		 */
+		bool Find(UScriptStruct* Struct, const void* Record, int64& OutOffset, int64& OutSize)
+		{
+			// Same archive as the save game system's, so the record serializes to the same bytes
+			RecordBytes.Reset();
+			FMemoryWriter MemoryWriter(RecordBytes, true);
+			FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, false);
+			WriteStruct(Archive, Struct, Record);
+
+			OutOffset = FindBytes(SlotBytes, Cursor, RecordBytes.GetData(), RecordBytes.Num());
+			if (OutOffset == INDEX_NONE)
+				return false;
+
+			OutSize = RecordBytes.Num();
+			Cursor = OutOffset + OutSize;
+			return true;
+		}
+
+	private:
+		const TArray<uint8>& SlotBytes;
+		TArray<uint8> RecordBytes;
+		int64 Cursor = 0;
+	};
+}
+
+FArchive& operator<<(FArchive& Ar, FEssRecordIndexEntry& Entry)
+{
+	uint8 Kind = static_cast<uint8>(Entry.Kind);
+	Ar << Kind;
+	Entry.Kind = static_cast<EEssRecordKind>(Kind);
+
+	Ar << Entry.World;
+	Ar << Entry.Level;
+	Ar << Entry.Key;
+	Ar << Entry.ClassPath;
+	Ar << Entry.Offset;
+	Ar << Entry.Size;
+	Ar << Entry.HeaderOffset;
+	Ar << Entry.HeaderSize;
+	Ar << Entry.NumRecords;
+	return Ar;
+}
+
+FString FEssRecordIndex::GetSlotName(const FString& SlotName)
+{
+	return SlotName + TEXT(".essidx");
+}
+
+bool FEssRecordIndex::Write(const FString& SlotName, const int32 UserIndex, const FEssSaveData& SaveData, const FGuid& WriteGuid, const TArray<uint8>& SlotBytes)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotWrite);
+
+	EssRecordIndex::FHeader Header;
+	Header.WriteGuid = WriteGuid;
+
+	// A new GUID doesn't occur anywhere else in the slot
+	TArray<uint8> GuidBytes;
+	FMemoryWriter GuidWriter(GuidBytes);
+	GuidWriter << Header.WriteGuid;
+
+	Header.WriteGuidOffset = EssRecordIndex::FindBytes(SlotBytes, 0, GuidBytes.GetData(), GuidBytes.Num());
+	if (Header.WriteGuidOffset == INDEX_NONE)
+		return false;
+
+	TArray<uint8> Bytes;
+	FMemoryWriter MemoryWriter(Bytes, true);
+	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, false);
+	Archive << Header;
+
+	EssRecordIndex::FRecordFinder Finder(SlotBytes);
+	TArray<FEssRecordIndexEntry> Entries;
+
+	for (const auto& WorldPair : SaveData.WorldsData)
+	{
+		const FEssWorldData& WorldData = WorldPair.Value;
+
+		for (const auto& LevelPair : WorldData.LevelsData)
+		{
+			const FEssLevelData& LevelData = LevelPair.Value;
+
+			const int32 LevelEntryIndex = Entries.Add({ EEssRecordKind::Level, WorldData.Name, LevelData.Name, LevelData.Name });
+			Entries[LevelEntryIndex].HeaderOffset = Archive.Tell();
+
+			// The fields of a level are spread around its actor records in the slot, so its header is kept in the index
+			FEssLevelData LevelHeader = EssUtil::GetLevelHeader(LevelData);
+			EssRecordIndex::WriteStruct(Archive, FEssLevelData::StaticStruct(), &LevelHeader);
+			Entries[LevelEntryIndex].HeaderSize = Archive.Tell() - Entries[LevelEntryIndex].HeaderOffset;
+
+			// Runtime actors are declared before placed actors, which is the order they're serialized in
+			for (const FEssRuntimeActorData& ActorData : LevelData.RuntimeActorsData)
+			{
+				FEssRecordIndexEntry Entry{ EEssRecordKind::RuntimeActor, WorldData.Name, LevelData.Name, ActorData.Guid.ToString(), EssRecordIndex::GetClassPath(ActorData.Class) };
+				if (!Finder.Find(FEssRuntimeActorData::StaticStruct(), &ActorData, Entry.Offset, Entry.Size))
+					return false;
+
+				Entries.Add(MoveTemp(Entry));
+			}
+
+			for (const auto& PlacedPair : LevelData.PlacedActorsData)
+			{
+				const FEssPlacedActorData& ActorData = PlacedPair.Value;
+				FEssRecordIndexEntry Entry{ EEssRecordKind::PlacedActor, WorldData.Name, LevelData.Name, ActorData.Name.ToString(), EssRecordIndex::GetClassPath(ActorData.Class) };
+				if (!Finder.Find(FEssPlacedActorData::StaticStruct(), &ActorData, Entry.Offset, Entry.Size))
+					return false;
+
+				Entries.Add(MoveTemp(Entry));
+			}
+
+			FEssRecordIndexEntry& LevelEntry = Entries[LevelEntryIndex];
+			LevelEntry.NumRecords = Entries.Num() - LevelEntryIndex - 1;
+			if (LevelEntry.NumRecords > 0)
+			{
+				LevelEntry.Offset = Entries[LevelEntryIndex + 1].Offset;
+				LevelEntry.Size = Entries.Last().Offset + Entries.Last().Size - LevelEntry.Offset;
+			}
+		}
+	}
+
+	for (const FEssGlobalObjectData& ObjectData : SaveData.GlobalObjectData)
+	{
+		FEssRecordIndexEntry Entry{ EEssRecordKind::GlobalObject, FString(), FString(), ObjectData.Guid.ToString(), EssRecordIndex::GetClassPath(ObjectData.Class) };
+		if (!Finder.Find(FEssGlobalObjectData::StaticStruct(), &ObjectData, Entry.Offset, Entry.Size))
+			return false;
+
+		Entries.Add(MoveTemp(Entry));
+	}
+
+	Header.TableOffset = Archive.Tell();
+	Archive << Entries;
+	Header.TableSize = Archive.Tell() - Header.TableOffset;
+
+	Archive.Seek(0);
+	Archive << Header;
+
+	return FEssStorage::Get()->Write(GetSlotName(SlotName), UserIndex, Bytes);
+}
+
+void FEssRecordIndex::Delete(const FString& SlotName, const int32 UserIndex)
+{
+	const TSharedRef<IEssStorageBackend> Storage = FEssStorage::Get();
+	const FString IndexSlotName = GetSlotName(SlotName);
+	if (Storage->DoesSlotExist(IndexSlotName, UserIndex))
+		Storage->Delete(IndexSlotName, UserIndex);
+}
+
+TSharedPtr<FEssRecordIndex> FEssRecordIndex::Open(const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotRead);
+
+	TSharedPtr<FEssRecordIndex> Index = MakeShared<FEssRecordIndex>();
+	Index->Storage = FEssStorage::Get();
+	Index->SlotName = SlotName;
+	Index->IndexSlotName = GetSlotName(SlotName);
+	Index->UserIndex = UserIndex;
+
+	if (!Index->Storage->DoesSlotExist(Index->IndexSlotName, UserIndex))
+		return nullptr;
+
+	// Without ranged reads the index is read once and its parts are copied out of memory
+	if (!Index->Storage->SupportsRangedReads())
+	{
+		if (!Index->Storage->Read(Index->IndexSlotName, UserIndex, Index->IndexData))
+			return nullptr;
+
+		FEssStats::Get().AddFileBytesRead(Index->IndexData.Num());
+	}
+
+	TArray<uint8> HeaderBytes;
+	if (!Index->ReadRange(Index->IndexSlotName, Index->IndexData, 0, EssRecordIndex::HeaderSize, HeaderBytes))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Record index %s is not valid."), *Index->IndexSlotName);
+		return nullptr;
+	}
+
+	EssRecordIndex::FHeader Header;
+	FMemoryReader HeaderReader(HeaderBytes);
+	HeaderReader << Header;
+
+	if (HeaderReader.IsError() || Header.Magic != EssRecordIndex::Magic || Header.Version != EssRecordIndex::Version
+		|| Header.TableOffset < EssRecordIndex::HeaderSize || Header.TableSize <= 0 || Header.WriteGuidOffset < 0)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Record index %s is not valid."), *Index->IndexSlotName);
+		return nullptr;
+	}
+
+	// The slot may have been written without its index (by an older version, another process, or with the setting off),
+	// so the index is only used if the slot still holds the write GUID the index was written for
+	if (!Index->Storage->SupportsRangedReads())
+	{
+		if (!Index->Storage->Read(SlotName, UserIndex, Index->SlotData))
+			return nullptr;
+
+		FEssStats::Get().AddFileBytesRead(Index->SlotData.Num());
+	}
+
+	FGuid SlotWriteGuid;
+	TArray<uint8> GuidBytes;
+	if (Index->ReadRange(SlotName, Index->SlotData, Header.WriteGuidOffset, sizeof(FGuid), GuidBytes))
+	{
+		FMemoryReader GuidReader(GuidBytes);
+		GuidReader << SlotWriteGuid;
+	}
+
+	if (SlotWriteGuid != Header.WriteGuid)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Record index %s does not match slot %s. Reading the whole slot instead."), *Index->IndexSlotName, *SlotName);
+		return nullptr;
+	}
+
+	TArray<uint8> TableBytes;
+	if (!Index->ReadRange(Index->IndexSlotName, Index->IndexData, Header.TableOffset, Header.TableSize, TableBytes))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Record index %s could not be read."), *Index->IndexSlotName);
+		return nullptr;
+	}
+
+	FMemoryReader TableReader(TableBytes);
+	TableReader << Index->Entries;
+
+	if (TableReader.IsError())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Record index %s could not be read."), *Index->IndexSlotName);
+		return nullptr;
+	}
+
+	Index->Lookup.Reserve(Index->Entries.Num());
+	for (int32 i = 0; i < Index->Entries.Num(); ++i)
+	{
+		const FEssRecordIndexEntry& Entry = Index->Entries[i];
+		Index->Lookup.Add(MakeLookupKey(Entry.Kind, Entry.World, Entry.Level, Entry.Key), i);
+	}
+
+	return Index;
+}
+
+const FEssRecordIndexEntry* FEssRecordIndex::Find(const EEssRecordKind Kind, const FString& World, const FString& Level, const FString& Key) const
+{
+	const int32* Index = Lookup.Find(MakeLookupKey(Kind, World, Level, Key));
+	return Index ? &Entries[*Index] : nullptr;
+}
+
+bool FEssRecordIndex::ReadBytes(const FEssRecordIndexEntry& Entry, TArray<uint8>& OutBytes) const
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotRead);
+
+	return ReadRange(SlotName, SlotData, Entry.Offset, Entry.Size, OutBytes);
+}
+
+bool FEssRecordIndex::ReadLevel(const FEssRecordIndexEntry& Entry, FEssLevelData& OutLevelData) const
+{
+	const int32* LevelIndex = Lookup.Find(MakeLookupKey(Entry.Kind, Entry.World, Entry.Level, Entry.Key));
+	if (!LevelIndex || *LevelIndex + Entry.NumRecords >= Entries.Num() || !ReadLevelHeader(Entry, OutLevelData))
+		return false;
+
+	if (Entry.NumRecords == 0)
+		return true;
+
+	// The actor records of a level are adjacent in the slot, so they're read at once
+	TArray<uint8> Bytes;
+	if (!ReadBytes(Entry, Bytes))
+		return false;
+
+	FMemoryReader MemoryReader(Bytes, true);
+	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
+
+	for (int32 i = *LevelIndex + 1; i <= *LevelIndex + Entry.NumRecords && !Archive.IsError(); ++i)
+	{
+		const FEssRecordIndexEntry& RecordEntry = Entries[i];
+		Archive.Seek(RecordEntry.Offset - Entry.Offset);
+
+		if (RecordEntry.Kind == EEssRecordKind::RuntimeActor)
+		{
+			FEssRuntimeActorData& ActorData = OutLevelData.RuntimeActorsData.AddDefaulted_GetRef();
+			FEssRuntimeActorData::StaticStruct()->SerializeItem(Archive, &ActorData, nullptr);
+		}
+		else
+		{
+			FEssPlacedActorData ActorData;
+			FEssPlacedActorData::StaticStruct()->SerializeItem(Archive, &ActorData, nullptr);
+			OutLevelData.PlacedActorsData.Add(ActorData.Name, MoveTemp(ActorData));
+		}
+	}
+
+	return !Archive.IsError();
+}
+
+bool FEssRecordIndex::ReadLevelHeader(const FEssRecordIndexEntry& Entry, FEssLevelData& OutLevelHeader) const
+{
+	TArray<uint8> Bytes;
+	if (Entry.Kind != EEssRecordKind::Level || !ReadRange(IndexSlotName, IndexData, Entry.HeaderOffset, Entry.HeaderSize, Bytes))
+		return false;
+
+	FMemoryReader MemoryReader(Bytes, true);
+	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
+	FEssLevelData::StaticStruct()->SerializeItem(Archive, &OutLevelHeader, nullptr);
+	return !Archive.IsError();
+}
+
+bool FEssRecordIndex::ReadRange(const FString& RangeSlotName, const TArray<uint8>& CachedBytes, const int64 Offset, const int64 Size, TArray<uint8>& OutBytes) const
+{
+	if (Offset < 0 || Size < 0)
+		return false;
+
+	if (!Storage->SupportsRangedReads())
+	{
+		if (Offset + Size > CachedBytes.Num())
+			return false;
+
+		OutBytes = TArray<uint8>(CachedBytes.GetData() + Offset, Size);
+		return true;
+	}
+
+	if (!Storage->ReadRange(RangeSlotName, UserIndex, Offset, Size, OutBytes))
+		return false;
+
+	FEssStats::Get().AddFileBytesRead(Size);
+	return true;
+}
+
+FString FEssRecordIndex::MakeLookupKey(const EEssRecordKind Kind, const FString& World, const FString& Level, const FString& Key)
+{
+	switch (Kind)
+	{
+	case EEssRecordKind::RuntimeActor:
+		// Runtime actors are unique per world, so they can be found without knowing their level
+		return FString::Printf(TEXT("R|%s|%s"), *World, *Key);
+	case EEssRecordKind::PlacedActor:
+		return FString::Printf(TEXT("P|%s|%s|%s"), *World, *Level, *Key);
+	case EEssRecordKind::GlobalObject:
+		return FString::Printf(TEXT("G|%s"), *Key);
+	case EEssRecordKind::Level:
+	default:
+		return FString::Printf(TEXT("L|%s|%s"), *World, *Level);
+	}
+}
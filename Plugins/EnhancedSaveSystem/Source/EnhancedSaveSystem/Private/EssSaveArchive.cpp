@@ -0,0 +1,263 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSaveArchive.h"
+#include "EssActorRegistry.h"
+#include "EssStats.h"
+#include "EssUtil.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "UObject/Package.h"
+
+namespace EssSaveArchive
+{
+	// Negative lengths mark UTF-16 strings but never reach this value, so it can't be mistaken for an object path
+	constexpr int32 IndexMarker = MIN_int32 + 1;
+}
+
+FEssReferenceResolver::FEssReferenceResolver(UWorld* InWorld, const FEssActorRegistry& InActorRegistry)
+	: World(InWorld)
+	, ActorRegistry(InActorRegistry)
+{
+}
+
+void FEssReferenceResolver::Resolve(const TArray<FEssObjectReference>& References)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssResolveReferences);
+
+	TArray<TWeakObjectPtr<UObject>>& Objects = ResolvedTables.FindOrAdd(&References);
+	Objects.SetNum(References.Num());
+
+	for (int32 Index = 0; Index < References.Num(); ++Index)
+		Objects[Index] = Find(References[Index]);
+}
+
+UObject* FEssReferenceResolver::Find(const TArray<FEssObjectReference>& References, const int32 Index)
+{
+	if (!References.IsValidIndex(Index))
+		return nullptr;
+
+	// Objects which have been destroyed since the table was resolved are looked up again
+	const TArray<TWeakObjectPtr<UObject>>* Objects = ResolvedTables.Find(&References);
+	if (Objects && Objects->IsValidIndex(Index))
+	{
+		if (UObject* Obj = (*Objects)[Index].Get())
+			return Obj;
+	}
+
+	return Find(References[Index]);
+}
+
+UObject* FEssReferenceResolver::Find(const FEssObjectReference& Reference)
+{
+	if (Reference.Guid.IsValid())
+		return FindRuntimeActor(Reference.Guid);
+
+	if (!Reference.LevelName.IsEmpty())
+		return FindPlacedActor(Reference.LevelName, Reference.Name);
+
+	return FindAsset(Reference.Path);
+}
+
+AActor* FEssReferenceResolver::FindRuntimeActor(const FGuid& Guid)
+{
+	// Runtime actors are only found by the GUID property, so every one of them is looked at once and indexed
+	if (!bRuntimeActorsGathered)
+	{
+		bRuntimeActorsGathered = true;
+
+		TArray<AActor*> Actors;
+		for (ULevel* Level : World->GetLevels())
+		{
+			ActorRegistry.GetActors(Level, Actors);
+			for (AActor* Actor : Actors)
+			{
+				if (!IsValid(Actor) || !EssUtil::IsRuntimeActor(Actor) || !EssUtil::GetGuidProperty(Actor))
+					continue;
+
+				const FGuid ActorGuid = EssUtil::GetGuid(Actor);
+				if (ActorGuid.IsValid())
+					RuntimeActors.Add(ActorGuid, Actor);
+			}
+		}
+	}
+
+	const TWeakObjectPtr<AActor>* Actor = RuntimeActors.Find(Guid);
+	if (!Actor || !Actor->IsValid())
+		return nullptr;
+
+	INC_DWORD_STAT(STAT_EssReferencesResolved);
+	return Actor->Get();
+}
+
+AActor* FEssReferenceResolver::FindPlacedActor(const FString& LevelName, const FName Name)
+{
+	if (Levels.Num() == 0)
+	{
+		for (ULevel* Level : World->GetLevels())
+		{
+			if (IsValid(Level))
+				Levels.Add(EssUtil::GetLevelName(Level), Level);
+		}
+	}
+
+	const TWeakObjectPtr<ULevel>* Level = Levels.Find(LevelName);
+	AActor* Actor = Level && Level->IsValid() ? FindObjectFast<AActor>(Level->Get(), Name) : nullptr;
+	if (!IsValid(Actor))
+		return nullptr;
+
+	INC_DWORD_STAT(STAT_EssReferencesResolved);
+	return Actor;
+}
+
+UObject* FEssReferenceResolver::FindAsset(const FSoftObjectPath& Path)
+{
+	if (Path.IsNull())
+		return nullptr;
+
+	// Assets which have been garbage collected since are loaded again
+	const TWeakObjectPtr<UObject>* CachedAsset = Assets.Find(Path);
+	if (CachedAsset && CachedAsset->IsValid())
+		return CachedAsset->Get();
+
+	UObject* Asset = Path.TryLoad();
+	Assets.Add(Path, Asset);
+
+	if (Asset)
+		INC_DWORD_STAT(STAT_EssReferencesResolved);
+
+	return Asset;
+}
+
+FEssReferenceTable::FEssReferenceTable(const TArray<FEssObjectReference>& InReferences)
+	: References(InReferences)
+{
+	Indices.Reserve(References.Num());
+	for (int32 Index = 0; Index < References.Num(); ++Index)
+	{
+		if (References[Index].IsNull())
+			FreeIndices.Add(Index);
+		else
+			Indices.Add(References[Index], Index);
+	}
+}
+
+int32 FEssReferenceTable::Add(const FEssObjectReference& Reference)
+{
+	if (const int32* Index = Indices.Find(Reference))
+		return *Index;
+
+	int32 Index;
+	if (FreeIndices.Num() > 0)
+	{
+		Index = FreeIndices.Pop(EAllowShrinking::No);
+		References[Index] = Reference;
+	}
+	else
+	{
+		Index = References.Add(Reference);
+	}
+
+	Indices.Add(Reference, Index);
+	return Index;
+}
+
+FEssSaveArchive::FEssSaveArchive(FArchive& InInnerArchive, FEssReferenceTable& InReferences, TArray<int32>& OutReferenceIndices)
+	: FObjectAndNameAsStringProxyArchive(InInnerArchive, true)
+	, WrittenReferences(&InReferences)
+	, WrittenReferenceIndices(&OutReferenceIndices)
+{
+	ArIsSaveGame = true;
+	ArNoDelta = true;
+}
+
+FEssSaveArchive::FEssSaveArchive(FArchive& InInnerArchive, FEssReferenceResolver& InResolver, const TArray<FEssObjectReference>& InReferences)
+	: FObjectAndNameAsStringProxyArchive(InInnerArchive, true)
+	, Resolver(&InResolver)
+	, ReadReferences(&InReferences)
+{
+	ArIsSaveGame = true;
+	ArNoDelta = true;
+}
+
+FArchive& FEssSaveArchive::operator<<(UObject*& Obj)
+{
+	if (IsSaving())
+	{
+		FEssObjectReference Reference;
+		if (!MakeReference(Obj, Reference))
+			return FObjectAndNameAsStringProxyArchive::operator<<(Obj);
+
+		int32 Marker = EssSaveArchive::IndexMarker;
+		int32 Index = WrittenReferences->Add(Reference);
+		*this << Marker << Index;
+
+		WrittenReferenceIndices->AddUnique(Index);
+		return *this;
+	}
+
+	// Records written without references hold a path string, which starts with its length
+	const int64 Position = Tell();
+	int32 Marker = 0;
+	*this << Marker;
+
+	if (Marker == EssSaveArchive::IndexMarker)
+	{
+		int32 Index = INDEX_NONE;
+		*this << Index;
+		Obj = Resolver->Find(*ReadReferences, Index);
+		return *this;
+	}
+
+	Seek(Position);
+	return FObjectAndNameAsStringProxyArchive::operator<<(Obj);
+}
+
+FArchive& FEssSaveArchive::operator<<(FObjectPtr& Obj)
+{
+	UObject* Object = IsSaving() ? Obj.Get() : nullptr;
+	*this << Object;
+
+	if (IsLoading())
+		Obj = FObjectPtr(Object);
+
+	return *this;
+}
+
+bool FEssSaveArchive::MakeReference(UObject* Obj, FEssObjectReference& OutReference)
+{
+	if (!IsValid(Obj))
+		return false;
+
+	if (AActor* Actor = Cast<AActor>(Obj))
+	{
+		if (!FEssActorRegistry::IsSavable(Actor) || !Actor->GetLevel())
+			return false;
+
+		if (!EssUtil::IsRuntimeActor(Actor))
+		{
+			OutReference.LevelName = EssUtil::GetLevelName(Actor->GetLevel());
+			OutReference.Name = Actor->GetFName();
+			return true;
+		}
+
+		// Saving gives runtime actors their GUID before any record is written, actors which still have none aren't saved
+		if (!EssUtil::GetGuidProperty(Actor))
+			return false;
+
+		const FGuid Guid = EssUtil::GetGuid(Actor);
+		if (!Guid.IsValid())
+			return false;
+
+		OutReference.Guid = Guid;
+		return true;
+	}
+
+	// Other objects of the world, such as components, are still written as paths
+	const UPackage* Package = Obj->GetPackage();
+	if (!Package || Package == GetTransientPackage() || Package->ContainsMap())
+		return false;
+
+	OutReference.Path = FSoftObjectPath(Obj);
+	return true;
+}
@@ -0,0 +1,8 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSettings.h"
+
+UEssSettings::UEssSettings()
+{
+	CategoryName = TEXT("Plugins");
+}
@@ -0,0 +1,321 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSnapshotRing.h"
+#include "EssUtil.h"
+
+namespace EssSnapshot
+{
+	bool HaveEqualHeaders(const FEssLevelData& A, const FEssLevelData& B)
+	{
+		for (TFieldIterator<FProperty> It(FEssLevelData::StaticStruct()); It; ++It)
+		{
+			const FName PropertyName = It->GetFName();
+			if (PropertyName == GET_MEMBER_NAME_CHECKED(FEssLevelData, RuntimeActorsData) ||
+				PropertyName == GET_MEMBER_NAME_CHECKED(FEssLevelData, PlacedActorsData))
+			{
+				continue;
+			}
+
+			if (!It->Identical_InContainer(&A, &B))
+				return false;
+		}
+
+		return true;
+	}
+
+	void MakeDelta(const FEssWorldData& Previous, const FEssWorldData& Current, FEssSnapshot& OutSnapshot)
+	{
+		OutSnapshot.MassArchetypesData = Current.MassArchetypesData;
+		OutSnapshot.bMassEntitiesSaved = Current.bMassEntitiesSaved;
+
+		for (const auto& LevelPair : Current.LevelsData)
+		{
+			const FEssLevelData& LevelData = LevelPair.Value;
+			const FEssLevelData* PreviousLevelData = Previous.LevelsData.Find(LevelPair.Key);
+
+			FEssLevelDelta Delta;
+			Delta.ChangedData = EssUtil::GetLevelHeader(LevelData);
+			bool bChanged = !PreviousLevelData || !HaveEqualHeaders(*PreviousLevelData, LevelData);
+
+			TMap<FGuid, const FEssRuntimeActorData*> PreviousRuntimeActors;
+			if (PreviousLevelData)
+			{
+				PreviousRuntimeActors.Reserve(PreviousLevelData->RuntimeActorsData.Num());
+				for (const FEssRuntimeActorData& ActorData : PreviousLevelData->RuntimeActorsData)
+					PreviousRuntimeActors.Add(ActorData.Guid, &ActorData);
+			}
+
+			for (const FEssRuntimeActorData& ActorData : LevelData.RuntimeActorsData)
+			{
+				const FEssRuntimeActorData* PreviousActorData = nullptr;
+				PreviousRuntimeActors.RemoveAndCopyValue(ActorData.Guid, PreviousActorData);
+
+				if (!PreviousActorData || !PreviousActorData->HasSameState(ActorData))
+					Delta.ChangedData.RuntimeActorsData.Add(ActorData);
+			}
+
+			// Whatever wasn't matched by the current records no longer exists
+			PreviousRuntimeActors.GenerateKeyArray(Delta.RemovedRuntimeActors);
+
+			for (const auto& PlacedPair : LevelData.PlacedActorsData)
+			{
+				const FEssPlacedActorData* PreviousActorData = PreviousLevelData ? PreviousLevelData->PlacedActorsData.Find(PlacedPair.Key) : nullptr;
+				if (!PreviousActorData || !PreviousActorData->HasSameState(PlacedPair.Value))
+					Delta.ChangedData.PlacedActorsData.Add(PlacedPair.Key, PlacedPair.Value);
+			}
+
+			if (PreviousLevelData)
+			{
+				for (const auto& PlacedPair : PreviousLevelData->PlacedActorsData)
+				{
+					if (!LevelData.PlacedActorsData.Contains(PlacedPair.Key))
+						Delta.RemovedPlacedActors.Add(PlacedPair.Key);
+				}
+			}
+
+			bChanged |= Delta.ChangedData.RuntimeActorsData.Num() > 0 || Delta.ChangedData.PlacedActorsData.Num() > 0 ||
+				Delta.RemovedRuntimeActors.Num() > 0 || Delta.RemovedPlacedActors.Num() > 0;
+
+			if (bChanged)
+				OutSnapshot.LevelDeltas.Add(MoveTemp(Delta));
+		}
+
+		for (const auto& LevelPair : Previous.LevelsData)
+		{
+			if (!Current.LevelsData.Contains(LevelPair.Key))
+				OutSnapshot.RemovedLevels.Add(LevelPair.Key);
+		}
+	}
+
+	void ApplyDelta(FEssWorldData& WorldData, const FEssSnapshot& Snapshot)
+	{
+		WorldData.MassArchetypesData = Snapshot.MassArchetypesData;
+		WorldData.bMassEntitiesSaved = Snapshot.bMassEntitiesSaved;
+
+		for (const FString& LevelName : Snapshot.RemovedLevels)
+			WorldData.LevelsData.Remove(LevelName);
+
+		for (const FEssLevelDelta& Delta : Snapshot.LevelDeltas)
+		{
+			const FEssLevelData& ChangedData = Delta.ChangedData;
+
+			FEssLevelData* LevelData = WorldData.LevelsData.Find(ChangedData.Name);
+			if (!LevelData)
+			{
+				// Levels which didn't exist in the previous snapshot are stored in full
+				WorldData.LevelsData.Add(ChangedData.Name, ChangedData);
+				continue;
+			}
+
+			FEssLevelData UpdatedLevelData = EssUtil::GetLevelHeader(ChangedData);
+			UpdatedLevelData.RuntimeActorsData = MoveTemp(LevelData->RuntimeActorsData);
+			UpdatedLevelData.PlacedActorsData = MoveTemp(LevelData->PlacedActorsData);
+			*LevelData = MoveTemp(UpdatedLevelData);
+
+			if (Delta.RemovedRuntimeActors.Num() > 0)
+			{
+				TSet<FGuid> RemovedGuids(Delta.RemovedRuntimeActors);
+				LevelData->RuntimeActorsData.RemoveAll([&RemovedGuids](const FEssRuntimeActorData& ActorData)
+				{
+					return RemovedGuids.Contains(ActorData.Guid);
+				});
+			}
+
+			if (ChangedData.RuntimeActorsData.Num() > 0)
+			{
+				TMap<FGuid, int32> RuntimeActorIndices;
+				RuntimeActorIndices.Reserve(LevelData->RuntimeActorsData.Num());
+				for (int32 i = 0; i < LevelData->RuntimeActorsData.Num(); ++i)
+					RuntimeActorIndices.Add(LevelData->RuntimeActorsData[i].Guid, i);
+
+				for (const FEssRuntimeActorData& ActorData : ChangedData.RuntimeActorsData)
+				{
+					if (const int32* Index = RuntimeActorIndices.Find(ActorData.Guid))
+						LevelData->RuntimeActorsData[*Index] = ActorData;
+					else
+						LevelData->RuntimeActorsData.Add(ActorData);
+				}
+			}
+
+			for (const FName& ActorName : Delta.RemovedPlacedActors)
+				LevelData->PlacedActorsData.Remove(ActorName);
+
+			for (const auto& PlacedPair : ChangedData.PlacedActorsData)
+				LevelData->PlacedActorsData.Add(PlacedPair.Key, PlacedPair.Value);
+		}
+	}
+
+	SIZE_T GetAllocatedSize(const TArray<FEssComponentData>& ComponentsData)
+	{
+		SIZE_T Size = ComponentsData.GetAllocatedSize();
+		for (const FEssComponentData& ComponentData : ComponentsData)
+			Size += ComponentData.ByteData.GetAllocatedSize();
+
+		return Size;
+	}
+
+	SIZE_T GetAllocatedSize(const FEssLevelData& LevelData)
+	{
+		SIZE_T Size = LevelData.RuntimeActorsData.GetAllocatedSize() + LevelData.PlacedActorsData.GetAllocatedSize() +
+			LevelData.ObjectReferences.GetAllocatedSize();
+
+		for (const FEssRuntimeActorData& ActorData : LevelData.RuntimeActorsData)
+			Size += ActorData.ByteData.GetAllocatedSize() + GetAllocatedSize(ActorData.ComponentsData);
+
+		for (const auto& PlacedPair : LevelData.PlacedActorsData)
+			Size += PlacedPair.Value.ByteData.GetAllocatedSize() + GetAllocatedSize(PlacedPair.Value.ComponentsData);
+
+		Size += LevelData.InstancesData.GetAllocatedSize();
+		for (const FEssInstancesData& InstancesData : LevelData.InstancesData)
+			Size += InstancesData.RemovedInstances.GetAllocatedSize() + InstancesData.AddedInstances.GetAllocatedSize();
+
+		return Size;
+	}
+
+	SIZE_T GetAllocatedSize(const TArray<FEssMassArchetypeData>& MassArchetypesData)
+	{
+		SIZE_T Size = MassArchetypesData.GetAllocatedSize();
+		for (const FEssMassArchetypeData& ArchetypeData : MassArchetypesData)
+		{
+			Size += ArchetypeData.FragmentTypes.GetAllocatedSize() + ArchetypeData.TagTypes.GetAllocatedSize() + ArchetypeData.FragmentsData.GetAllocatedSize();
+			for (const FEssMassFragmentData& FragmentData : ArchetypeData.FragmentsData)
+				Size += FragmentData.ByteData.GetAllocatedSize();
+		}
+
+		return Size;
+	}
+
+	SIZE_T GetAllocatedSize(const FEssWorldData& WorldData)
+	{
+		SIZE_T Size = WorldData.LevelsData.GetAllocatedSize() + GetAllocatedSize(WorldData.MassArchetypesData);
+		for (const auto& LevelPair : WorldData.LevelsData)
+			Size += GetAllocatedSize(LevelPair.Value);
+
+		return Size;
+	}
+}
+
+void FEssSnapshotRing::SetCapacity(const int32 NewCapacity)
+{
+	const int32 Capacity = FMath::Max(NewCapacity, 1);
+	if (Capacity == Snapshots.Num())
+		return;
+
+	Reset();
+	Snapshots.SetNum(Capacity);
+}
+
+int32 FEssSnapshotRing::Add(FEssWorldData&& WorldData)
+{
+	check(Snapshots.Num() > 0);
+
+	if (NumSnapshots > 0 && Latest.Name != WorldData.Name)
+		Reset();
+
+	if (NumSnapshots == Snapshots.Num())
+		EvictOldest();
+
+	FEssSnapshot& Snapshot = GetAtPosition(NumSnapshots);
+	Snapshot = FEssSnapshot();
+	Snapshot.Id = NextId++;
+	Snapshot.Time = FDateTime::Now();
+
+	if (NumSnapshots == 0)
+	{
+		Snapshot.bKeyframe = true;
+		Snapshot.Keyframe = WorldData;
+	}
+	else
+	{
+		EssSnapshot::MakeDelta(Latest, WorldData, Snapshot);
+	}
+
+	++NumSnapshots;
+	Latest = MoveTemp(WorldData);
+
+	return Snapshot.Id;
+}
+
+const FEssWorldData* FEssSnapshotRing::Get(const int32 SnapshotId, FEssWorldData& OutScratch) const
+{
+	const int32 Position = FindPosition(SnapshotId);
+	if (Position == INDEX_NONE)
+		return nullptr;
+
+	if (Position == NumSnapshots - 1)
+		return &Latest;
+
+	OutScratch = GetAtPosition(0).Keyframe;
+	for (int32 i = 1; i <= Position; ++i)
+		EssSnapshot::ApplyDelta(OutScratch, GetAtPosition(i));
+
+	return &OutScratch;
+}
+
+void FEssSnapshotRing::GetIds(TArray<int32>& OutIds) const
+{
+	OutIds.Reset(NumSnapshots);
+	for (int32 i = 0; i < NumSnapshots; ++i)
+		OutIds.Add(GetAtPosition(i).Id);
+}
+
+void FEssSnapshotRing::Reset()
+{
+	for (FEssSnapshot& Snapshot : Snapshots)
+		Snapshot = FEssSnapshot();
+
+	Head = 0;
+	NumSnapshots = 0;
+	Latest = FEssWorldData();
+}
+
+SIZE_T FEssSnapshotRing::GetAllocatedSize() const
+{
+	SIZE_T Size = Snapshots.GetAllocatedSize() + EssSnapshot::GetAllocatedSize(Latest);
+
+	for (int32 i = 0; i < NumSnapshots; ++i)
+	{
+		const FEssSnapshot& Snapshot = GetAtPosition(i);
+		Size += EssSnapshot::GetAllocatedSize(Snapshot.Keyframe) + Snapshot.LevelDeltas.GetAllocatedSize() +
+			EssSnapshot::GetAllocatedSize(Snapshot.MassArchetypesData);
+
+		for (const FEssLevelDelta& Delta : Snapshot.LevelDeltas)
+		{
+			Size += EssSnapshot::GetAllocatedSize(Delta.ChangedData) + Delta.RemovedRuntimeActors.GetAllocatedSize() +
+				Delta.RemovedPlacedActors.GetAllocatedSize();
+		}
+	}
+
+	return Size;
+}
+
+int32 FEssSnapshotRing::FindPosition(const int32 SnapshotId) const
+{
+	if (NumSnapshots == 0)
+		return INDEX_NONE;
+
+	// Ids are consecutive from the oldest to the newest snapshot
+	const int32 Position = SnapshotId - GetAtPosition(0).Id;
+	return Position >= 0 && Position < NumSnapshots ? Position : INDEX_NONE;
+}
+
+void FEssSnapshotRing::EvictOldest()
+{
+	FEssSnapshot& Oldest = GetAtPosition(0);
+
+	if (NumSnapshots > 1)
+	{
+		FEssSnapshot& Next = GetAtPosition(1);
+		EssSnapshot::ApplyDelta(Oldest.Keyframe, Next);
+
+		Next.bKeyframe = true;
+		Next.Keyframe = MoveTemp(Oldest.Keyframe);
+		Next.LevelDeltas.Empty();
+		Next.RemovedLevels.Empty();
+		Next.MassArchetypesData.Empty();
+	}
+
+	Oldest = FEssSnapshot();
+	Head = (Head + 1) % Snapshots.Num();
+	--NumSnapshots;
+}
@@ -0,0 +1,96 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSpatialGrid.h"
+#include "EssSaveData.h"
+#include "EssSettings.h"
+#include "EssStats.h"
+
+FIntPoint FEssSpatialGrid::GetCell(const FVector& Location, const float CellSize)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void FEssSpatialGrid::Build(FEssLevelData& LevelData, const float CellSize)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssBuildSpatialGrid);
+
+	LevelData.GridCells.Reset();
+	LevelData.GridCellSize = FMath::Max(CellSize, 0.f);
+	if (LevelData.GridCellSize <= 0.f)
+		return;
+
+	TMap<FIntPoint, int32> CellIndices;
+	auto FindOrAddCell = [&LevelData, &CellIndices](const FVector& Location) -> FEssGridCellData&
+	{
+		const FIntPoint Cell = GetCell(Location, LevelData.GridCellSize);
+		if (const int32* CellIndex = CellIndices.Find(Cell))
+			return LevelData.GridCells[*CellIndex];
+
+		CellIndices.Add(Cell, LevelData.GridCells.Num());
+		FEssGridCellData& CellData = LevelData.GridCells.AddDefaulted_GetRef();
+		CellData.Cell = Cell;
+		return CellData;
+	};
+
+	for (int32 Index = 0; Index < LevelData.RuntimeActorsData.Num(); ++Index)
+		FindOrAddCell(LevelData.RuntimeActorsData[Index].Transform.GetLocation()).RuntimeActors.Add(Index);
+
+	for (const auto& PlacedPair : LevelData.PlacedActorsData)
+		FindOrAddCell(PlacedPair.Value.Transform.GetLocation()).PlacedActors.Add(PlacedPair.Key);
+}
+
+void FEssSpatialGrid::Build(FEssWorldData& WorldData)
+{
+	const float CellSize = GetDefault<UEssSettings>()->RegionCellSize;
+	for (auto& LevelPair : WorldData.LevelsData)
+		Build(LevelPair.Value, CellSize);
+}
+
+void FEssSpatialGrid::FindRecords(const FEssLevelData& LevelData, const FBox& Bounds, TArray<int32>& OutRuntimeActors, TArray<FName>& OutPlacedActors)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssFindRegionRecords);
+
+	if (!Bounds.IsValid)
+		return;
+
+	// Slots saved before grids existed or with a cell size of zero
+	if (LevelData.GridCellSize <= 0.f)
+	{
+		for (int32 Index = 0; Index < LevelData.RuntimeActorsData.Num(); ++Index)
+		{
+			if (Bounds.IsInsideOrOn(LevelData.RuntimeActorsData[Index].Transform.GetLocation()))
+				OutRuntimeActors.Add(Index);
+		}
+
+		for (const auto& PlacedPair : LevelData.PlacedActorsData)
+		{
+			if (Bounds.IsInsideOrOn(PlacedPair.Value.Transform.GetLocation()))
+				OutPlacedActors.Add(PlacedPair.Key);
+		}
+
+		return;
+	}
+
+	const FIntPoint MinCell = GetCell(Bounds.Min, LevelData.GridCellSize);
+	const FIntPoint MaxCell = GetCell(Bounds.Max, LevelData.GridCellSize);
+
+	for (const FEssGridCellData& CellData : LevelData.GridCells)
+	{
+		if (CellData.Cell.X < MinCell.X || CellData.Cell.X > MaxCell.X || CellData.Cell.Y < MinCell.Y || CellData.Cell.Y > MaxCell.Y)
+			continue;
+
+		// Cells are only partly covered by the bounds at their border, and span the whole height of the level
+		for (const int32 Index : CellData.RuntimeActors)
+		{
+			if (LevelData.RuntimeActorsData.IsValidIndex(Index) && Bounds.IsInsideOrOn(LevelData.RuntimeActorsData[Index].Transform.GetLocation()))
+				OutRuntimeActors.Add(Index);
+		}
+
+		for (const FName& Name : CellData.PlacedActors)
+		{
+			const FEssPlacedActorData* ActorData = LevelData.PlacedActorsData.Find(Name);
+			if (ActorData && Bounds.IsInsideOrOn(ActorData->Transform.GetLocation()))
+				OutPlacedActors.Add(Name);
+		}
+	}
+}
@@ -0,0 +1,210 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+
+DEFINE_LOG_CATEGORY(LogEss);
+
+DEFINE_STAT(STAT_EssSaveWorld);
+DEFINE_STAT(STAT_EssLoadWorld);
+DEFINE_STAT(STAT_EssSaveGlobalObject);
+DEFINE_STAT(STAT_EssLoadGlobalObject);
+DEFINE_STAT(STAT_EssGetLevelData);
+DEFINE_STAT(STAT_EssRestoreLevelData);
+DEFINE_STAT(STAT_EssExtractActorData);
+DEFINE_STAT(STAT_EssExtractGlobalObjectData);
+DEFINE_STAT(STAT_EssRestoreActorData);
+DEFINE_STAT(STAT_EssRestoreGlobalObjectData);
+DEFINE_STAT(STAT_EssRespawnActor);
+DEFINE_STAT(STAT_EssResolveReferences);
+DEFINE_STAT(STAT_EssPreloadClasses);
+DEFINE_STAT(STAT_EssTickRestoreQueue);
+DEFINE_STAT(STAT_EssExtractInstances);
+DEFINE_STAT(STAT_EssRestoreInstances);
+DEFINE_STAT(STAT_EssExtractMassEntities);
+DEFINE_STAT(STAT_EssRestoreMassEntities);
+DEFINE_STAT(STAT_EssBuildSpatialGrid);
+DEFINE_STAT(STAT_EssFindRegionRecords);
+DEFINE_STAT(STAT_EssSlotWrite);
+DEFINE_STAT(STAT_EssSlotRead);
+
+DEFINE_STAT(STAT_EssActorsCaptured);
+DEFINE_STAT(STAT_EssActorsRestored);
+DEFINE_STAT(STAT_EssActorsSpawned);
+DEFINE_STAT(STAT_EssActorsDestroyed);
+DEFINE_STAT(STAT_EssReferencesResolved);
+DEFINE_STAT(STAT_EssClassesPreloaded);
+DEFINE_STAT(STAT_EssActorsDeferred);
+DEFINE_STAT(STAT_EssInstancesRestored);
+DEFINE_STAT(STAT_EssMassEntitiesRestored);
+DEFINE_STAT(STAT_EssBytesSerialized);
+DEFINE_STAT(STAT_EssFileBytesWritten);
+DEFINE_STAT(STAT_EssFileBytesRead);
+
+DEFINE_STAT(STAT_EssSnapshotMemory);
+
+namespace
+{
+	int32 ParseCount(const TArray<FString>& Args, const int32 Default)
+	{
+		if (Args.Num() > 0 && Args[0].IsNumeric())
+			return FMath::Max(1, FCString::Atoi(*Args[0]));
+
+		return Default;
+	}
+
+	FAutoConsoleCommandWithArgsAndOutputDevice DumpTimingsCommand(
+		TEXT("Ess.DumpTimings"),
+		TEXT("Dumps the last N save and load timings of the Enhanced Save System. Usage: Ess.DumpTimings [N]"),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			FEssStats::Get().DumpTimings(ParseCount(Args, 16), Ar);
+		}));
+
+	FAutoConsoleCommandWithArgsAndOutputDevice DumpClassBytesCommand(
+		TEXT("Ess.DumpClassBytes"),
+		TEXT("Dumps the N classes with the most bytes serialized by the Enhanced Save System. Usage: Ess.DumpClassBytes [N]"),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			FEssStats::Get().DumpClassBytes(ParseCount(Args, 32), Ar);
+		}));
+
+	FAutoConsoleCommand ResetStatsCommand(
+		TEXT("Ess.ResetStats"),
+		TEXT("Clears the timings and per class byte counts kept by the Enhanced Save System."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FEssStats::Get().Reset();
+		}));
+}
+
+FEssStats& FEssStats::Get()
+{
+	static FEssStats Instance;
+	return Instance;
+}
+
+void FEssStats::RecordTiming(const FEssOperationTiming& Timing)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (Timings.Num() < MaxTimings)
+	{
+		Timings.Add(Timing);
+	}
+	else
+	{
+		Timings[NextTimingIndex] = Timing;
+	}
+
+	NextTimingIndex = (NextTimingIndex + 1) % MaxTimings;
+}
+
+void FEssStats::AddClassBytes(const UClass* Class, const int64 Bytes)
+{
+	INC_QWORD_STAT_BY(STAT_EssBytesSerialized, Bytes);
+
+	if (!Class)
+		return;
+
+	check(IsInGameThread());
+	ClassBytes.FindOrAdd(Class) += Bytes;
+}
+
+void FEssStats::AddFileBytesWritten(const int64 Bytes)
+{
+	INC_QWORD_STAT_BY(STAT_EssFileBytesWritten, Bytes);
+
+	FScopeLock ScopeLock(&Lock);
+	TotalFileBytesWritten += Bytes;
+}
+
+void FEssStats::AddFileBytesRead(const int64 Bytes)
+{
+	INC_QWORD_STAT_BY(STAT_EssFileBytesRead, Bytes);
+
+	FScopeLock ScopeLock(&Lock);
+	TotalFileBytesRead += Bytes;
+}
+
+TArray<FEssOperationTiming> FEssStats::GetRecentTimings(const int32 Count) const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	TArray<FEssOperationTiming> Result;
+	const int32 Num = FMath::Min(Count, Timings.Num());
+	Result.Reserve(Num);
+
+	for (int32 i = 1; i <= Num; ++i)
+	{
+		const int32 Index = (NextTimingIndex - i + MaxTimings) % MaxTimings;
+		Result.Add(Timings[Index]);
+	}
+
+	return Result;
+}
+
+void FEssStats::DumpTimings(const int32 Count, FOutputDevice& Ar) const
+{
+	const TArray<FEssOperationTiming> Recent = GetRecentTimings(Count);
+
+	Ar.Logf(TEXT("ESS: last %d operations (newest first)"), Recent.Num());
+	for (const FEssOperationTiming& Timing : Recent)
+	{
+		Ar.Logf(TEXT("  %s %-18s slot=%-16s %9.3f ms actors=%-7d file=%lld bytes%s"),
+			*Timing.Time.ToString(TEXT("%H:%M:%S.%s")), *Timing.Operation, *Timing.SlotName, Timing.DurationMs,
+			Timing.ActorCount, Timing.FileBytes, Timing.bSucceeded ? TEXT("") : TEXT(" FAILED"));
+	}
+}
+
+void FEssStats::DumpClassBytes(const int32 Count, FOutputDevice& Ar) const
+{
+	check(IsInGameThread());
+
+	TArray<TPair<TObjectKey<UClass>, int64>> Sorted = ClassBytes.Array();
+	int64 WrittenBytes;
+	int64 ReadBytes;
+	{
+		FScopeLock ScopeLock(&Lock);
+		WrittenBytes = TotalFileBytesWritten;
+		ReadBytes = TotalFileBytesRead;
+	}
+
+	Sorted.Sort([](const TPair<TObjectKey<UClass>, int64>& A, const TPair<TObjectKey<UClass>, int64>& B) { return A.Value > B.Value; });
+
+	Ar.Logf(TEXT("ESS: file bytes written %lld, file bytes read %lld"), WrittenBytes, ReadBytes);
+	Ar.Logf(TEXT("ESS: serialized bytes per class (top %d of %d)"), FMath::Min(Count, Sorted.Num()), Sorted.Num());
+	for (int32 i = 0; i < Sorted.Num() && i < Count; ++i)
+	{
+		// Classes which have been unloaded since, e.g. blueprints recompiled in the editor, can't be named anymore
+		const UClass* Class = Sorted[i].Key.ResolveObjectPtr();
+		Ar.Logf(TEXT("  %12lld  %s"), Sorted[i].Value, Class ? *Class->GetPathName() : TEXT("<unloaded class>"));
+	}
+}
+
+void FEssStats::Reset()
+{
+	check(IsInGameThread());
+	ClassBytes.Reset();
+
+	FScopeLock ScopeLock(&Lock);
+	Timings.Reset();
+	NextTimingIndex = 0;
+	TotalFileBytesWritten = 0;
+	TotalFileBytesRead = 0;
+}
+
+FEssScopedTiming::FEssScopedTiming(const TCHAR* Operation, const FString& SlotName)
+	: StartTime(FPlatformTime::Seconds())
+{
+	Timing.Operation = Operation;
+	Timing.SlotName = SlotName;
+	Timing.Time = FDateTime::Now();
+}
+
+FEssScopedTiming::~FEssScopedTiming()
+{
+	Timing.DurationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	FEssStats::Get().RecordTiming(Timing);
+}
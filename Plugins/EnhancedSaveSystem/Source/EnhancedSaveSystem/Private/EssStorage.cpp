@@ -0,0 +1,146 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssStorage.h"
+#include "EssSettings.h"
+#include "EssStats.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/ScopeLock.h"
+
+const FName FEssStorage::SaveGameBackend = TEXT("SaveGame");
+const FName FEssStorage::IoUringBackend = TEXT("IoUring");
+
+namespace EssStorage
+{
+	/**
+	 * Registers the built-in backends and selects the one of the settings on first use.
+	 */
+	struct FRegistry
+	{
+		FRegistry()
+		{
+			Backends.Add(FEssStorage::SaveGameBackend, MakeShared<FEssSaveGameStorageBackend>());
+			Backends.Add(FEssStorage::IoUringBackend, MakeShared<FEssIoUringStorageBackend>());
+
+			// A backend of the game may be registered after the first slot access, it replaces the default once it is
+			ActiveName = GetDefault<UEssSettings>()->StorageBackend;
+			const TSharedRef<IEssStorageBackend>* Backend = Backends.Find(ActiveName);
+			if (!Backend)
+			{
+				UE_LOG(LogEss, Log, TEXT("Storage backend %s is not registered yet. Using %s until it is."), *ActiveName.ToString(), *FEssStorage::SaveGameBackend.ToString());
+				Backend = Backends.Find(FEssStorage::SaveGameBackend);
+			}
+
+			Active = *Backend;
+		}
+
+		FCriticalSection Mutex;
+		TMap<FName, TSharedRef<IEssStorageBackend>> Backends;
+		TSharedPtr<IEssStorageBackend> Active;
+		FName ActiveName;
+	};
+
+	FRegistry& GetRegistry()
+	{
+		static FRegistry Registry;
+		return Registry;
+	}
+
+	FAutoConsoleCommandWithArgsAndOutputDevice StorageBackendCommand(
+		TEXT("Ess.StorageBackend"),
+		TEXT("Prints or selects the storage backend of the Enhanced Save System. Usage: Ess.StorageBackend [SaveGame|IoUring]"),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			if (Args.Num() > 0 && !FEssStorage::SetBackend(FName(*Args[0])))
+				Ar.Logf(TEXT("Storage backend %s does not exist."), *Args[0]);
+
+			Ar.Logf(TEXT("Storage backend: %s"), *FEssStorage::GetBackendName().ToString());
+		}));
+}
+
+bool IEssStorageBackend::Write(const FString& SlotName, const int32 UserIndex, const TArray<uint8>& Bytes)
+{
+	FEssSlotWrite SlotWrite;
+	SlotWrite.SlotName = SlotName;
+	SlotWrite.UserIndex = UserIndex;
+	SlotWrite.Bytes = &Bytes;
+
+	WriteBatch(MakeArrayView(&SlotWrite, 1));
+	return SlotWrite.bSucceeded;
+}
+
+bool IEssStorageBackend::ReadRange(const FString& SlotName, const int32 UserIndex, const int64 Offset, const int64 Size, TArray<uint8>& OutBytes)
+{
+	TArray<uint8> Bytes;
+	if (!Read(SlotName, UserIndex, Bytes) || Offset < 0 || Size < 0 || Offset + Size > Bytes.Num())
+		return false;
+
+	OutBytes = TArray<uint8>(Bytes.GetData() + Offset, Size);
+	return true;
+}
+
+bool FEssSaveGameStorageBackend::DoesSlotExist(const FString& SlotName, const int32 UserIndex)
+{
+	return UGameplayStatics::DoesSaveGameExist(SlotName, UserIndex);
+}
+
+bool FEssSaveGameStorageBackend::Read(const FString& SlotName, const int32 UserIndex, TArray<uint8>& OutBytes)
+{
+	return UGameplayStatics::LoadDataFromSlot(OutBytes, SlotName, UserIndex);
+}
+
+bool FEssSaveGameStorageBackend::Delete(const FString& SlotName, const int32 UserIndex)
+{
+	return UGameplayStatics::DeleteGameInSlot(SlotName, UserIndex);
+}
+
+void FEssSaveGameStorageBackend::WriteBatch(TArrayView<FEssSlotWrite> Writes)
+{
+	// Every slot is its own file, so slots are written in parallel
+	ParallelFor(Writes.Num(), [&Writes](const int32 Index)
+	{
+		FEssSlotWrite& SlotWrite = Writes[Index];
+		SlotWrite.bSucceeded = SlotWrite.Bytes && UGameplayStatics::SaveDataToSlot(*SlotWrite.Bytes, SlotWrite.SlotName, SlotWrite.UserIndex);
+	}, Writes.Num() <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+TSharedRef<IEssStorageBackend> FEssStorage::Get()
+{
+	EssStorage::FRegistry& Registry = EssStorage::GetRegistry();
+	FScopeLock Lock(&Registry.Mutex);
+	return Registry.Active.ToSharedRef();
+}
+
+FName FEssStorage::GetBackendName()
+{
+	EssStorage::FRegistry& Registry = EssStorage::GetRegistry();
+	FScopeLock Lock(&Registry.Mutex);
+	return Registry.ActiveName;
+}
+
+bool FEssStorage::SetBackend(const FName Name)
+{
+	EssStorage::FRegistry& Registry = EssStorage::GetRegistry();
+	FScopeLock Lock(&Registry.Mutex);
+
+	const TSharedRef<IEssStorageBackend>* Backend = Registry.Backends.Find(Name);
+	if (!Backend)
+		return false;
+
+	Registry.Active = *Backend;
+	Registry.ActiveName = Name;
+	UE_LOG(LogEss, Log, TEXT("Storage backend set to %s."), *Name.ToString());
+	return true;
+}
+
+void FEssStorage::RegisterBackend(const FName Name, const TSharedRef<IEssStorageBackend>& Backend)
+{
+	EssStorage::FRegistry& Registry = EssStorage::GetRegistry();
+	FScopeLock Lock(&Registry.Mutex);
+
+	Registry.Backends.Add(Name, Backend);
+	if (Registry.ActiveName == Name)
+		Registry.Active = Backend;
+}
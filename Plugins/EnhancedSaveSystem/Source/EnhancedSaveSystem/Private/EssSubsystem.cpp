@@ -2,53 +2,160 @@
 
 #include "EssSubsystem.h"
 
+#include "EssInstances.h"
+#include "EssMass.h"
 #include "EssSavableInterface.h"
+#include "EssSaveArchive.h"
 #include "EssSaveData.h"
 #include "EssSaveGame.h"
+#include "EssSettings.h"
+#include "EssSpatialGrid.h"
+#include "EssStats.h"
+#include "EssStorage.h"
 #include "EssUtil.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/Paths.h"
 #include "Serialization/ObjectAndNameAsStringProxyArchive.h"
 #include "Serialization/MemoryWriter.h"
 #include "Serialization/MemoryReader.h"
+#include "UObject/StrongObjectPtr.h"
+
+/**
+ * A single player's part of a slot, saved to its own save game slot.
+ */
+struct FEssPlayerShard
+{
+	APlayerState* PlayerState = nullptr;
+	FString SlotName;
+	TArray<UObject*> GlobalObjects;
+	TArray<UObject*> SavedObjects;
+	TArray<AActor*> Actors;
+	TArray<uint8> Bytes;
+	UEssSaveGame* SaveGame = nullptr;
+	bool bSlotExists = false;
+	bool bSucceeded = false;
+};
+
+/**
+ * Actors of a level matched with the records they are restored from.
+ * Every actor of a load is spawned before any record is restored, so references between actors can be resolved.
+ */
+struct FEssLevelRestore
+{
+	const FEssLevelData* LevelData = nullptr;
+
+	/** Runtime actors which aren't respawnable and are restored where they are. */
+	TArray<TPair<AActor*, const FEssRuntimeActorData*>> RuntimeActorsInPlace;
+	bool bNotifyRuntimeActorsInPlace = false;
+
+	TArray<TPair<AActor*, const FEssRuntimeActorData*>> RuntimeActors;
+	TArray<TPair<AActor*, const FEssPlacedActorData*>> PlacedActors;
+
+	/** Placed actors without a record, reset to their level-authored state. */
+	TArray<TPair<AActor*, const FEssPlacedActorData*>> ResetActors;
+	TArray<AActor*> ActorsToDestroy;
+};
+
+/**
+ * Records of a level whose saved location lies within the bounds of a region.
+ */
+struct FEssRegionRecords
+{
+	ULevel* Level = nullptr;
+	const FEssLevelData* LevelData = nullptr;
+	TArray<int32> RuntimeActors;
+	TArray<FName> PlacedActors;
+};
+
+/**
+ * A single actor of a restore, restored from its record or reset to its level-authored state.
+ */
+struct FEssRestoreItem
+{
+	TWeakObjectPtr<AActor> Actor;
+	const FEssRuntimeActorData* RuntimeActorData = nullptr;
+	const FEssPlacedActorData* PlacedActorData = nullptr;
+
+	/** Reference table of the record's level. Actors which are reset refer to the table of their level's baselines instead. */
+	const TArray<FEssObjectReference>* References = nullptr;
+	bool bReset = false;
+	bool bNotify = true;
+	int32 Priority = 0;
+	double DistanceSquared = 0.0;
+};
+
+/**
+ * Restore of LoadWorldAsync which continues over the following frames once the world is playable.
+ * The save game is kept alive because the items point into its records.
+ */
+struct FEssRestoreQueue
+{
+	TStrongObjectPtr<UEssSaveGame> SaveGame;
+	TArray<FEssRestoreItem> Items;
+	int32 NextItem = 0;
+	TUniquePtr<FEssReferenceResolver> Resolver;
+	FTSTicker::FDelegateHandle TickerHandle;
+	FEssOperationTiming Timing;
+	double StartTime = 0.0;
+};
 
 void UEssSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UEssSubsystem::OnWorldInitializedActors);
+	FWorldDelegates::OnWorldCleanup.AddUObject(this, &UEssSubsystem::OnWorldCleanup);
+	FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UEssSubsystem::OnLevelAddedToWorld);
+	FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UEssSubsystem::OnLevelRemovedFromWorld);
+
+	SnapshotRing.SetCapacity(GetDefault<UEssSettings>()->SnapshotCapacity);
 }
 
 void UEssSubsystem::Deinitialize()
 {
+	FinishRestoreQueue(false);
+	UntrackWorld();
+	WaitForRecordIndexWrites();
+
+	FWorldDelegates::OnWorldInitializedActors.RemoveAll(this);
+	FWorldDelegates::OnWorldCleanup.RemoveAll(this);
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+
 	Super::Deinitialize();
 }
 
 bool UEssSubsystem::SaveWorld(const FString& SlotName, const int32 UserIndex)
 {
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveWorld);
+	FEssScopedTiming ScopedTiming(TEXT("SaveWorld"), SlotName);
+
 	if (SlotName.IsEmpty())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("World not saved. SlotName is empty."));
+		UE_LOG(LogEss, Warning, TEXT("World not saved. SlotName is empty."));
 		return false;
 	}
 
 	UEssSaveGame* SaveGame = GetSaveGameAndCreateIfNotExists(SlotName, UserIndex);
 	if (!IsValid(SaveGame))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("World not saved. SaveGame is not valid."));
+		UE_LOG(LogEss, Warning, TEXT("World not saved. SaveGame is not valid."));
 		return false;
 	}
 
-	UWorld* World = GetWorld();
-	FString WorldName = World->GetFName().ToString();
-
-	SaveGame->DeleteWorldData(SlotName, WorldName);
-
-	FEssWorldData WorldData;
-	WorldData.Name = WorldName;
+	FEssWorldData WorldData = GetWorldData(ScopedTiming.Timing.ActorCount);
+	FEssSpatialGrid::Build(WorldData);
 
-	for (auto Level : World->GetLevels())
-	{
-		FEssLevelData LevelData = GetLevelData(Level);
-		WorldData.LevelsData.Add(LevelData.Name, LevelData);
-	}
+	SaveGame->DeleteWorldData(SlotName, WorldData.Name);
 
 	FEssSaveData* FoundSaveData = SaveGame->SaveData.Find(SlotName);
 	if (FoundSaveData)
@@ -71,30 +178,34 @@ bool UEssSubsystem::SaveWorld(const FString& SlotName, const int32 UserIndex)
 		SaveGame->SaveData.Add(SlotName, SaveData);
 	}
 
-	bool bSaved = UGameplayStatics::SaveGameToSlot(SaveGame, SlotName, UserIndex);
+	bool bSaved = WriteSaveGame(SaveGame, SlotName, UserIndex, ScopedTiming.Timing.FileBytes);
 
 	if (bSaved)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("World saved."));
+		UE_LOG(LogEss, Log, TEXT("World saved."));
+		ScopedTiming.Timing.bSucceeded = true;
 		return true;
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("World not saved."));
+	UE_LOG(LogEss, Warning, TEXT("World not saved."));
 	return false;
 }
 
 bool UEssSubsystem::LoadWorld(const FString& SlotName, const int32 UserIndex)
 {
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("LoadWorld"), SlotName);
+
 	if (SlotName.IsEmpty())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("World not loaded. SlotName is empty."));
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. SlotName is empty."));
 		return false;
 	}
 
-	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex);
+	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex, &ScopedTiming.Timing.FileBytes);
 	if (!IsValid(SaveGame))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("World not loaded. SaveGame is not valid."));
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. SaveGame is not valid."));
 		return false;
 	}
 
@@ -105,36 +216,204 @@ bool UEssSubsystem::LoadWorld(const FString& SlotName, const int32 UserIndex)
 
 	if (WorldData)
 	{
-		for (auto Level : World->GetLevels())
+		TSet<FSoftObjectPath> ClassPaths;
+		EssUtil::GetUnloadedClasses(*WorldData, ClassPaths);
+		PreloadClasses(ClassPaths);
+
+		ScopedTiming.Timing.ActorCount = RestoreWorldData(*WorldData);
+
+		UE_LOG(LogEss, Log, TEXT("World loaded."));
+		ScopedTiming.Timing.bSucceeded = true;
+		return true;
+	}
+
+	return false;
+}
+
+bool UEssSubsystem::SaveRegion(const FBox& Bounds, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveWorld);
+	FEssScopedTiming ScopedTiming(TEXT("SaveRegion"), SlotName);
+
+	if (SlotName.IsEmpty() || !Bounds.IsValid)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Region not saved. SlotName is empty or Bounds are not valid."));
+		return false;
+	}
+
+	UEssSaveGame* SaveGame = GetSaveGameAndCreateIfNotExists(SlotName, UserIndex);
+	if (!IsValid(SaveGame))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Region not saved. SaveGame is not valid."));
+		return false;
+	}
+
+	const FString WorldName = GetWorld()->GetFName().ToString();
+	FEssWorldData& WorldData = SaveGame->FindOrAddSaveData(SlotName).WorldsData.FindOrAdd(WorldName);
+	WorldData.Name = WorldName;
+
+	for (auto Level : GetWorld()->GetLevels())
+	{
+		FEssLevelData* LevelData = WorldData.LevelsData.Find(EssUtil::GetLevelName(Level));
+		if (LevelData)
 		{
-			FEssLevelData* LevelData = WorldData->LevelsData.Find(EssUtil::GetLevelName(Level));
-			if (LevelData)
-				RestoreLevelData(Level, LevelData);
+			ScopedTiming.Timing.ActorCount += SaveLevelRegion(Level, Bounds, *LevelData);
+			continue;
 		}
 
-		UE_LOG(LogTemp, Warning, TEXT("World loaded."));
+		// A level without a record would lose all of its actors outside of the region on the next load, so it is saved as a whole
+		FEssLevelData NewLevelData = GetLevelData(Level);
+		FEssSpatialGrid::Build(NewLevelData, GetDefault<UEssSettings>()->RegionCellSize);
+		ScopedTiming.Timing.ActorCount += NewLevelData.RuntimeActorsData.Num() + NewLevelData.PlacedActorsData.Num();
+		WorldData.LevelsData.Add(NewLevelData.Name, MoveTemp(NewLevelData));
+	}
+
+	bool bSaved = WriteSaveGame(SaveGame, SlotName, UserIndex, ScopedTiming.Timing.FileBytes);
+
+	if (bSaved)
+	{
+		UE_LOG(LogEss, Log, TEXT("Region saved."));
+		ScopedTiming.Timing.bSucceeded = true;
 		return true;
 	}
 
+	UE_LOG(LogEss, Warning, TEXT("Region not saved."));
 	return false;
 }
 
+bool UEssSubsystem::LoadRegion(const FBox& Bounds, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("LoadRegion"), SlotName);
+
+	if (SlotName.IsEmpty() || !Bounds.IsValid)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Region not loaded. SlotName is empty or Bounds are not valid."));
+		return false;
+	}
+
+	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex, &ScopedTiming.Timing.FileBytes);
+	if (!IsValid(SaveGame))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Region not loaded. SaveGame is not valid."));
+		return false;
+	}
+
+	const FEssWorldData* WorldData = FindWorldData(SaveGame, SlotName);
+	if (!WorldData)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Region not loaded. Slot %s has no data for this world."), *SlotName);
+		return false;
+	}
+
+	FlushRestoreQueue();
+
+	// Only the classes of the region's records are streamed in
+	TArray<FEssRegionRecords> Regions;
+	TSet<FSoftObjectPath> ClassPaths;
+	for (auto Level : GetWorld()->GetLevels())
+	{
+		const FEssLevelData* LevelData = WorldData->LevelsData.Find(EssUtil::GetLevelName(Level));
+		if (!LevelData)
+			continue;
+
+		FEssRegionRecords& Region = Regions.AddDefaulted_GetRef();
+		Region.Level = Level;
+		Region.LevelData = LevelData;
+		FEssSpatialGrid::FindRecords(*LevelData, Bounds, Region.RuntimeActors, Region.PlacedActors);
+
+		for (const int32 Index : Region.RuntimeActors)
+		{
+			const TSoftClassPtr<AActor>& Class = LevelData->RuntimeActorsData[Index].Class;
+			if (!Class.IsNull() && !Class.Get())
+				ClassPaths.Add(Class.ToSoftObjectPath());
+		}
+
+		for (const FName& Name : Region.PlacedActors)
+		{
+			const TSoftClassPtr<AActor>& Class = LevelData->PlacedActorsData[Name].Class;
+			if (!Class.IsNull() && !Class.Get())
+				ClassPaths.Add(Class.ToSoftObjectPath());
+		}
+	}
+
+	PreloadClasses(ClassPaths);
+
+	// The actors of all levels are spawned first, so references across levels resolve as well
+	TArray<FEssLevelRestore> Restores;
+	for (const FEssRegionRecords& Region : Regions)
+	{
+		PrepareRegionRestore(Region, Bounds, Restores.AddDefaulted_GetRef());
+		ScopedTiming.Timing.ActorCount += Region.RuntimeActors.Num() + Region.PlacedActors.Num();
+	}
+
+	// References are resolved as they are read, a region only needs a fraction of its levels' reference tables
+	FEssReferenceResolver Resolver(GetWorld(), ActorRegistry);
+	for (const FEssLevelRestore& Restore : Restores)
+		FinishLevelRestore(Restore, Resolver);
+
+	UE_LOG(LogEss, Log, TEXT("Region loaded."));
+	ScopedTiming.Timing.bSucceeded = true;
+	return true;
+}
+
+bool UEssSubsystem::LoadWorldAsync(const FString& SlotName, const int32 UserIndex, const FEssWorldLoadedDelegate& OnPlayable, const FEssWorldLoadedDelegate& OnLoaded)
+{
+	if (SlotName.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. SlotName is empty."));
+		return false;
+	}
+
+	// Two restores of the same world would overwrite each other's actors frame by frame
+	if (LoadingSlots.Num() > 0)
+	{
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. Another world load is still in progress."));
+		return false;
+	}
+
+	if (!FEssStorage::Get()->DoesSlotExist(SlotName, UserIndex))
+	{
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. SaveGame does not exist."));
+		return false;
+	}
+
+	LoadingSlots.Add(SlotName, OnLoaded);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ReadSaveGameAsync(SlotName, UserIndex, [WeakThis = TWeakObjectPtr<UEssSubsystem>(this), SlotName, StartTime, OnPlayable](UEssSaveGame* LoadedSaveGame)
+	{
+		if (UEssSubsystem* This = WeakThis.Get())
+			This->OnWorldSlotLoaded(LoadedSaveGame, SlotName, StartTime, OnPlayable);
+	});
+	return true;
+}
+
 bool UEssSubsystem::DeleteSave(const FString& SlotName, const int32 UserIndex)
 {
 	if (SlotName.IsEmpty())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Save not deleted. SlotName is empty."));
+		UE_LOG(LogEss, Warning, TEXT("Save not deleted. SlotName is empty."));
 		return false;
 	}
 
-	return GetSaveGame(SlotName, UserIndex)->DeleteSave(SlotName);
+	WaitForRecordIndexWrites();
+	ResetRecordIndex(SlotName);
+	FEssRecordIndex::Delete(SlotName, UserIndex);
+
+	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex);
+	return IsValid(SaveGame) && SaveGame->DeleteSave(SlotName);
 }
 
 bool UEssSubsystem::SaveGlobalObject(UObject* Obj, const FString& SlotName, const int32 UserIndex)
 {
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveGlobalObject);
+	FEssScopedTiming ScopedTiming(TEXT("SaveGlobalObject"), SlotName);
+
 	if (SlotName.IsEmpty())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not saved. SlotName is empty."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not saved. SlotName is empty."), *Obj->GetFName().ToString());
 		return false;
 	}
 
@@ -144,21 +423,21 @@ bool UEssSubsystem::SaveGlobalObject(UObject* Obj, const FString& SlotName, cons
 	UEssSaveGame* SaveGame = GetSaveGameAndCreateIfNotExists(SlotName, UserIndex);
 	if (!IsValid(SaveGame))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not saved. SaveGame is not valid."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not saved. SaveGame is not valid."), *Obj->GetFName().ToString());
 		return false;
 	}
 
 	FGuid Guid = EssUtil::GetGuid(Obj);
 	if (!Guid.IsValid())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not saved. Object doesn't have a valid GUID set."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not saved. Object doesn't have a valid GUID set."), *Obj->GetFName().ToString());
 		return false;
 	}
 
 	FEssGlobalObjectData ObjectData = ExtractGlobalObjectData(Obj);
 	if (!ObjectData)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not saved. Save data couldn't be extracted."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not saved. Save data couldn't be extracted."), *Obj->GetFName().ToString());
 		return false;
 	}
 
@@ -186,51 +465,72 @@ bool UEssSubsystem::SaveGlobalObject(UObject* Obj, const FString& SlotName, cons
 		SaveGame->SaveData.Add(SlotName, SaveData);
 	}
 
-	bool bSaved = UGameplayStatics::SaveGameToSlot(SaveGame, SlotName, UserIndex);
+	bool bSaved = WriteSaveGame(SaveGame, SlotName, UserIndex, ScopedTiming.Timing.FileBytes);
 
 	if (bSaved)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s saved."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Log, TEXT("Global object %s saved."), *Obj->GetFName().ToString());
+		ScopedTiming.Timing.bSucceeded = true;
 		Cast<IEssSavableInterface>(Obj)->Execute_PostSaveGame(Obj);
 		return true;
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("Global object %s not saved."), *Obj->GetFName().ToString());
+	UE_LOG(LogEss, Warning, TEXT("Global object %s not saved."), *Obj->GetFName().ToString());
 	return false;
 }
 
 bool UEssSubsystem::LoadGlobalObject(UObject* Obj, const FString& SlotName, const int32 UserIndex)
 {
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadGlobalObject);
+	FEssScopedTiming ScopedTiming(TEXT("LoadGlobalObject"), SlotName);
+
 	if (SlotName.IsEmpty())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not loaded. SlotName is empty."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not loaded. SlotName is empty."), *Obj->GetFName().ToString());
 		return false;
 	}
 
 	if (!IsValid(Obj) || !Obj->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
 		return false;
 
-	if (!UGameplayStatics::DoesSaveGameExist(SlotName, UserIndex))
+	if (!FEssStorage::Get()->DoesSlotExist(SlotName, UserIndex))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not loaded. SaveGame does not exist."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not loaded. SaveGame does not exist."), *Obj->GetFName().ToString());
 		return false;
 	}
 
-	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex);
-	if (!IsValid(SaveGame))
+	FGuid Guid = EssUtil::GetGuid(Obj);
+	if (!Guid.IsValid())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not loaded. SaveGame is not valid."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not loaded. Object doesn't have a valid GUID set."), *Obj->GetFName().ToString());
 		return false;
 	}
 
-	FGuid Guid = EssUtil::GetGuid(Obj);
-	if (!Guid.IsValid())
+	// Read only this object's record if the slot has a record index
+	if (TSharedPtr<FEssRecordIndex> RecordIndex = GetRecordIndex(SlotName, UserIndex))
+	{
+		FEssGlobalObjectData ObjectData;
+		const FEssRecordIndexEntry* Entry = RecordIndex->Find(EEssRecordKind::GlobalObject, FString(), FString(), Guid.ToString());
+		if (!Entry || !RecordIndex->ReadRecord(*Entry, ObjectData))
+			return false;
+
+		ScopedTiming.Timing.FileBytes = Entry->Size;
+		RestoreGlobalObjectData(ObjectData, Obj);
+		Cast<IEssSavableInterface>(Obj)->Execute_PostLoadGame(Obj);
+		ScopedTiming.Timing.bSucceeded = true;
+		return true;
+	}
+
+	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex, &ScopedTiming.Timing.FileBytes);
+	if (!IsValid(SaveGame))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s not loaded. Object doesn't have a valid GUID set."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Global object %s not loaded. SaveGame is not valid."), *Obj->GetFName().ToString());
 		return false;
 	}
 
 	FEssSaveData* FoundSaveData = SaveGame->SaveData.Find(SlotName);
+	if (!FoundSaveData)
+		return false;
 
 	for (auto& ObjectData : FoundSaveData->GlobalObjectData)
 	{
@@ -238,6 +538,7 @@ bool UEssSubsystem::LoadGlobalObject(UObject* Obj, const FString& SlotName, cons
 		{
 			RestoreGlobalObjectData(ObjectData, Obj);
 			Cast<IEssSavableInterface>(Obj)->Execute_PostLoadGame(Obj);
+			ScopedTiming.Timing.bSucceeded = true;
 			return true;
 		}
 	}
@@ -245,349 +546,2647 @@ bool UEssSubsystem::LoadGlobalObject(UObject* Obj, const FString& SlotName, cons
 	return false;
 }
 
-FEssLevelData UEssSubsystem::GetLevelData(const TObjectPtr<ULevel> Level)
+bool UEssSubsystem::SaveGlobalObjects(const TArray<UObject*>& Objects, const FString& SlotName, const int32 UserIndex)
 {
-	// TODO: Get current data for this level for backup in case save fails
-
-	FEssLevelData LevelData;
-	LevelData.Name = EssUtil::GetLevelName(Level);
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveGlobalObject);
+	FEssScopedTiming ScopedTiming(TEXT("SaveGlobalObjects"), SlotName);
 
-	for (auto Actor : Level->Actors)
+	if (SlotName.IsEmpty())
 	{
-		if (!IsValid(Actor) || !Actor->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
-			continue;
-
-		if (EssUtil::IsRuntimeActor(Actor))
-		{
-			if (EssUtil::IsActorRespawnable(Actor))
-			{
-				Cast<IEssSavableInterface>(Actor)->Execute_PreSaveGame(Actor);
-				FEssRuntimeActorData ActorData = ExtractRuntimeActorData(Actor);
-				if (ActorData)
-				{
-					LevelData.RuntimeActorsData.Add(ActorData);
-					Cast<IEssSavableInterface>(Actor)->Execute_PostSaveGame(Actor);
-				}
-			}
-			else
-			{
-				FGuid Guid = EssUtil::GetGuid(Actor);
-				if (Guid.IsValid())
-				{
-					Cast<IEssSavableInterface>(Actor)->Execute_PreSaveGame(Actor);
-					FEssRuntimeActorData ActorData = ExtractRuntimeActorData(Actor);
-					if (ActorData)
-					{
-						LevelData.RuntimeActorsData.Add(ActorData);
-						Cast<IEssSavableInterface>(Actor)->Execute_PostSaveGame(Actor);
-					}
-				}
-			}
-		}
-		else
-		{
-			Cast<IEssSavableInterface>(Actor)->Execute_PreSaveGame(Actor);
-			FEssPlacedActorData ActorData = ExtractPlacedActorData(Actor);
-			if (ActorData)
-			{
-				LevelData.PlacedActorsData.Add(ActorData.Name, ActorData);
-				Cast<IEssSavableInterface>(Actor)->Execute_PostSaveGame(Actor);
-			}
-		}
+		UE_LOG(LogEss, Warning, TEXT("Global objects not saved. SlotName is empty."));
+		return false;
 	}
 
-	return LevelData;
-}
-
-void UEssSubsystem::RestoreLevelData(TObjectPtr<ULevel> Level, const FEssLevelData* LevelData)
-{
-	TArray<FEssPlacedActorData> TempPlacedActorsData;
-	LevelData->PlacedActorsData.GenerateValueArray(TempPlacedActorsData);
-	TArray<AActor*> PlacedActorsToBeDestroyed;
-
-	for (auto Actor : Level->Actors)
+	UEssSaveGame* SaveGame = GetSaveGameAndCreateIfNotExists(SlotName, UserIndex);
+	if (!IsValid(SaveGame))
 	{
-		if (!IsValid(Actor) || !Actor->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
-			continue;
+		UE_LOG(LogEss, Warning, TEXT("Global objects not saved. SaveGame is not valid."));
+		return false;
+	}
 
-		if (EssUtil::IsRuntimeActor(Actor))
-		{
-			if (EssUtil::IsActorRespawnable(Actor))
-			{
-				UE_LOG(LogTemp, Display, TEXT("Runtime actor %s being destroyed."), *Actor->GetFName().ToString());
-				Actor->Destroy();
-			}
-			else
-			{
-				FGuid Guid = EssUtil::GetGuid(Actor);
-				if (Guid.IsValid())
-				{
-					for (const auto& ActorData : LevelData->RuntimeActorsData)
-					{
-						if (Guid == ActorData.Guid)
-							RestoreRuntimeActorData(ActorData, Actor);
-					}
-				}
-			}
-		}
-		else
-		{
-			for (int32 i = TempPlacedActorsData.Num() - 1; i >= 0; --i)
-			{
-				if (TempPlacedActorsData[i].Name == Actor->GetFName())
-				{
-					TempPlacedActorsData.RemoveAt(i);
-				}
-			}
+	FEssSaveData& SaveData = SaveGame->FindOrAddSaveData(SlotName);
 
-			const FEssPlacedActorData* PlacedActorSaveData = LevelData->PlacedActorsData.Find(Actor->GetFName());
-			if (!PlacedActorSaveData)
-				PlacedActorsToBeDestroyed.Add(Actor);
+	TArray<UObject*> SavedObjects;
+	const bool bAllExtracted = AddGlobalObjectsData(Objects, SaveData, SavedObjects);
 
-			const FEssPlacedActorData* ActorData = LevelData->PlacedActorsData.Find(Actor->GetFName());
-			if (ActorData)
-			{
-				RestorePlacedActorData(*ActorData, Actor);
-				Cast<IEssSavableInterface>(Actor)->Execute_PostLoadGame(Actor);
-			}
-		}
-	}
+	ScopedTiming.Timing.ActorCount = SavedObjects.Num();
 
-	// Respawn runtime actors with save data
-	for (auto& ActorData : LevelData->RuntimeActorsData)
+	if (SavedObjects.IsEmpty())
 	{
-		if (EssUtil::IsActorRespawnable(ActorData.Class))
-			RespawnRuntimeActor(ActorData, Level);
+		UE_LOG(LogEss, Warning, TEXT("Global objects not saved. No savable objects were passed."));
+		return false;
 	}
 
-	// Respawn placed actors with save data
-	for (auto& ActorData : TempPlacedActorsData)
+	if (!WriteSaveGame(SaveGame, SlotName, UserIndex, ScopedTiming.Timing.FileBytes))
 	{
-		RespawnPlacedActor(ActorData, Level);
+		UE_LOG(LogEss, Warning, TEXT("Global objects not saved."));
+		return false;
 	}
 
-	// Redestroy placed actors with no save data
-	for (auto PlacedActor : PlacedActorsToBeDestroyed)
-	{
-		UE_LOG(LogTemp, Display, TEXT("Placed actor %s being destroyed."), *PlacedActor->GetFName().ToString());
-		PlacedActor->Destroy();
-	}
+	for (UObject* Obj : SavedObjects)
+		Cast<IEssSavableInterface>(Obj)->Execute_PostSaveGame(Obj);
+
+	UE_LOG(LogEss, Log, TEXT("%d global objects saved."), SavedObjects.Num());
+	ScopedTiming.Timing.bSucceeded = bAllExtracted;
+	return bAllExtracted;
 }
 
-FEssRuntimeActorData UEssSubsystem::ExtractRuntimeActorData(TObjectPtr<AActor> Actor)
+bool UEssSubsystem::LoadGlobalObjects(const TArray<UObject*>& Objects, const FString& SlotName, const int32 UserIndex)
 {
-	FEssRuntimeActorData ActorData;
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadGlobalObject);
+	FEssScopedTiming ScopedTiming(TEXT("LoadGlobalObjects"), SlotName);
 
-	if (Actor->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject | RF_BeginDestroyed))
-		return ActorData;
+	if (SlotName.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Global objects not loaded. SlotName is empty."));
+		return false;
+	}
 
-	FGuid Guid = EssUtil::GetGuid(Actor);
-	if (!Guid.IsValid())
+	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex, &ScopedTiming.Timing.FileBytes);
+	if (!IsValid(SaveGame))
 	{
-		Guid = FGuid::NewGuid();
-		if (!EssUtil::SetGuid(Actor, Guid))
-			return ActorData;
+		UE_LOG(LogEss, Warning, TEXT("Global objects not loaded. SaveGame is not valid."));
+		return false;
 	}
 
-	ActorData.Guid = Guid;
-	ActorData.Class = Actor->GetClass();
-	ActorData.Transform = Actor->GetActorTransform();
+	const FEssSaveData* FoundSaveData = SaveGame->SaveData.Find(SlotName);
+	if (!FoundSaveData)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Global objects not loaded. Slot has no save data."));
+		return false;
+	}
 
-	// Pass byte array to fill with data
-	FMemoryWriter MemoryWriter(ActorData.ByteData);
+	const bool bAllLoaded = RestoreGlobalObjectsData(Objects, *FoundSaveData, ScopedTiming.Timing.ActorCount);
 
-	// Find variables with SaveGame property
-	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
-	Archive.ArIsSaveGame = true;
-	Archive.ArNoDelta = true;
+	ScopedTiming.Timing.bSucceeded = bAllLoaded;
+	return bAllLoaded;
+}
 
-	// Convert actor variables to binary data
-	Actor->Serialize(Archive);
+int32 UEssSubsystem::CaptureSnapshot()
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveWorld);
+	FEssScopedTiming ScopedTiming(TEXT("CaptureSnapshot"), FString());
 
-	// Convert actor components' variables to binary data
-	TArray<UActorComponent*> ActorComponents = Actor->GetComponentsByInterface(UEssSavableInterface::StaticClass());
-	SerializeComponents(Archive, ActorComponents);
+	FEssWorldData WorldData = GetWorldData(ScopedTiming.Timing.ActorCount);
+	const int32 SnapshotId = SnapshotRing.Add(MoveTemp(WorldData));
 
-	return ActorData;
+#if STATS
+	SET_MEMORY_STAT(STAT_EssSnapshotMemory, SnapshotRing.GetAllocatedSize());
+#endif
+
+	UE_LOG(LogEss, Verbose, TEXT("Snapshot %d captured."), SnapshotId);
+	ScopedTiming.Timing.bSucceeded = true;
+	return SnapshotId;
 }
 
-FEssPlacedActorData UEssSubsystem::ExtractPlacedActorData(TObjectPtr<AActor> Actor)
+bool UEssSubsystem::RestoreSnapshot(const int32 SnapshotId)
 {
-	FEssPlacedActorData ActorData;
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("RestoreSnapshot"), FString());
 
-	if (Actor->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject | RF_BeginDestroyed))
-		return ActorData;
+	FEssWorldData Scratch;
+	const FEssWorldData* WorldData = SnapshotRing.Get(SnapshotId, Scratch);
+	if (!WorldData)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Snapshot %d not restored. Snapshot doesn't exist."), SnapshotId);
+		return false;
+	}
+
+	if (WorldData->Name != GetWorld()->GetFName().ToString())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Snapshot %d not restored. Snapshot belongs to world %s."), SnapshotId, *WorldData->Name);
+		return false;
+	}
+
+	ScopedTiming.Timing.ActorCount = RestoreWorldData(*WorldData);
+
+	UE_LOG(LogEss, Log, TEXT("Snapshot %d restored."), SnapshotId);
+	ScopedTiming.Timing.bSucceeded = true;
+	return true;
+}
+
+bool UEssSubsystem::FlushSnapshotToSlot(const int32 SnapshotId, const FString& SlotName, const int32 UserIndex, const FEssSnapshotFlushedDelegate& OnFlushed)
+{
+	if (SlotName.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Snapshot %d not flushed. SlotName is empty."), SnapshotId);
+		return false;
+	}
+
+	if (FlushingSlots.Contains(SlotName))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Snapshot %d not flushed. Slot %s is already being flushed to."), SnapshotId, *SlotName);
+		return false;
+	}
+
+	FEssWorldData Scratch;
+	const FEssWorldData* FoundWorldData = SnapshotRing.Get(SnapshotId, Scratch);
+	if (!FoundWorldData)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Snapshot %d not flushed. Snapshot doesn't exist."), SnapshotId);
+		return false;
+	}
+
+	FlushingSlots.Add(SlotName, OnFlushed);
+
+	const double StartTime = FPlatformTime::Seconds();
+	TSharedRef<FEssWorldData> WorldData = MakeShared<FEssWorldData>(FoundWorldData == &Scratch ? MoveTemp(Scratch) : *FoundWorldData);
+	const bool bSlotExists = FEssStorage::Get()->DoesSlotExist(SlotName, UserIndex);
+
+	auto OnSlotLoaded = [WeakThis = TWeakObjectPtr<UEssSubsystem>(this), WorldData, SnapshotId, bSlotExists, StartTime](const FString& LoadedSlotName, const int32 LoadedUserIndex, USaveGame* LoadedSaveGame)
+	{
+		UEssSubsystem* This = WeakThis.Get();
+		if (!This)
+			return;
+
+		// Writing over a slot which exists but couldn't be read would lose its other worlds and global objects
+		UEssSaveGame* SaveGame = Cast<UEssSaveGame>(LoadedSaveGame);
+		if (bSlotExists && !IsValid(SaveGame))
+		{
+			FEssOperationTiming Timing;
+			Timing.Operation = TEXT("FlushSnapshot");
+			Timing.SlotName = LoadedSlotName;
+			Timing.Time = FDateTime::Now();
+			Timing.DurationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			This->OnSnapshotFlushed(Timing, SnapshotId);
+			return;
+		}
+
+		This->WriteSnapshotAsync(SaveGame, MoveTemp(*WorldData), SnapshotId, LoadedSlotName, LoadedUserIndex, StartTime);
+	};
+
+	if (bSlotExists)
+		ReadSaveGameAsync(SlotName, UserIndex, [OnSlotLoaded, SlotName, UserIndex](UEssSaveGame* LoadedSaveGame) { OnSlotLoaded(SlotName, UserIndex, LoadedSaveGame); });
+	else
+		OnSlotLoaded(SlotName, UserIndex, nullptr);
+
+	return true;
+}
+
+TArray<int32> UEssSubsystem::GetSnapshotIds() const
+{
+	TArray<int32> SnapshotIds;
+	SnapshotRing.GetIds(SnapshotIds);
+	return SnapshotIds;
+}
+
+void UEssSubsystem::ClearSnapshots()
+{
+	SnapshotRing.Reset();
+	SET_MEMORY_STAT(STAT_EssSnapshotMemory, 0);
+}
+
+bool UEssSubsystem::SavePlayer(APlayerState* PlayerState, const TArray<UObject*>& GlobalObjects, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveWorld);
+	FEssScopedTiming ScopedTiming(TEXT("SavePlayer"), SlotName);
+
+	if (SlotName.IsEmpty() || !IsValid(PlayerState))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Player not saved. SlotName is empty or PlayerState is not valid."));
+		return false;
+	}
+
+	const FString PlayerId = GetPlayerId(PlayerState);
+	if (PlayerId.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Player %s not saved. Player has neither a unique net id nor an EssGuid."), *PlayerState->GetFName().ToString());
+		return false;
+	}
+
+	TArray<FEssPlayerShard> Shards;
+	FEssPlayerShard& Shard = Shards.AddDefaulted_GetRef();
+	Shard.PlayerState = PlayerState;
+	Shard.SlotName = GetPlayerSlotName(SlotName, PlayerId);
+	Shard.GlobalObjects = GlobalObjects;
+
+	ScopedTiming.Timing.bSucceeded = SavePlayerShards(Shards, UserIndex, ScopedTiming.Timing);
+	return ScopedTiming.Timing.bSucceeded;
+}
+
+bool UEssSubsystem::SavePlayers(const TArray<APlayerState*>& PlayerStates, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSaveWorld);
+	FEssScopedTiming ScopedTiming(TEXT("SavePlayers"), SlotName);
+
+	if (SlotName.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Players not saved. SlotName is empty."));
+		return false;
+	}
+
+	bool bAllSaved = true;
+
+	TArray<FEssPlayerShard> Shards;
+	Shards.Reserve(PlayerStates.Num());
+
+	for (APlayerState* PlayerState : PlayerStates)
+	{
+		const FString PlayerId = IsValid(PlayerState) ? GetPlayerId(PlayerState) : FString();
+		if (PlayerId.IsEmpty())
+		{
+			UE_LOG(LogEss, Warning, TEXT("Player not saved. PlayerState is not valid or has neither a unique net id nor an EssGuid."));
+			bAllSaved = false;
+			continue;
+		}
+
+		FEssPlayerShard& Shard = Shards.AddDefaulted_GetRef();
+		Shard.PlayerState = PlayerState;
+		Shard.SlotName = GetPlayerSlotName(SlotName, PlayerId);
+	}
+
+	bAllSaved &= SavePlayerShards(Shards, UserIndex, ScopedTiming.Timing);
+
+	ScopedTiming.Timing.bSucceeded = bAllSaved;
+	return bAllSaved;
+}
+
+bool UEssSubsystem::LoadPlayer(APlayerState* PlayerState, const TArray<UObject*>& GlobalObjects, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("LoadPlayer"), SlotName);
+
+	if (SlotName.IsEmpty() || !IsValid(PlayerState))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Player not loaded. SlotName is empty or PlayerState is not valid."));
+		return false;
+	}
+
+	const FString PlayerId = GetPlayerId(PlayerState);
+	if (PlayerId.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Player %s not loaded. Player has neither a unique net id nor an EssGuid."), *PlayerState->GetFName().ToString());
+		return false;
+	}
+
+	FlushRestoreQueue();
+
+	const FString PlayerSlotName = GetPlayerSlotName(SlotName, PlayerId);
+
+	UEssSaveGame* SaveGame = GetSaveGame(PlayerSlotName, UserIndex, &ScopedTiming.Timing.FileBytes);
+	const FEssSaveData* SaveData = IsValid(SaveGame) ? SaveGame->SaveData.Find(PlayerSlotName) : nullptr;
+	if (!SaveData)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Player %s not loaded. SaveGame is not valid."), *PlayerId);
+		return false;
+	}
+
+	if (const FEssWorldData* WorldData = SaveData->WorldsData.Find(GetWorld()->GetFName().ToString()))
+	{
+		TArray<FEssPlayerShard> Shards;
+		Shards.AddDefaulted_GetRef().PlayerState = PlayerState;
+		GetPlayerActors(Shards);
+
+		// Records refer to the reference table of their level, so they are restored per level
+		TArray<FEssLevelRestore> Restores;
+		TMap<FString, int32> RestoreIndices;
+		TMap<FGuid, TPair<int32, const FEssRuntimeActorData*>> RuntimeRecords;
+		for (const auto& LevelPair : WorldData->LevelsData)
+		{
+			const int32 RestoreIndex = Restores.Num();
+			FEssLevelRestore& Restore = Restores.AddDefaulted_GetRef();
+			Restore.LevelData = &LevelPair.Value;
+			Restore.bNotifyRuntimeActorsInPlace = true;
+			RestoreIndices.Add(LevelPair.Key, RestoreIndex);
+
+			for (const FEssRuntimeActorData& ActorData : LevelPair.Value.RuntimeActorsData)
+				RuntimeRecords.Add(ActorData.Guid, TPair<int32, const FEssRuntimeActorData*>(RestoreIndex, &ActorData));
+		}
+
+		TSet<FSoftObjectPath> ClassPaths;
+		EssUtil::GetUnloadedClasses(*WorldData, ClassPaths);
+		PreloadClasses(ClassPaths);
+
+		// Respawnable actors of the player are replaced by the saved ones, all others are restored in place
+		for (AActor* Actor : Shards[0].Actors)
+		{
+			if (EssUtil::IsRuntimeActor(Actor))
+			{
+				if (EssUtil::IsActorRespawnable(Actor))
+				{
+					Actor->Destroy();
+					INC_DWORD_STAT(STAT_EssActorsDestroyed);
+				}
+				else if (const TPair<int32, const FEssRuntimeActorData*>* Record = RuntimeRecords.Find(EssUtil::GetGuid(Actor)))
+				{
+					Restores[Record->Key].RuntimeActorsInPlace.Emplace(Actor, Record->Value);
+				}
+			}
+			else
+			{
+				const int32* RestoreIndex = RestoreIndices.Find(EssUtil::GetLevelName(Actor->GetLevel()));
+				const FEssPlacedActorData* ActorData = RestoreIndex ? Restores[*RestoreIndex].LevelData->PlacedActorsData.Find(Actor->GetFName()) : nullptr;
+				if (ActorData)
+					Restores[*RestoreIndex].PlacedActors.Emplace(Actor, ActorData);
+			}
+		}
+
+		// Respawned actors are owned by the player again so the next save of the player picks them up
+		AActor* Owner = PlayerState->GetPlayerController();
+		if (!Owner)
+			Owner = PlayerState;
+
+		for (FEssLevelRestore& Restore : Restores)
+		{
+			ULevel* Level = FindLoadedLevel(Restore.LevelData->Name);
+			if (!Level)
+				continue;
+
+			for (const FEssRuntimeActorData& ActorData : Restore.LevelData->RuntimeActorsData)
+			{
+				UClass* Class = EssUtil::GetLoadedClass(ActorData.Class);
+				if (!Class || !EssUtil::IsActorRespawnable(Class))
+					continue;
+
+				if (AActor* SpawnedActor = SpawnActorForRecord(Class, ActorData.Transform, Level, Owner))
+				{
+					EssUtil::SetGuid(SpawnedActor, ActorData.Guid);
+					Restore.RuntimeActors.Emplace(SpawnedActor, &ActorData);
+				}
+			}
+		}
+
+		FEssReferenceResolver Resolver(GetWorld(), ActorRegistry);
+		for (const FEssLevelRestore& Restore : Restores)
+			Resolver.Resolve(Restore.LevelData->ObjectReferences);
+
+		for (const FEssLevelRestore& Restore : Restores)
+		{
+			FinishLevelRestore(Restore, Resolver);
+			ScopedTiming.Timing.ActorCount += Restore.RuntimeActorsInPlace.Num() + Restore.RuntimeActors.Num() + Restore.PlacedActors.Num();
+		}
+	}
+
+	const bool bAllLoaded = RestoreGlobalObjectsData(GlobalObjects, *SaveData, ScopedTiming.Timing.ActorCount);
+
+	UE_LOG(LogEss, Log, TEXT("Player %s loaded."), *PlayerId);
+	ScopedTiming.Timing.bSucceeded = bAllLoaded;
+	return bAllLoaded;
+}
+
+bool UEssSubsystem::DeletePlayerSave(const FString& PlayerId, const FString& SlotName, const int32 UserIndex)
+{
+	if (SlotName.IsEmpty() || PlayerId.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Player save not deleted. SlotName or PlayerId is empty."));
+		return false;
+	}
+
+	const FString PlayerSlotName = GetPlayerSlotName(SlotName, PlayerId);
+
+	WaitForRecordIndexWrites();
+	ResetRecordIndex(PlayerSlotName);
+	FEssRecordIndex::Delete(PlayerSlotName, UserIndex);
+
+	return FEssStorage::Get()->Delete(PlayerSlotName, UserIndex);
+}
+
+FString UEssSubsystem::GetPlayerId(const APlayerState* PlayerState)
+{
+	if (!IsValid(PlayerState))
+		return FString();
+
+	FString PlayerId;
+
+	const FUniqueNetIdRepl& UniqueId = PlayerState->GetUniqueId();
+	if (UniqueId.IsValid())
+	{
+		PlayerId = UniqueId.ToString();
+	}
+	else if (EssUtil::GetGuidProperty(PlayerState))
+	{
+		const FGuid Guid = EssUtil::GetGuid(PlayerState);
+		if (Guid.IsValid())
+			PlayerId = Guid.ToString();
+	}
+
+	// Net ids of some online subsystems contain characters which aren't allowed in file names
+	return FPaths::MakeValidFileName(PlayerId, TEXT('_'));
+}
+
+FString UEssSubsystem::GetPlayerSlotName(const FString& SlotName, const FString& PlayerId)
+{
+	return SlotName + TEXT("_Player_") + PlayerId;
+}
+
+int32 UEssSubsystem::GetNumSavableActors() const
+{
+	return ActorRegistry.GetNumActors();
+}
+
+int32 UEssSubsystem::GetNumSavableActors(const ULevel* Level) const
+{
+	return ActorRegistry.GetNumActors(Level);
+}
+
+bool UEssSubsystem::LoadActorByGuid(const FGuid& Guid, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("LoadActorByGuid"), SlotName);
+
+	if (SlotName.IsEmpty() || !Guid.IsValid())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Actor not loaded. SlotName is empty or GUID is not valid."));
+		return false;
+	}
+
+	FlushRestoreQueue();
+
+	FEssRuntimeActorData ActorData;
+	FString LevelName;
+	TArray<FEssObjectReference> References;
+	if (!FindRuntimeActorRecord(SlotName, UserIndex, Guid, ActorData, LevelName, References))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Actor %s not loaded. No record found."), *Guid.ToString());
+		return false;
+	}
+
+	ULevel* Level = FindLoadedLevel(LevelName);
+	if (!Level)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Actor %s not loaded. Level %s is not loaded."), *Guid.ToString(), *LevelName);
+		return false;
+	}
+
+	TArray<AActor*> SavableActors;
+	GetSavableActors(Level, SavableActors);
+
+	FEssReferenceResolver Resolver(GetWorld(), ActorRegistry);
+
+	for (AActor* Actor : SavableActors)
+	{
+		if (IsValid(Actor) && EssUtil::IsRuntimeActor(Actor) && EssUtil::GetGuid(Actor) == Guid)
+		{
+			RestoreRuntimeActorData(ActorData, Actor, Resolver, References);
+			Cast<IEssSavableInterface>(Actor)->Execute_PostLoadGame(Actor);
+			ScopedTiming.Timing.ActorCount = 1;
+			ScopedTiming.Timing.bSucceeded = true;
+			return true;
+		}
+	}
+
+	UClass* Class = EssUtil::GetLoadedClass(ActorData.Class);
+	if (!Class || !EssUtil::IsActorRespawnable(Class))
+		return false;
+
+	RespawnRuntimeActor(ActorData, Level, Resolver, References);
+	ScopedTiming.Timing.ActorCount = 1;
+	ScopedTiming.Timing.bSucceeded = true;
+	return true;
+}
+
+bool UEssSubsystem::LoadPlacedActor(const FString& LevelName, const FName ActorName, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("LoadPlacedActor"), SlotName);
+
+	if (SlotName.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Placed actor %s not loaded. SlotName is empty."), *ActorName.ToString());
+		return false;
+	}
+
+	FlushRestoreQueue();
+
+	ULevel* Level = FindLoadedLevel(LevelName);
+	if (!Level)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Placed actor %s not loaded. Level %s is not loaded."), *ActorName.ToString(), *LevelName);
+		return false;
+	}
+
+	FEssReferenceResolver Resolver(GetWorld(), ActorRegistry);
+	AActor* Actor = FindObjectFast<AActor>(Level, ActorName);
+
+	FEssPlacedActorData ActorData;
+	TArray<FEssObjectReference> References;
+	if (FindPlacedActorRecord(SlotName, UserIndex, LevelName, ActorName, ActorData, References))
+	{
+		if (IsValid(Actor))
+		{
+			RestorePlacedActorData(ActorData, Actor, Resolver, References);
+			Cast<IEssSavableInterface>(Actor)->Execute_PostLoadGame(Actor);
+		}
+		else
+		{
+			RespawnPlacedActor(ActorData, Level, Resolver, References);
+		}
+	}
+	else
+	{
+		// Levels saved with elision have no records for placed actors which were unchanged or destroyed
+		FEssLevelData LevelHeader;
+		if (!FindLevelHeader(SlotName, UserIndex, LevelName, LevelHeader) || !LevelHeader.bDefaultPlacedActorsElided)
+		{
+			UE_LOG(LogEss, Warning, TEXT("Placed actor %s not loaded. No record found."), *ActorName.ToString());
+			return false;
+		}
+
+		if (LevelHeader.DestroyedPlacedActors.Contains(ActorName))
+		{
+			if (IsValid(Actor))
+			{
+				UE_LOG(LogEss, Verbose, TEXT("Placed actor %s being destroyed."), *ActorName.ToString());
+				Actor->Destroy();
+				INC_DWORD_STAT(STAT_EssActorsDestroyed);
+			}
+		}
+		else
+		{
+			const FEssPlacedActorData* Baseline = FindPlacedActorBaseline(Level, ActorName);
+			if (!Baseline)
+			{
+				UE_LOG(LogEss, Warning, TEXT("Placed actor %s not loaded. No record found and no baseline captured."), *ActorName.ToString());
+				return false;
+			}
+
+			if (!IsValid(Actor))
+				RespawnPlacedActor(*Baseline, Level, Resolver, ActorRegistry.GetPlacedActorBaselineReferences(Level)->GetReferences());
+			else if (!ActorRegistry.MatchesPlacedActorBaselines(Level))
+				ResetPlacedActor(*Baseline, Actor, Resolver);
+		}
+	}
+
+	ScopedTiming.Timing.ActorCount = 1;
+	ScopedTiming.Timing.bSucceeded = true;
+	return true;
+}
+
+bool UEssSubsystem::LoadLevel(const FString& LevelName, const FString& SlotName, const int32 UserIndex)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+	FEssScopedTiming ScopedTiming(TEXT("LoadLevel"), SlotName);
+
+	if (SlotName.IsEmpty())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Level %s not loaded. SlotName is empty."), *LevelName);
+		return false;
+	}
+
+	ULevel* Level = FindLoadedLevel(LevelName);
+	if (!Level)
+	{
+		UE_LOG(LogEss, Warning, TEXT("Level %s not loaded. Level is not loaded in the world."), *LevelName);
+		return false;
+	}
+
+	FEssLevelData LevelData;
+	if (!FindLevelRecord(SlotName, UserIndex, LevelName, LevelData))
+	{
+		UE_LOG(LogEss, Warning, TEXT("Level %s not loaded. No record found."), *LevelName);
+		return false;
+	}
+
+	TSet<FSoftObjectPath> ClassPaths;
+	EssUtil::GetUnloadedClasses(LevelData, ClassPaths);
+	PreloadClasses(ClassPaths);
+
+	RestoreLevelData(Level, &LevelData);
+
+	ScopedTiming.Timing.ActorCount = LevelData.RuntimeActorsData.Num() + LevelData.PlacedActorsData.Num();
+	ScopedTiming.Timing.bSucceeded = true;
+	return true;
+}
+
+bool UEssSubsystem::PeekRecord(const EEssRecordKind Kind, const FString& LevelName, const FString& Key, const FString& SlotName, FEssRecordInfo& OutInfo, const int32 UserIndex)
+{
+	OutInfo = FEssRecordInfo();
+	OutInfo.Kind = Kind;
+	OutInfo.LevelName = LevelName;
+	OutInfo.Key = Key;
+
+	const FString WorldName = GetWorld()->GetFName().ToString();
+
+	if (TSharedPtr<FEssRecordIndex> RecordIndex = GetRecordIndex(SlotName, UserIndex))
+	{
+		const FEssRecordIndexEntry* Entry = RecordIndex->Find(Kind, WorldName, LevelName, Key);
+		if (!Entry)
+			return Kind == EEssRecordKind::PlacedActor && PeekElidedPlacedActor(LevelName, FName(*Key), SlotName, UserIndex, OutInfo);
+
+		OutInfo.LevelName = Entry->Level;
+		OutInfo.Class = TSoftClassPtr<UObject>(FSoftObjectPath(Entry->ClassPath));
+		OutInfo.ByteSize = Entry->Size;
+
+		// Decode the record for its transform without loading its class
+		if (Kind == EEssRecordKind::RuntimeActor)
+		{
+			FEssRuntimeActorData ActorData;
+			if (RecordIndex->ReadRecord(*Entry, ActorData, false))
+				OutInfo.Transform = ActorData.Transform;
+		}
+		else if (Kind == EEssRecordKind::PlacedActor)
+		{
+			FEssPlacedActorData ActorData;
+			if (RecordIndex->ReadRecord(*Entry, ActorData, false))
+				OutInfo.Transform = ActorData.Transform;
+		}
+
+		return true;
+	}
+
+	UEssSaveGame* SaveGame = GetSaveGame(SlotName, UserIndex);
+	const FEssWorldData* WorldData = FindWorldData(SaveGame, SlotName);
+
+	switch (Kind)
+	{
+	case EEssRecordKind::RuntimeActor:
+	{
+		FGuid Guid;
+		if (!WorldData || !FGuid::Parse(Key, Guid))
+			return false;
+
+		for (const auto& LevelPair : WorldData->LevelsData)
+		{
+			for (const FEssRuntimeActorData& ActorData : LevelPair.Value.RuntimeActorsData)
+			{
+				if (ActorData.Guid == Guid)
+				{
+					OutInfo.LevelName = LevelPair.Key;
+					OutInfo.Class = TSoftClassPtr<UObject>(ActorData.Class.ToSoftObjectPath());
+					OutInfo.Transform = ActorData.Transform;
+					OutInfo.ByteSize = ActorData.GetNumBytes();
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+	case EEssRecordKind::PlacedActor:
+	{
+		const FEssLevelData* LevelData = WorldData ? WorldData->LevelsData.Find(LevelName) : nullptr;
+		const FEssPlacedActorData* ActorData = LevelData ? LevelData->PlacedActorsData.Find(FName(*Key)) : nullptr;
+		if (!ActorData)
+			return PeekElidedPlacedActor(LevelName, FName(*Key), SlotName, UserIndex, OutInfo);
+
+		OutInfo.Class = TSoftClassPtr<UObject>(ActorData->Class.ToSoftObjectPath());
+		OutInfo.Transform = ActorData->Transform;
+		OutInfo.ByteSize = ActorData->GetNumBytes();
+		return true;
+	}
+	case EEssRecordKind::GlobalObject:
+	{
+		FGuid Guid;
+		const FEssSaveData* SaveData = IsValid(SaveGame) ? SaveGame->SaveData.Find(SlotName) : nullptr;
+		if (!SaveData || !FGuid::Parse(Key, Guid))
+			return false;
+
+		for (const FEssGlobalObjectData& ObjectData : SaveData->GlobalObjectData)
+		{
+			if (ObjectData.Guid == Guid)
+			{
+				OutInfo.Class = ObjectData.Class.Get();
+				OutInfo.ByteSize = ObjectData.ByteData.Num();
+				return true;
+			}
+		}
+
+		return false;
+	}
+	case EEssRecordKind::Level:
+	default:
+		return WorldData && WorldData->LevelsData.Contains(LevelName);
+	}
+}
+
+FEssWorldData UEssSubsystem::GetWorldData(int32& OutActorCount)
+{
+	UWorld* World = GetWorld();
+
+	FEssWorldData WorldData;
+	WorldData.Name = World->GetFName().ToString();
+
+	for (auto Level : World->GetLevels())
+	{
+		FEssLevelData LevelData = GetLevelData(Level);
+		OutActorCount += LevelData.RuntimeActorsData.Num() + LevelData.PlacedActorsData.Num();
+		WorldData.LevelsData.Add(LevelData.Name, LevelData);
+	}
+
+	WorldData.bMassEntitiesSaved = FEssMass::Extract(World, WorldData.MassArchetypesData) != INDEX_NONE;
+
+	return WorldData;
+}
+
+int32 UEssSubsystem::RestoreWorldData(const FEssWorldData& WorldData)
+{
+	int32 ActorCount = 0;
+
+	// The actors of all levels are spawned first, so references across levels resolve as well
+	TArray<FEssLevelRestore> Restores;
+
+	for (auto Level : GetWorld()->GetLevels())
+	{
+		const FEssLevelData* LevelData = WorldData.LevelsData.Find(EssUtil::GetLevelName(Level));
+		if (LevelData)
+		{
+			PrepareLevelRestore(Level, LevelData, Restores.AddDefaulted_GetRef());
+			ActorCount += LevelData->RuntimeActorsData.Num() + LevelData->PlacedActorsData.Num();
+		}
+	}
+
+	FEssMass::Restore(GetWorld(), WorldData);
+
+	FEssReferenceResolver Resolver(GetWorld(), ActorRegistry);
+	for (const FEssLevelRestore& Restore : Restores)
+		Resolver.Resolve(Restore.LevelData->ObjectReferences);
+
+	for (const FEssLevelRestore& Restore : Restores)
+		FinishLevelRestore(Restore, Resolver);
+
+	return ActorCount;
+}
+
+FEssLevelData UEssSubsystem::GetLevelData(const TObjectPtr<ULevel> Level, const TArray<AActor*>* Actors, const TArray<FEssObjectReference>* ObjectReferences)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssGetLevelData);
+
+	// Actors still waiting in the restore queue would be saved with their spawned defaults
+	FlushRestoreQueue();
+
+	// TODO: Get current data for this level for backup in case save fails
+
+	FEssLevelData LevelData;
+	LevelData.Name = EssUtil::GetLevelName(Level);
+
+	TArray<AActor*> SavableActors;
+	if (Actors)
+		SavableActors = *Actors;
+	else
+		GetSavableActors(Level, SavableActors);
+
+	// A subset of a level's actors can't tell which placed actors have been destroyed
+	const TMap<FName, FEssPlacedActorData>* Baselines = nullptr;
+	if (!Actors && GetDefault<UEssSettings>()->bElideDefaultPlacedActors)
+		Baselines = ActorRegistry.GetPlacedActorBaselines(Level);
+
+	LevelData.bDefaultPlacedActorsElided = Baselines != nullptr;
+	TSet<FName> ExistingPlacedActors;
+
+	// Placed actors which still match their baselines refer to the same indices as them, so their records compare equal
+	FEssReferenceTable References;
+	if (ObjectReferences)
+		References = FEssReferenceTable(*ObjectReferences);
+	else if (Baselines)
+		References = *ActorRegistry.GetPlacedActorBaselineReferences(Level);
+
+	// References to runtime actors are written as their GUID, which has to be set before any record refers to the actor
+	for (AActor* Actor : SavableActors)
+	{
+		if (IsValid(Actor) && EssUtil::IsRuntimeActor(Actor) && EssUtil::IsActorRespawnable(Actor) && EssUtil::GetGuidProperty(Actor) &&
+			!EssUtil::GetGuid(Actor).IsValid())
+		{
+			EssUtil::SetGuid(Actor, FGuid::NewGuid());
+		}
+	}
+
+	for (auto Actor : SavableActors)
+	{
+		if (!IsValid(Actor) || !Actor->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
+			continue;
+
+		// Player-owned actors are saved to their player's shard
+		if (!Actors && IsExcludedPlayerActor(Actor))
+		{
+			ExistingPlacedActors.Add(Actor->GetFName());
+			continue;
+		}
+
+		if (EssUtil::IsRuntimeActor(Actor))
+		{
+			if (EssUtil::IsActorRespawnable(Actor))
+			{
+				Cast<IEssSavableInterface>(Actor)->Execute_PreSaveGame(Actor);
+				FEssRuntimeActorData ActorData = ExtractRuntimeActorData(Actor, References);
+				if (ActorData)
+				{
+					LevelData.RuntimeActorsData.Add(ActorData);
+					Cast<IEssSavableInterface>(Actor)->Execute_PostSaveGame(Actor);
+				}
+			}
+			else
+			{
+				FGuid Guid = EssUtil::GetGuid(Actor);
+				if (Guid.IsValid())
+				{
+					Cast<IEssSavableInterface>(Actor)->Execute_PreSaveGame(Actor);
+					FEssRuntimeActorData ActorData = ExtractRuntimeActorData(Actor, References);
+					if (ActorData)
+					{
+						LevelData.RuntimeActorsData.Add(ActorData);
+						Cast<IEssSavableInterface>(Actor)->Execute_PostSaveGame(Actor);
+					}
+				}
+			}
+		}
+		else
+		{
+			Cast<IEssSavableInterface>(Actor)->Execute_PreSaveGame(Actor);
+			FEssPlacedActorData ActorData = ExtractPlacedActorData(Actor, References);
+			if (ActorData)
+			{
+				// Placed actors still in their level-authored state are recreated by loading the level
+				const FEssPlacedActorData* Baseline = Baselines ? Baselines->Find(ActorData.Name) : nullptr;
+				if (!Baseline || !Baseline->HasSameState(ActorData))
+					LevelData.PlacedActorsData.Add(ActorData.Name, ActorData);
+
+				ExistingPlacedActors.Add(ActorData.Name);
+				Cast<IEssSavableInterface>(Actor)->Execute_PostSaveGame(Actor);
+			}
+		}
+	}
+
+	if (Baselines)
+	{
+		for (const auto& BaselinePair : *Baselines)
+		{
+			if (!ExistingPlacedActors.Contains(BaselinePair.Key))
+				LevelData.DestroyedPlacedActors.Add(BaselinePair.Key);
+		}
+	}
+
+	LevelData.ObjectReferences = References.GetReferences();
+
+	// Entries of the baselines which no record refers to aren't needed to load the level
+	if (Baselines)
+		EssUtil::PruneObjectReferences(LevelData);
+
+	// A subset of a level's actors doesn't own the level's instances
+	if (!Actors)
+		GetInstancesData(Level, LevelData);
+
+	INC_DWORD_STAT_BY(STAT_EssActorsCaptured, LevelData.RuntimeActorsData.Num() + LevelData.PlacedActorsData.Num());
+
+	return LevelData;
+}
+
+int32 UEssSubsystem::SaveLevelRegion(const TObjectPtr<ULevel> Level, const FBox& Bounds, FEssLevelData& OutLevelData)
+{
+	TArray<AActor*> SavableActors;
+	GetSavableActors(Level, SavableActors);
+
+	// Actors outside of the region keep their records, even if those lie within it
+	TArray<AActor*> RegionActors;
+	TSet<FGuid> OutsideRuntimeActors;
+	TSet<FName> OutsidePlacedActors;
+	TSet<FName> ExistingPlacedActors;
+
+	for (AActor* Actor : SavableActors)
+	{
+		if (!IsValid(Actor))
+			continue;
+
+		const bool bRuntimeActor = EssUtil::IsRuntimeActor(Actor);
+		if (!bRuntimeActor)
+			ExistingPlacedActors.Add(Actor->GetFName());
+
+		if (!IsExcludedPlayerActor(Actor) && Bounds.IsInsideOrOn(Actor->GetActorLocation()))
+			RegionActors.Add(Actor);
+		else if (bRuntimeActor)
+			OutsideRuntimeActors.Add(EssUtil::GetGuid(Actor));
+		else
+			OutsidePlacedActors.Add(Actor->GetFName());
+	}
+
+	// The region's records continue the level's reference table, so the records kept from before still refer to the right entries
+	FEssLevelData RegionData = GetLevelData(Level, &RegionActors, &OutLevelData.ObjectReferences);
+	const int32 ActorCount = RegionData.RuntimeActorsData.Num() + RegionData.PlacedActorsData.Num();
+
+	TArray<int32> RuntimeActors;
+	TArray<FName> PlacedActors;
+	FEssSpatialGrid::FindRecords(OutLevelData, Bounds, RuntimeActors, PlacedActors);
+
+	TSet<FGuid> CapturedRuntimeActors;
+	for (const FEssRuntimeActorData& ActorData : RegionData.RuntimeActorsData)
+		CapturedRuntimeActors.Add(ActorData.Guid);
+
+	TBitArray<> RemovedRuntimeActors(false, OutLevelData.RuntimeActorsData.Num());
+	int32 NumReplaced = 0;
+	for (const int32 Index : RuntimeActors)
+	{
+		const FGuid& Guid = OutLevelData.RuntimeActorsData[Index].Guid;
+		if (CapturedRuntimeActors.Contains(Guid))
+		{
+			RemovedRuntimeActors[Index] = true;
+			++NumReplaced;
+		}
+		else if (!OutsideRuntimeActors.Contains(Guid))
+		{
+			RemovedRuntimeActors[Index] = true;
+		}
+	}
+
+	// Actors which have entered the region since the last save still have their records elsewhere in the level
+	if (NumReplaced < CapturedRuntimeActors.Num())
+	{
+		for (int32 Index = 0; Index < OutLevelData.RuntimeActorsData.Num(); ++Index)
+		{
+			if (CapturedRuntimeActors.Contains(OutLevelData.RuntimeActorsData[Index].Guid))
+				RemovedRuntimeActors[Index] = true;
+		}
+	}
+
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < OutLevelData.RuntimeActorsData.Num(); ++Index)
+	{
+		if (RemovedRuntimeActors[Index])
+			continue;
+
+		if (Index != NumKept)
+			OutLevelData.RuntimeActorsData[NumKept] = MoveTemp(OutLevelData.RuntimeActorsData[Index]);
+
+		++NumKept;
+	}
+
+	OutLevelData.RuntimeActorsData.SetNum(NumKept);
+	OutLevelData.RuntimeActorsData.Append(MoveTemp(RegionData.RuntimeActorsData));
+
+	// Without elision a placed actor without a record is destroyed on load, with elision it has to be listed as destroyed
+	for (const FName& Name : PlacedActors)
+	{
+		if (OutsidePlacedActors.Contains(Name))
+			continue;
+
+		OutLevelData.PlacedActorsData.Remove(Name);
+		if (OutLevelData.bDefaultPlacedActorsElided && !ExistingPlacedActors.Contains(Name))
+			OutLevelData.DestroyedPlacedActors.AddUnique(Name);
+	}
+
+	const TMap<FName, FEssPlacedActorData>* Baselines = OutLevelData.bDefaultPlacedActorsElided ? ActorRegistry.GetPlacedActorBaselines(Level) : nullptr;
+	const FEssReferenceTable* BaselineReferences = Baselines ? ActorRegistry.GetPlacedActorBaselineReferences(Level) : nullptr;
+
+	// Equal bytes only mean equal state if every index refers to the same object in the level's table as in the baselines' table
+	auto RefersToBaselineReferences = [&RegionData, BaselineReferences](const FEssPlacedActorData& ActorData)
+	{
+		for (const int32 Index : ActorData.ReferenceIndices)
+		{
+			if (!RegionData.ObjectReferences.IsValidIndex(Index) || !BaselineReferences->GetReferences().IsValidIndex(Index) ||
+				RegionData.ObjectReferences[Index] != BaselineReferences->GetReferences()[Index])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	for (auto& PlacedPair : RegionData.PlacedActorsData)
+	{
+		OutLevelData.DestroyedPlacedActors.Remove(PlacedPair.Key);
+
+		const FEssPlacedActorData* Baseline = Baselines ? Baselines->Find(PlacedPair.Key) : nullptr;
+		if (Baseline && Baseline->HasSameState(PlacedPair.Value) && RefersToBaselineReferences(PlacedPair.Value))
+			OutLevelData.PlacedActorsData.Remove(PlacedPair.Key);
+		else
+			OutLevelData.PlacedActorsData.Add(PlacedPair.Key, MoveTemp(PlacedPair.Value));
+	}
+
+	if (Baselines)
+	{
+		for (const auto& BaselinePair : *Baselines)
+		{
+			if (!ExistingPlacedActors.Contains(BaselinePair.Key) && Bounds.IsInsideOrOn(BaselinePair.Value.Transform.GetLocation()))
+				OutLevelData.DestroyedPlacedActors.AddUnique(BaselinePair.Key);
+		}
+	}
+
+	OutLevelData.ObjectReferences = MoveTemp(RegionData.ObjectReferences);
+
+	// Entries of replaced and removed records would otherwise pile up with every region saved into the slot
+	EssUtil::PruneObjectReferences(OutLevelData);
+
+	// Records have been removed and appended, which invalidates the indices of the grid
+	FEssSpatialGrid::Build(OutLevelData, GetDefault<UEssSettings>()->RegionCellSize);
+
+	return ActorCount;
+}
+
+void UEssSubsystem::RestoreLevelData(TObjectPtr<ULevel> Level, const FEssLevelData* LevelData)
+{
+	FEssLevelRestore Restore;
+	PrepareLevelRestore(Level, LevelData, Restore);
+
+	FEssReferenceResolver Resolver(GetWorld(), ActorRegistry);
+	Resolver.Resolve(LevelData->ObjectReferences);
+
+	FinishLevelRestore(Restore, Resolver);
+}
+
+void UEssSubsystem::PrepareLevelRestore(TObjectPtr<ULevel> Level, const FEssLevelData* LevelData, FEssLevelRestore& OutRestore)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreLevelData);
+
+	// The queued actors would otherwise be restored from the previous load after this one
+	FlushRestoreQueue();
+
+	OutRestore.LevelData = LevelData;
+
+	TArray<AActor*> SavableActors;
+	GetSavableActors(Level, SavableActors);
+
+	RestoreInstancesData(Level, *LevelData);
+
+	// Placed actors without a record are in their level-authored state unless listed as destroyed
+	const TMap<FName, FEssPlacedActorData>* Baselines = nullptr;
+	TSet<FName> DestroyedPlacedActors;
+	TSet<FName> ExistingPlacedActors;
+	if (LevelData->bDefaultPlacedActorsElided)
+	{
+		Baselines = ActorRegistry.GetPlacedActorBaselines(Level);
+		DestroyedPlacedActors.Append(LevelData->DestroyedPlacedActors);
+	}
+
+	// Comparing placed actors against their baselines is skipped if they can't have changed since the baselines were captured
+	const bool bResetPlacedActors = Baselines && !ActorRegistry.MatchesPlacedActorBaselines(Level);
+
+	for (auto Actor : SavableActors)
+	{
+		if (!IsValid(Actor) || !Actor->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
+			continue;
+
+		if (IsExcludedPlayerActor(Actor))
+		{
+			ExistingPlacedActors.Add(Actor->GetFName());
+			continue;
+		}
+
+		if (EssUtil::IsRuntimeActor(Actor))
+		{
+			if (EssUtil::IsActorRespawnable(Actor))
+			{
+				UE_LOG(LogEss, Verbose, TEXT("Runtime actor %s being destroyed."), *Actor->GetFName().ToString());
+				Actor->Destroy();
+				INC_DWORD_STAT(STAT_EssActorsDestroyed);
+			}
+			else
+			{
+				FGuid Guid = EssUtil::GetGuid(Actor);
+				if (Guid.IsValid())
+				{
+					for (const auto& ActorData : LevelData->RuntimeActorsData)
+					{
+						if (Guid == ActorData.Guid)
+							OutRestore.RuntimeActorsInPlace.Emplace(Actor, &ActorData);
+					}
+				}
+			}
+		}
+		else
+		{
+			const FEssPlacedActorData* ActorData = LevelData->PlacedActorsData.Find(Actor->GetFName());
+			if (ActorData)
+				OutRestore.PlacedActors.Emplace(Actor, ActorData);
+			else if (!LevelData->bDefaultPlacedActorsElided || DestroyedPlacedActors.Contains(Actor->GetFName()))
+				OutRestore.ActorsToDestroy.Add(Actor);
+			else if (const FEssPlacedActorData* Baseline = bResetPlacedActors ? Baselines->Find(Actor->GetFName()) : nullptr)
+				OutRestore.ResetActors.Emplace(Actor, Baseline);
+
+			ExistingPlacedActors.Add(Actor->GetFName());
+		}
+	}
+
+	// Respawn placed actors which were destroyed after the save but still in their level-authored state when saving
+	if (Baselines)
+	{
+		for (const auto& BaselinePair : *Baselines)
+		{
+			if (!ExistingPlacedActors.Contains(BaselinePair.Key) && !DestroyedPlacedActors.Contains(BaselinePair.Key) &&
+				!LevelData->PlacedActorsData.Contains(BaselinePair.Key))
+			{
+				if (AActor* SpawnedActor = SpawnActorForRecord(EssUtil::GetLoadedClass(BaselinePair.Value.Class), BaselinePair.Value.Transform, Level))
+					OutRestore.PlacedActors.Emplace(SpawnedActor, &BaselinePair.Value);
+			}
+		}
+	}
+
+	// Respawn runtime actors with save data. Their GUID is set right away so references to them can be resolved.
+	for (auto& ActorData : LevelData->RuntimeActorsData)
+	{
+		UClass* Class = EssUtil::GetLoadedClass(ActorData.Class);
+		if (!Class || !EssUtil::IsActorRespawnable(Class))
+			continue;
+
+		if (AActor* SpawnedActor = SpawnActorForRecord(Class, ActorData.Transform, Level))
+		{
+			EssUtil::SetGuid(SpawnedActor, ActorData.Guid);
+			OutRestore.RuntimeActors.Emplace(SpawnedActor, &ActorData);
+		}
+	}
+
+	// Respawn placed actors with save data
+	for (auto& PlacedPair : LevelData->PlacedActorsData)
+	{
+		if (ExistingPlacedActors.Contains(PlacedPair.Key))
+			continue;
+
+		if (AActor* SpawnedActor = SpawnActorForRecord(EssUtil::GetLoadedClass(PlacedPair.Value.Class), PlacedPair.Value.Transform, Level))
+			OutRestore.PlacedActors.Emplace(SpawnedActor, &PlacedPair.Value);
+	}
+}
+
+void UEssSubsystem::PrepareRegionRestore(const FEssRegionRecords& Region, const FBox& Bounds, FEssLevelRestore& OutRestore)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreLevelData);
+
+	const FEssLevelData& LevelData = *Region.LevelData;
+	OutRestore.LevelData = Region.LevelData;
+
+	TMap<FGuid, const FEssRuntimeActorData*> RuntimeRecords;
+	for (const int32 Index : Region.RuntimeActors)
+		RuntimeRecords.Add(LevelData.RuntimeActorsData[Index].Guid, &LevelData.RuntimeActorsData[Index]);
+
+	// GUIDs of all runtime records of the level, only gathered if an actor of the region has no record within it
+	TSet<FGuid> SavedRuntimeActors;
+	bool bSavedRuntimeActorsGathered = false;
+
+	TArray<AActor*> SavableActors;
+	GetSavableActors(Region.Level, SavableActors);
+
+	const TMap<FName, FEssPlacedActorData>* Baselines = nullptr;
+	TSet<FName> DestroyedPlacedActors;
+	TSet<FName> ExistingPlacedActors;
+	if (LevelData.bDefaultPlacedActorsElided)
+	{
+		Baselines = ActorRegistry.GetPlacedActorBaselines(Region.Level);
+		DestroyedPlacedActors.Append(LevelData.DestroyedPlacedActors);
+	}
+
+	const bool bResetPlacedActors = Baselines && !ActorRegistry.MatchesPlacedActorBaselines(Region.Level);
+
+	for (auto Actor : SavableActors)
+	{
+		if (!IsValid(Actor) || !Actor->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
+			continue;
+
+		if (!EssUtil::IsRuntimeActor(Actor))
+			ExistingPlacedActors.Add(Actor->GetFName());
+
+		if (IsExcludedPlayerActor(Actor))
+			continue;
+
+		const bool bInRegion = Bounds.IsInsideOrOn(Actor->GetActorLocation());
+
+		if (EssUtil::IsRuntimeActor(Actor))
+		{
+			const FEssRuntimeActorData* const* ActorData = RuntimeRecords.Find(EssUtil::GetGuid(Actor));
+			if (!ActorData && !bInRegion)
+				continue;
+
+			if (EssUtil::IsActorRespawnable(Actor))
+			{
+				// Actors which have entered the region since the save are restored with the region their record lies in
+				if (!ActorData)
+				{
+					if (!bSavedRuntimeActorsGathered)
+					{
+						for (const FEssRuntimeActorData& SavedActorData : LevelData.RuntimeActorsData)
+							SavedRuntimeActors.Add(SavedActorData.Guid);
+
+						bSavedRuntimeActorsGathered = true;
+					}
+
+					if (SavedRuntimeActors.Contains(EssUtil::GetGuid(Actor)))
+						continue;
+				}
+
+				UE_LOG(LogEss, Verbose, TEXT("Runtime actor %s being destroyed."), *Actor->GetFName().ToString());
+				Actor->Destroy();
+				INC_DWORD_STAT(STAT_EssActorsDestroyed);
+			}
+			else if (ActorData)
+			{
+				OutRestore.RuntimeActorsInPlace.Emplace(Actor, *ActorData);
+			}
+		}
+		else
+		{
+			const FEssPlacedActorData* ActorData = LevelData.PlacedActorsData.Find(Actor->GetFName());
+			if (!bInRegion && !(ActorData && Bounds.IsInsideOrOn(ActorData->Transform.GetLocation())))
+				continue;
+
+			if (ActorData)
+				OutRestore.PlacedActors.Emplace(Actor, ActorData);
+			else if (!LevelData.bDefaultPlacedActorsElided || DestroyedPlacedActors.Contains(Actor->GetFName()))
+				OutRestore.ActorsToDestroy.Add(Actor);
+			else if (const FEssPlacedActorData* Baseline = bResetPlacedActors ? Baselines->Find(Actor->GetFName()) : nullptr)
+				OutRestore.ResetActors.Emplace(Actor, Baseline);
+		}
+	}
+
+	// Respawn placed actors of the region which were destroyed after the save but still in their level-authored state when saving
+	if (Baselines)
+	{
+		for (const auto& BaselinePair : *Baselines)
+		{
+			if (!ExistingPlacedActors.Contains(BaselinePair.Key) && !DestroyedPlacedActors.Contains(BaselinePair.Key) &&
+				!LevelData.PlacedActorsData.Contains(BaselinePair.Key) && Bounds.IsInsideOrOn(BaselinePair.Value.Transform.GetLocation()))
+			{
+				if (AActor* SpawnedActor = SpawnActorForRecord(EssUtil::GetLoadedClass(BaselinePair.Value.Class), BaselinePair.Value.Transform, Region.Level))
+					OutRestore.PlacedActors.Emplace(SpawnedActor, &BaselinePair.Value);
+			}
+		}
+	}
+
+	for (const int32 Index : Region.RuntimeActors)
+	{
+		const FEssRuntimeActorData& ActorData = LevelData.RuntimeActorsData[Index];
+		UClass* Class = EssUtil::GetLoadedClass(ActorData.Class);
+		if (!Class || !EssUtil::IsActorRespawnable(Class))
+			continue;
+
+		if (AActor* SpawnedActor = SpawnActorForRecord(Class, ActorData.Transform, Region.Level))
+		{
+			EssUtil::SetGuid(SpawnedActor, ActorData.Guid);
+			OutRestore.RuntimeActors.Emplace(SpawnedActor, &ActorData);
+		}
+	}
+
+	for (const FName& Name : Region.PlacedActors)
+	{
+		if (ExistingPlacedActors.Contains(Name))
+			continue;
+
+		const FEssPlacedActorData& ActorData = LevelData.PlacedActorsData[Name];
+		if (AActor* SpawnedActor = SpawnActorForRecord(EssUtil::GetLoadedClass(ActorData.Class), ActorData.Transform, Region.Level))
+			OutRestore.PlacedActors.Emplace(SpawnedActor, &ActorData);
+	}
+}
+
+void UEssSubsystem::FinishLevelRestore(const FEssLevelRestore& Restore, FEssReferenceResolver& Resolver)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreLevelData);
+
+	TArray<FEssRestoreItem> Items;
+	GetRestoreItems(Restore, Items);
+
+	for (const FEssRestoreItem& Item : Items)
+		RestoreItem(Item, Resolver);
+
+	DestroyPlacedActors(Restore);
+}
+
+void UEssSubsystem::GetRestoreItems(const FEssLevelRestore& Restore, TArray<FEssRestoreItem>& OutItems)
+{
+	OutItems.Reserve(OutItems.Num() + Restore.RuntimeActorsInPlace.Num() + Restore.RuntimeActors.Num() + Restore.PlacedActors.Num() + Restore.ResetActors.Num());
+
+	const TArray<FEssObjectReference>* References = &Restore.LevelData->ObjectReferences;
+
+	for (const auto& ActorPair : Restore.RuntimeActorsInPlace)
+	{
+		FEssRestoreItem& Item = OutItems.AddDefaulted_GetRef();
+		Item.Actor = ActorPair.Key;
+		Item.RuntimeActorData = ActorPair.Value;
+		Item.References = References;
+		Item.bNotify = Restore.bNotifyRuntimeActorsInPlace;
+	}
+
+	for (const auto& ActorPair : Restore.RuntimeActors)
+	{
+		FEssRestoreItem& Item = OutItems.AddDefaulted_GetRef();
+		Item.Actor = ActorPair.Key;
+		Item.RuntimeActorData = ActorPair.Value;
+		Item.References = References;
+	}
+
+	for (const auto& ActorPair : Restore.PlacedActors)
+	{
+		FEssRestoreItem& Item = OutItems.AddDefaulted_GetRef();
+		Item.Actor = ActorPair.Key;
+		Item.PlacedActorData = ActorPair.Value;
+		Item.References = References;
+	}
+
+	for (const auto& ActorPair : Restore.ResetActors)
+	{
+		FEssRestoreItem& Item = OutItems.AddDefaulted_GetRef();
+		Item.Actor = ActorPair.Key;
+		Item.PlacedActorData = ActorPair.Value;
+		Item.bReset = true;
+		Item.bNotify = false;
+	}
+}
+
+int32 UEssSubsystem::SortRestoreItems(TArray<FEssRestoreItem>& Items) const
+{
+	TArray<FVector> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!IsValid(PlayerController))
+			continue;
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		ViewLocations.Add(ViewLocation);
+	}
+
+	for (FEssRestoreItem& Item : Items)
+	{
+		AActor* Actor = Item.Actor.Get();
+		if (!IsValid(Actor))
+			continue;
+
+		Item.Priority = Cast<IEssSavableInterface>(Actor)->Execute_GetRestorePriority(Actor);
+
+		// Actors are judged by where their record puts them, not where they happen to be before the restore
+		const FVector Location = Item.RuntimeActorData ? Item.RuntimeActorData->Transform.GetLocation() : Item.PlacedActorData->Transform.GetLocation();
+
+		// Without any viewpoint, e.g. on a server before players joined, everything counts as near
+		Item.DistanceSquared = ViewLocations.Num() > 0 ? TNumericLimits<double>::Max() : 0.0;
+		for (const FVector& ViewLocation : ViewLocations)
+			Item.DistanceSquared = FMath::Min(Item.DistanceSquared, FVector::DistSquared(Location, ViewLocation));
+	}
+
+	// Stable, so actors which compare equal keep the order of the save
+	Items.StableSort([](const FEssRestoreItem& A, const FEssRestoreItem& B)
+	{
+		if (A.Priority != B.Priority)
+			return A.Priority > B.Priority;
+
+		return A.DistanceSquared < B.DistanceSquared;
+	});
+
+	const double PlayableRadius = GetDefault<UEssSettings>()->PlayableRestoreRadius;
+	const double PlayableRadiusSquared = PlayableRadius * PlayableRadius;
+
+	int32 NumPlayableItems = 0;
+	while (NumPlayableItems < Items.Num())
+	{
+		const FEssRestoreItem& Item = Items[NumPlayableItems];
+		if (Item.Priority < 0 || (Item.Priority == 0 && Item.DistanceSquared > PlayableRadiusSquared))
+			break;
+
+		++NumPlayableItems;
+	}
+
+	return NumPlayableItems;
+}
+
+void UEssSubsystem::RestoreItem(const FEssRestoreItem& Item, FEssReferenceResolver& Resolver)
+{
+	AActor* Actor = Item.Actor.Get();
+	if (!IsValid(Actor))
+		return;
+
+	if (Item.bReset)
+	{
+		ResetPlacedActor(*Item.PlacedActorData, Actor, Resolver);
+		return;
+	}
+
+	if (Item.RuntimeActorData)
+		RestoreRuntimeActorData(*Item.RuntimeActorData, Actor, Resolver, *Item.References);
+	else
+		RestorePlacedActorData(*Item.PlacedActorData, Actor, Resolver, *Item.References);
+
+	if (Item.bNotify)
+		Cast<IEssSavableInterface>(Actor)->Execute_PostLoadGame(Actor);
+}
+
+void UEssSubsystem::DestroyPlacedActors(const FEssLevelRestore& Restore)
+{
+	// Redestroy placed actors with no save data
+	for (auto PlacedActor : Restore.ActorsToDestroy)
+	{
+		if (!IsValid(PlacedActor))
+			continue;
+
+		UE_LOG(LogEss, Verbose, TEXT("Placed actor %s being destroyed."), *PlacedActor->GetFName().ToString());
+		PlacedActor->Destroy();
+		INC_DWORD_STAT(STAT_EssActorsDestroyed);
+	}
+}
+
+FEssRuntimeActorData UEssSubsystem::ExtractRuntimeActorData(TObjectPtr<AActor> Actor, FEssReferenceTable& References)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssExtractActorData);
+
+	FEssRuntimeActorData ActorData;
+
+	if (Actor->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject | RF_BeginDestroyed))
+		return ActorData;
+
+	FGuid Guid = EssUtil::GetGuid(Actor);
+	if (!Guid.IsValid())
+	{
+		Guid = FGuid::NewGuid();
+		if (!EssUtil::SetGuid(Actor, Guid))
+			return ActorData;
+	}
+
+	ActorData.Guid = Guid;
+	ActorData.Class = Actor->GetClass();
+	ActorData.Transform = Actor->GetActorTransform();
+
+	SerializeActor(Actor, ActorData.ByteData, ActorData.ComponentsData, References, ActorData.ReferenceIndices);
+
+	FEssStats::Get().AddClassBytes(Actor->GetClass(), ActorData.GetNumBytes());
+
+	return ActorData;
+}
+
+FEssPlacedActorData UEssSubsystem::ExtractPlacedActorData(TObjectPtr<AActor> Actor, FEssReferenceTable& References)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssExtractActorData);
+
+	FEssPlacedActorData ActorData;
+
+	if (Actor->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject | RF_BeginDestroyed))
+		return ActorData;
 
 	ActorData.Name = Actor->GetFName();
 	ActorData.Class = Actor->GetClass();
 	ActorData.Transform = Actor->GetActorTransform();
 
-	// Pass byte array to fill with data
-	FMemoryWriter MemoryWriter(ActorData.ByteData);
+	SerializeActor(Actor, ActorData.ByteData, ActorData.ComponentsData, References, ActorData.ReferenceIndices);
+
+	FEssStats::Get().AddClassBytes(Actor->GetClass(), ActorData.GetNumBytes());
+
+	return ActorData;
+}
+
+FEssGlobalObjectData UEssSubsystem::ExtractGlobalObjectData(TObjectPtr<UObject> Obj)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssExtractGlobalObjectData);
+
+	FEssGlobalObjectData ObjectData;
+
+	if (Obj->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject | RF_BeginDestroyed))
+		return ObjectData;
+
+	FGuid Guid = EssUtil::GetGuid(Obj);
+	if (!Guid.IsValid())
+	{
+		UE_LOG(LogEss, Warning, TEXT("Global object %s has no EssGuid value set and can therefore not be saved."), *Obj->GetFName().ToString());
+		return ObjectData;
+	}
+
+	ObjectData.Guid = Guid;
+	ObjectData.Class = Obj->GetClass();
+	/*ObjectData.LevelName = EssUtil::GetLevelName(Obj->Level);*/
+
+	// Pass byte array to fill with data
+	FMemoryWriter MemoryWriter(ObjectData.ByteData);
+
+	// Find variables with SaveGame property
+	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
+	Archive.ArIsSaveGame = true;
+	Archive.ArNoDelta = true;
+
+	// Convert object variables to binary data
+	Obj->Serialize(Archive);
+
+	FEssStats::Get().AddClassBytes(ObjectData.Class, ObjectData.ByteData.Num());
+
+	return ObjectData;
+}
+
+void UEssSubsystem::SerializeComponents(FObjectAndNameAsStringProxyArchive& Archive, const TArray<UActorComponent*>& Components)
+{
+	for (UActorComponent* Comp : Components)
+	{
+		if (IsValid(Comp))
+			Comp->Serialize(Archive);
+	}
+}
+
+void UEssSubsystem::SerializeActor(TObjectPtr<AActor> Actor, TArray<uint8>& OutBytes, TArray<FEssComponentData>& OutComponentsData, FEssReferenceTable& References,
+	TArray<int32>& OutReferenceIndices)
+{
+	// Pass byte array to fill with data
+	FMemoryWriter MemoryWriter(OutBytes);
+
+	// Find variables with SaveGame property, references to savable actors and assets are written as their index in the reference table
+	FEssSaveArchive Archive(MemoryWriter, References, OutReferenceIndices);
+
+	// Convert actor variables to binary data
+	Actor->Serialize(Archive);
+
+	// Every component gets its own record, so components can be restored independently of each other and of their order
+	ActorRegistry.ForEachSavableComponent(Actor, [&OutComponentsData, &References, &OutReferenceIndices](UActorComponent* Component)
+	{
+		FEssComponentData& ComponentData = OutComponentsData.AddDefaulted_GetRef();
+		ComponentData.Name = Component->GetFName();
+
+		FMemoryWriter ComponentWriter(ComponentData.ByteData);
+		FEssSaveArchive ComponentArchive(ComponentWriter, References, OutReferenceIndices);
+		Component->Serialize(ComponentArchive);
+	});
+
+	// The order of an actor's components isn't stable, records are compared with each other for elision and snapshots
+	OutComponentsData.Sort([](const FEssComponentData& A, const FEssComponentData& B) { return A.Name.LexicalLess(B.Name); });
+}
+
+void UEssSubsystem::DeserializeActor(TObjectPtr<AActor> Actor, const TArray<uint8>& Bytes, const TArray<FEssComponentData>& ComponentsData,
+	FEssReferenceResolver& Resolver, const TArray<FEssObjectReference>& References, const TArray<FEssComponentData>* CurrentComponentsData)
+{
+	// Pass saved byte array to read from
+	FMemoryReader MemoryReader(Bytes);
+
+	// Find variables with "SaveGame" property
+	FEssSaveArchive Archive(MemoryReader, Resolver, References);
+
+	// Convert actor binary data back to variables
+	Actor->Serialize(Archive);
+
+	// Records written before components were keyed continue with the actor's components in their order at the time of saving
+	if (!Archive.AtEnd())
+	{
+		SerializeComponents(Archive, Actor->GetComponentsByInterface(UEssSavableInterface::StaticClass()));
+		return;
+	}
+
+	if (ComponentsData.IsEmpty())
+		return;
+
+	ActorRegistry.ForEachSavableComponent(Actor, [&ComponentsData, &Resolver, &References, CurrentComponentsData](UActorComponent* Component)
+	{
+		// Components which have been added since the save have no record and keep their state
+		const FEssComponentData* ComponentData = EssUtil::FindComponentData(ComponentsData, Component->GetFName());
+		if (!ComponentData)
+			return;
+
+		const FEssComponentData* CurrentData = CurrentComponentsData ? EssUtil::FindComponentData(*CurrentComponentsData, Component->GetFName()) : nullptr;
+		if (CurrentData && CurrentData->ByteData == ComponentData->ByteData)
+			return;
+
+		FMemoryReader ComponentReader(ComponentData->ByteData);
+		FEssSaveArchive ComponentArchive(ComponentReader, Resolver, References);
+		Component->Serialize(ComponentArchive);
+	});
+}
+
+void UEssSubsystem::CapturePlacedActorBaselines(ULevel* Level)
+{
+	TArray<AActor*> SavableActors;
+	ActorRegistry.GetActors(Level, SavableActors);
+
+	TMap<FName, FEssPlacedActorData> Baselines;
+	FEssReferenceTable References;
+
+	for (AActor* Actor : SavableActors)
+	{
+		if (!IsValid(Actor) || EssUtil::IsRuntimeActor(Actor))
+			continue;
+
+		FEssPlacedActorData& Baseline = Baselines.Add(Actor->GetFName());
+		Baseline.Name = Actor->GetFName();
+		Baseline.Class = Actor->GetClass();
+		Baseline.Transform = Actor->GetActorTransform();
+		SerializeActor(Actor, Baseline.ByteData, Baseline.ComponentsData, References, Baseline.ReferenceIndices);
+	}
+
+	ActorRegistry.SetPlacedActorBaselines(Level, MoveTemp(Baselines), MoveTemp(References));
+}
+
+void UEssSubsystem::CaptureInstanceComponents(ULevel* Level)
+{
+	TArray<FEssInstanceComponent> InstanceComponents;
+
+	// Instanced components are far fewer than actors, so they are found through the class's object hash instead of every actor of the level
+	ForEachObjectOfClass(UInstancedStaticMeshComponent::StaticClass(), [Level, &InstanceComponents](UObject* Obj)
+	{
+		UInstancedStaticMeshComponent* Component = CastChecked<UInstancedStaticMeshComponent>(Obj);
+		if (Component->GetComponentLevel() == Level && FEssInstances::IsSavable(Component))
+			InstanceComponents.Add(FEssInstances::CaptureAuthored(Component));
+	}, true, RF_ClassDefaultObject | RF_ArchetypeObject);
+
+	ActorRegistry.SetInstanceComponents(Level, MoveTemp(InstanceComponents));
+}
+
+void UEssSubsystem::GetInstancesData(const ULevel* Level, FEssLevelData& LevelData) const
+{
+	const TArray<FEssInstanceComponent>* InstanceComponents = ActorRegistry.GetInstanceComponents(Level);
+	if (!InstanceComponents)
+		return;
+
+	for (const FEssInstanceComponent& InstanceComponent : *InstanceComponents)
+	{
+		// Components which still have their level-authored instances get them back from the level
+		FEssInstancesData InstancesData;
+		if (FEssInstances::Extract(InstanceComponent, InstancesData))
+			LevelData.InstancesData.Add(MoveTemp(InstancesData));
+	}
+}
+
+void UEssSubsystem::RestoreInstancesData(const ULevel* Level, const FEssLevelData& LevelData)
+{
+	const TArray<FEssInstanceComponent>* InstanceComponents = ActorRegistry.GetInstanceComponents(Level);
+	if (!InstanceComponents || InstanceComponents->Num() == 0)
+		return;
+
+	TMap<TPair<FName, FName>, const FEssInstancesData*> Records;
+	Records.Reserve(LevelData.InstancesData.Num());
+	for (const FEssInstancesData& InstancesData : LevelData.InstancesData)
+		Records.Add(TPair<FName, FName>(InstancesData.ActorName, InstancesData.ComponentName), &InstancesData);
+
+	for (const FEssInstanceComponent& InstanceComponent : *InstanceComponents)
+	{
+		const UInstancedStaticMeshComponent* Component = InstanceComponent.Component.Get();
+		if (!IsValid(Component))
+			continue;
+
+		// Components without a record were in their level-authored state when saving
+		const FEssInstancesData* const* InstancesData = Records.Find(TPair<FName, FName>(Component->GetOwner()->GetFName(), Component->GetFName()));
+		FEssInstances::Restore(InstanceComponent, InstancesData ? *InstancesData : nullptr);
+	}
+}
+
+void UEssSubsystem::ResetPlacedActor(const FEssPlacedActorData& Baseline, TObjectPtr<AActor> Actor, FEssReferenceResolver& Resolver)
+{
+	FEssReferenceTable* References = ActorRegistry.GetPlacedActorBaselineReferences(Actor->GetLevel());
+	if (!References)
+		return;
+
+	// Comparing is cheaper than restoring, and actors which haven't changed don't need PostLoadGame
+	FEssPlacedActorData CurrentData;
+	CurrentData.Class = Actor->GetClass();
+	CurrentData.Transform = Actor->GetActorTransform();
+	SerializeActor(Actor, CurrentData.ByteData, CurrentData.ComponentsData, *References, CurrentData.ReferenceIndices);
+
+	if (CurrentData.HasSameState(Baseline))
+		return;
+
+	// Components which still match the baseline are skipped
+	RestorePlacedActorData(Baseline, Actor, Resolver, References->GetReferences(), &CurrentData.ComponentsData);
+	Cast<IEssSavableInterface>(Actor)->Execute_PostLoadGame(Actor);
+}
+
+AActor* UEssSubsystem::SpawnActorForRecord(const TSubclassOf<AActor>& Class, const FTransform& Transform, const TObjectPtr<ULevel> Level, AActor* Owner)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRespawnActor);
+
+	if (!Class)
+		return nullptr;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = Owner;
+	SpawnParams.OverrideLevel = Level;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* SpawnedActor = Level->GetWorld()->SpawnActor<AActor>(Class, Transform, SpawnParams);
+	if (!IsValid(SpawnedActor))
+		return nullptr;
+
+	INC_DWORD_STAT(STAT_EssActorsSpawned);
+	return SpawnedActor;
+}
+
+void UEssSubsystem::RespawnRuntimeActor(const FEssRuntimeActorData& ActorData, const TObjectPtr<ULevel> Level, FEssReferenceResolver& Resolver,
+	const TArray<FEssObjectReference>& References, AActor* Owner)
+{
+	AActor* SpawnedActor = SpawnActorForRecord(EssUtil::GetLoadedClass(ActorData.Class), ActorData.Transform, Level, Owner);
+	if (SpawnedActor)
+	{
+		RestoreRuntimeActorData(ActorData, SpawnedActor, Resolver, References);
+		Cast<IEssSavableInterface>(SpawnedActor)->Execute_PostLoadGame(SpawnedActor);
+	}
+}
+
+void UEssSubsystem::RespawnPlacedActor(const FEssPlacedActorData& ActorData, const TObjectPtr<ULevel> Level, FEssReferenceResolver& Resolver,
+	const TArray<FEssObjectReference>& References)
+{
+	AActor* SpawnedActor = SpawnActorForRecord(EssUtil::GetLoadedClass(ActorData.Class), ActorData.Transform, Level);
+	if (SpawnedActor)
+	{
+		RestorePlacedActorData(ActorData, SpawnedActor, Resolver, References);
+		Cast<IEssSavableInterface>(SpawnedActor)->Execute_PostLoadGame(SpawnedActor);
+	}
+}
+
+void UEssSubsystem::RestoreRuntimeActorData(const FEssRuntimeActorData& ActorData, TObjectPtr<AActor> Actor, FEssReferenceResolver& Resolver,
+	const TArray<FEssObjectReference>& References)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreActorData);
+	INC_DWORD_STAT(STAT_EssActorsRestored);
+
+	ActorRegistry.MarkRestored(Actor->GetLevel());
+	EssUtil::SetGuid(Actor, ActorData.Guid);
+
+	Actor->SetActorTransform(ActorData.Transform);
+
+	DeserializeActor(Actor, ActorData.ByteData, ActorData.ComponentsData, Resolver, References);
+}
+
+void UEssSubsystem::RestorePlacedActorData(const FEssPlacedActorData& ActorData, TObjectPtr<AActor> Actor, FEssReferenceResolver& Resolver,
+	const TArray<FEssObjectReference>& References, const TArray<FEssComponentData>* CurrentComponentsData)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreActorData);
+	INC_DWORD_STAT(STAT_EssActorsRestored);
+
+	ActorRegistry.MarkRestored(Actor->GetLevel());
+	Actor->SetActorTransform(ActorData.Transform);
+
+	DeserializeActor(Actor, ActorData.ByteData, ActorData.ComponentsData, Resolver, References, CurrentComponentsData);
+}
+
+void UEssSubsystem::RestoreGlobalObjectData(const FEssGlobalObjectData& ObjectData, TObjectPtr<UObject> Obj)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssRestoreGlobalObjectData);
+
+	// Pass saved byte array to read from
+	FMemoryReader MemoryReader(ObjectData.ByteData);
+
+	// Find variables with "SaveGame" property
+	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
+	Archive.ArIsSaveGame = true;
+	Archive.ArNoDelta = true;
+
+	// Convert obj binary data back to variables
+	Obj->Serialize(Archive);
+}
+
+bool UEssSubsystem::AddGlobalObjectsData(const TArray<UObject*>& Objects, FEssSaveData& SaveData, TArray<UObject*>& OutSavedObjects)
+{
+	// Index existing records once so each object is replaced in place instead of searched for
+	TMap<FGuid, int32> ExistingRecords;
+	ExistingRecords.Reserve(SaveData.GlobalObjectData.Num() + Objects.Num());
+	for (int32 i = 0; i < SaveData.GlobalObjectData.Num(); ++i)
+		ExistingRecords.Add(SaveData.GlobalObjectData[i].Guid, i);
+
+	bool bAllExtracted = true;
+	OutSavedObjects.Reserve(OutSavedObjects.Num() + Objects.Num());
+
+	for (UObject* Obj : Objects)
+	{
+		if (!IsValid(Obj) || !Obj->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
+		{
+			bAllExtracted = false;
+			continue;
+		}
+
+		Cast<IEssSavableInterface>(Obj)->Execute_PreSaveGame(Obj);
+
+		FEssGlobalObjectData ObjectData = ExtractGlobalObjectData(Obj);
+		if (!ObjectData)
+		{
+			UE_LOG(LogEss, Warning, TEXT("Global object %s not saved. Save data couldn't be extracted."), *Obj->GetFName().ToString());
+			bAllExtracted = false;
+			continue;
+		}
+
+		if (const int32* FoundIndex = ExistingRecords.Find(ObjectData.Guid))
+		{
+			SaveData.GlobalObjectData[*FoundIndex] = MoveTemp(ObjectData);
+		}
+		else
+		{
+			const FGuid Guid = ObjectData.Guid;
+			ExistingRecords.Add(Guid, SaveData.GlobalObjectData.Add(MoveTemp(ObjectData)));
+		}
+
+		OutSavedObjects.Add(Obj);
+	}
+
+	return bAllExtracted;
+}
+
+bool UEssSubsystem::RestoreGlobalObjectsData(const TArray<UObject*>& Objects, const FEssSaveData& SaveData, int32& OutNumLoaded)
+{
+	TMap<FGuid, const FEssGlobalObjectData*> Records;
+	Records.Reserve(SaveData.GlobalObjectData.Num());
+	for (const FEssGlobalObjectData& ObjectData : SaveData.GlobalObjectData)
+		Records.Add(ObjectData.Guid, &ObjectData);
+
+	bool bAllLoaded = true;
+	for (UObject* Obj : Objects)
+	{
+		if (!IsValid(Obj) || !Obj->GetClass()->ImplementsInterface(UEssSavableInterface::StaticClass()))
+		{
+			bAllLoaded = false;
+			continue;
+		}
+
+		const FGuid Guid = EssUtil::GetGuid(Obj);
+		const FEssGlobalObjectData* const* ObjectData = Guid.IsValid() ? Records.Find(Guid) : nullptr;
+		if (!ObjectData)
+		{
+			UE_LOG(LogEss, Warning, TEXT("Global object %s not loaded. No save data found for its GUID."), *Obj->GetFName().ToString());
+			bAllLoaded = false;
+			continue;
+		}
+
+		RestoreGlobalObjectData(**ObjectData, Obj);
+		Cast<IEssSavableInterface>(Obj)->Execute_PostLoadGame(Obj);
+		++OutNumLoaded;
+	}
+
+	return bAllLoaded;
+}
+
+bool UEssSubsystem::SavePlayerShards(TArray<FEssPlayerShard>& Shards, const int32 UserIndex, FEssOperationTiming& OutTiming)
+{
+	if (Shards.IsEmpty())
+		return true;
+
+	GetPlayerActors(Shards);
+
+	// Every shard is its own file, so shards are read and written in parallel
+	ParallelFor(Shards.Num(), [&Shards, UserIndex](const int32 Index)
+	{
+		ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotRead);
+
+		FEssPlayerShard& Shard = Shards[Index];
+		Shard.bSlotExists = FEssStorage::Get()->DoesSlotExist(Shard.SlotName, UserIndex);
+		if (Shard.bSlotExists && FEssStorage::Get()->Read(Shard.SlotName, UserIndex, Shard.Bytes))
+			FEssStats::Get().AddFileBytesRead(Shard.Bytes.Num());
+	});
+
+	const FString WorldName = GetWorld()->GetFName().ToString();
+
+	// Actors and objects can only be captured and serialized on the game thread
+	for (FEssPlayerShard& Shard : Shards)
+	{
+		if (Shard.bSlotExists)
+			Shard.SaveGame = Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromMemory(Shard.Bytes));
+		else
+			Shard.SaveGame = Cast<UEssSaveGame>(UGameplayStatics::CreateSaveGameObject(UEssSaveGame::StaticClass()));
+
+		Shard.Bytes.Reset();
+
+		if (!IsValid(Shard.SaveGame))
+		{
+			UE_LOG(LogEss, Warning, TEXT("Player shard %s not saved. SaveGame is not valid."), *Shard.SlotName);
+			continue;
+		}
+
+		Shard.SaveGame->DeleteWorldData(Shard.SlotName, WorldName);
+
+		FEssSaveData& SaveData = Shard.SaveGame->FindOrAddSaveData(Shard.SlotName);
+		FEssWorldData& WorldData = SaveData.WorldsData.Add(WorldName);
+		WorldData.Name = WorldName;
+
+		TMap<ULevel*, TArray<AActor*>> LevelActors;
+		for (AActor* Actor : Shard.Actors)
+			LevelActors.FindOrAdd(Actor->GetLevel()).Add(Actor);
+
+		for (const auto& LevelPair : LevelActors)
+		{
+			FEssLevelData LevelData = GetLevelData(LevelPair.Key, &LevelPair.Value);
+			OutTiming.ActorCount += LevelData.RuntimeActorsData.Num() + LevelData.PlacedActorsData.Num();
+			WorldData.LevelsData.Add(LevelData.Name, MoveTemp(LevelData));
+		}
+
+		AddGlobalObjectsData(Shard.GlobalObjects, SaveData, Shard.SavedObjects);
+
+		ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotWrite);
+		Shard.SaveGame->WriteGuid = FGuid::NewGuid();
+		if (!UGameplayStatics::SaveGameToMemory(Shard.SaveGame, Shard.Bytes))
+			Shard.Bytes.Reset();
+	}
+
+	// All shards are handed to the storage backend at once, so it can batch their writes
+	TArray<FEssSlotWrite> SlotWrites;
+	TArray<FEssPlayerShard*> WrittenShards;
+
+	for (FEssPlayerShard& Shard : Shards)
+	{
+		if (Shard.Bytes.IsEmpty())
+			continue;
+
+		FEssSlotWrite& SlotWrite = SlotWrites.AddDefaulted_GetRef();
+		SlotWrite.SlotName = Shard.SlotName;
+		SlotWrite.UserIndex = UserIndex;
+		SlotWrite.Bytes = &Shard.Bytes;
+		WrittenShards.Add(&Shard);
+	}
+
+	{
+		ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotWrite);
+		FEssStorage::Get()->WriteBatch(SlotWrites);
+	}
+
+	for (int32 i = 0; i < SlotWrites.Num(); ++i)
+		WrittenShards[i]->bSucceeded = SlotWrites[i].bSucceeded;
+
+	bool bAllSaved = true;
+
+	for (FEssPlayerShard& Shard : Shards)
+	{
+		ResetRecordIndex(Shard.SlotName);
+
+		if (!Shard.bSucceeded)
+		{
+			UE_LOG(LogEss, Warning, TEXT("Player shard %s not saved."), *Shard.SlotName);
+			bAllSaved = false;
+			continue;
+		}
+
+		FEssStats::Get().AddFileBytesWritten(Shard.Bytes.Num());
+		OutTiming.FileBytes += Shard.Bytes.Num();
+		WriteRecordIndexAsync(Shard.SaveGame, Shard.SlotName, UserIndex, MoveTemp(Shard.Bytes));
+
+		for (UObject* Obj : Shard.SavedObjects)
+			Cast<IEssSavableInterface>(Obj)->Execute_PostSaveGame(Obj);
+	}
+
+	UE_LOG(LogEss, Log, TEXT("%d player shards saved."), Shards.Num());
+	return bAllSaved;
+}
+
+void UEssSubsystem::GetPlayerActors(TArray<FEssPlayerShard>& Shards)
+{
+	TMap<const APlayerState*, int32> ShardIndices;
+	for (int32 i = 0; i < Shards.Num(); ++i)
+		ShardIndices.Add(Shards[i].PlayerState, i);
+
+	TrackWorld(GetWorld());
+	for (ULevel* Level : GetWorld()->GetLevels())
+		RegisterLevel(Level);
+
+	TSet<AActor*> AddedActors;
+	auto AddActor = [&Shards, &ShardIndices, &AddedActors](AActor* Actor, const APlayerState* PlayerState)
+	{
+		const int32* Index = ShardIndices.Find(PlayerState);
+		if (Index && !AddedActors.Contains(Actor))
+		{
+			AddedActors.Add(Actor);
+			Shards[*Index].Actors.Add(Actor);
+		}
+	};
+
+	// Actors without an owner only belong to a player if they are its PlayerState, controller or pawn
+	for (FEssPlayerShard& Shard : Shards)
+	{
+		for (AActor* Actor : { static_cast<AActor*>(Shard.PlayerState), Shard.PlayerState->GetOwner(), static_cast<AActor*>(Shard.PlayerState->GetPawn()) })
+		{
+			if (ActorRegistry.ContainsActor(Actor))
+				AddActor(Actor, EssUtil::GetOwningPlayerState(Actor));
+		}
+	}
+
+	// Owned actors belong to the player of their owner, unless they are a PlayerState, controller or pawn themselves.
+	// The owner chain is walked once per owner instead of once per actor.
+	ActorRegistry.RefreshOwners();
+
+	TArray<AActor*> Owners;
+	ActorRegistry.GetOwners(Owners);
+
+	TArray<AActor*> OwnedActors;
+	for (AActor* Owner : Owners)
+	{
+		const APlayerState* OwnerPlayerState = EssUtil::GetOwningPlayerState(Owner);
+
+		ActorRegistry.GetOwnedActors(Owner, OwnedActors);
+		for (AActor* Actor : OwnedActors)
+		{
+			const bool bPlayerActor = Actor->IsA<APlayerState>() || Actor->IsA<APlayerController>() || Actor->IsA<APawn>();
+			AddActor(Actor, bPlayerActor ? EssUtil::GetOwningPlayerState(Actor) : OwnerPlayerState);
+		}
+	}
+}
+
+bool UEssSubsystem::IsExcludedPlayerActor(AActor* Actor) const
+{
+	return GetDefault<UEssSettings>()->bExcludePlayerOwnedActors && EssUtil::GetOwningPlayerState(Actor);
+}
+
+TSharedPtr<FEssRecordIndex> UEssSubsystem::GetRecordIndex(const FString& SlotName, const int32 UserIndex)
+{
+	const TPair<FString, int32> Key(SlotName, UserIndex);
+	if (const TFuture<void>* Write = RecordIndexWrites.Find(Key))
+	{
+		// Until its index has been written, the slot is read in full
+		if (!Write->IsReady())
+			return nullptr;
+
+		RecordIndexWrites.Remove(Key);
+		RecordIndices.Remove(Key);
+	}
+
+	// Opening an index checks it against the slot, so the result is kept, including a missing or stale index,
+	// until the slot is written or deleted again
+	if (const TSharedPtr<FEssRecordIndex>* RecordIndex = RecordIndices.Find(Key))
+		return *RecordIndex;
+
+	return RecordIndices.Add(Key, FEssRecordIndex::Open(SlotName, UserIndex));
+}
+
+void UEssSubsystem::ResetRecordIndex(const FString& SlotName)
+{
+	for (auto It = RecordIndices.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key == SlotName)
+			It.RemoveCurrent();
+	}
+}
+
+void UEssSubsystem::WaitForRecordIndexWrites()
+{
+	for (auto& WritePair : RecordIndexWrites)
+	{
+		WritePair.Value.Wait();
+		RecordIndices.Remove(WritePair.Key);
+	}
 
-	// Find variables with SaveGame property
-	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
-	Archive.ArIsSaveGame = true;
-	Archive.ArNoDelta = true;
+	RecordIndexWrites.Reset();
+}
 
-	// Convert actor variables to binary data
-	Actor->Serialize(Archive);
+void UEssSubsystem::WriteRecordIndexAsync(const UEssSaveGame* SaveGame, const FString& SlotName, const int32 UserIndex, TArray<uint8>&& SlotBytes)
+{
+	ResetRecordIndex(SlotName);
 
-	// Convert actor components' variables to binary data
-	TArray<UActorComponent*> ActorComponents = Actor->GetComponentsByInterface(UEssSavableInterface::StaticClass());
-	SerializeComponents(Archive, ActorComponents);
+	// The save game may change as soon as this returns, the background write gets its own copy of the records
+	const FEssSaveData* SaveData = SaveGame->SaveData.Find(SlotName);
+	TSharedPtr<FEssSaveData> IndexData;
+	if (SaveData && GetDefault<UEssSettings>()->bWriteRecordIndex)
+		IndexData = MakeShared<FEssSaveData>(*SaveData);
 
-	return ActorData;
+	// The index of an earlier write of the slot must not replace this one
+	const TPair<FString, int32> Key(SlotName, UserIndex);
+	if (const TFuture<void>* PreviousWrite = RecordIndexWrites.Find(Key))
+		PreviousWrite->Wait();
+
+	RecordIndexWrites.Add(Key, Async(EAsyncExecution::TaskGraph,
+		[IndexData, WriteGuid = SaveGame->WriteGuid, SlotName, UserIndex, SlotBytes = MoveTemp(SlotBytes)]()
+		{
+			WriteRecordIndex(IndexData.Get(), WriteGuid, SlotName, UserIndex, SlotBytes);
+		}));
 }
 
-FEssGlobalObjectData UEssSubsystem::ExtractGlobalObjectData(TObjectPtr<UObject> Obj)
+void UEssSubsystem::WriteRecordIndex(const FEssSaveData* SaveData, const FGuid& WriteGuid, const FString& SlotName, const int32 UserIndex, const TArray<uint8>& SlotBytes)
 {
-	FEssGlobalObjectData ObjectData;
+	if (SaveData && GetDefault<UEssSettings>()->bWriteRecordIndex)
+	{
+		if (FEssRecordIndex::Write(SlotName, UserIndex, *SaveData, WriteGuid, SlotBytes))
+			return;
 
-	if (Obj->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject | RF_BeginDestroyed))
-		return ObjectData;
+		UE_LOG(LogEss, Warning, TEXT("Record index of slot %s could not be written."), *SlotName);
+	}
 
-	FGuid Guid = EssUtil::GetGuid(Obj);
-	if (!Guid.IsValid())
+	// A stale index would be rejected when it's opened, deleting it saves reading the slot to find out
+	FEssRecordIndex::Delete(SlotName, UserIndex);
+}
+
+const FEssWorldData* UEssSubsystem::FindWorldData(const UEssSaveGame* SaveGame, const FString& SlotName) const
+{
+	if (!IsValid(SaveGame))
+		return nullptr;
+
+	const FEssSaveData* SaveData = SaveGame->SaveData.Find(SlotName);
+	return SaveData ? SaveData->WorldsData.Find(GetWorld()->GetFName().ToString()) : nullptr;
+}
+
+bool UEssSubsystem::FindRuntimeActorRecord(const FString& SlotName, const int32 UserIndex, const FGuid& Guid, FEssRuntimeActorData& OutActorData, FString& OutLevelName,
+	TArray<FEssObjectReference>& OutReferences)
+{
+	if (TSharedPtr<FEssRecordIndex> RecordIndex = GetRecordIndex(SlotName, UserIndex))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Global object %s has no EssGuid value set and can therefore not be saved."), *Obj->GetFName().ToString());
-		return ObjectData;
-	}
+		const FEssRecordIndexEntry* Entry = RecordIndex->Find(EEssRecordKind::RuntimeActor, GetWorld()->GetFName().ToString(), FString(), Guid.ToString());
+		if (!Entry || !RecordIndex->ReadRecord(*Entry, OutActorData))
+			return false;
 
-	ObjectData.Guid = Guid;
-	ObjectData.Class = Obj->GetClass();
-	/*ObjectData.LevelName = EssUtil::GetLevelName(Obj->Level);*/
+		OutLevelName = Entry->Level;
 
-	// Pass byte array to fill with data
-	FMemoryWriter MemoryWriter(ObjectData.ByteData);
+		// The level's reference table is only read if the record refers to it
+		FEssLevelData LevelHeader;
+		if (OutActorData.ReferenceIndices.Num() > 0 && FindLevelHeader(SlotName, UserIndex, OutLevelName, LevelHeader))
+			OutReferences = MoveTemp(LevelHeader.ObjectReferences);
 
-	// Find variables with SaveGame property
-	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
-	Archive.ArIsSaveGame = true;
-	Archive.ArNoDelta = true;
+		return true;
+	}
 
-	// Convert object variables to binary data
-	Obj->Serialize(Archive);
+	const FEssWorldData* WorldData = FindWorldData(GetSaveGame(SlotName, UserIndex), SlotName);
+	if (!WorldData)
+		return false;
 
-	return ObjectData;
+	for (const auto& LevelPair : WorldData->LevelsData)
+	{
+		for (const FEssRuntimeActorData& ActorData : LevelPair.Value.RuntimeActorsData)
+		{
+			if (ActorData.Guid == Guid)
+			{
+				OutActorData = ActorData;
+				OutLevelName = LevelPair.Key;
+				OutReferences = LevelPair.Value.ObjectReferences;
+				return true;
+			}
+		}
+	}
+
+	return false;
 }
 
-void UEssSubsystem::SerializeComponents(FObjectAndNameAsStringProxyArchive& Archive, TArray<UActorComponent*> Components)
+bool UEssSubsystem::FindPlacedActorRecord(const FString& SlotName, const int32 UserIndex, const FString& LevelName, const FName ActorName, FEssPlacedActorData& OutActorData,
+	TArray<FEssObjectReference>& OutReferences)
 {
-	for (UActorComponent* Comp : Components)
+	if (TSharedPtr<FEssRecordIndex> RecordIndex = GetRecordIndex(SlotName, UserIndex))
 	{
-		if (IsValid(Comp))
-			Comp->Serialize(Archive);
+		const FEssRecordIndexEntry* Entry = RecordIndex->Find(EEssRecordKind::PlacedActor, GetWorld()->GetFName().ToString(), LevelName, ActorName.ToString());
+		if (!Entry || !RecordIndex->ReadRecord(*Entry, OutActorData))
+			return false;
+
+		FEssLevelData LevelHeader;
+		if (OutActorData.ReferenceIndices.Num() > 0 && FindLevelHeader(SlotName, UserIndex, LevelName, LevelHeader))
+			OutReferences = MoveTemp(LevelHeader.ObjectReferences);
+
+		return true;
 	}
+
+	const FEssWorldData* WorldData = FindWorldData(GetSaveGame(SlotName, UserIndex), SlotName);
+	const FEssLevelData* LevelData = WorldData ? WorldData->LevelsData.Find(LevelName) : nullptr;
+	const FEssPlacedActorData* ActorData = LevelData ? LevelData->PlacedActorsData.Find(ActorName) : nullptr;
+	if (!ActorData)
+		return false;
+
+	OutActorData = *ActorData;
+	OutReferences = LevelData->ObjectReferences;
+	return true;
 }
 
-void UEssSubsystem::RespawnRuntimeActor(const FEssRuntimeActorData& ActorData, const TObjectPtr<ULevel> Level)
+bool UEssSubsystem::FindLevelRecord(const FString& SlotName, const int32 UserIndex, const FString& LevelName, FEssLevelData& OutLevelData)
 {
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.OverrideLevel = Level;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	if (TSharedPtr<FEssRecordIndex> RecordIndex = GetRecordIndex(SlotName, UserIndex))
+	{
+		const FEssRecordIndexEntry* Entry = RecordIndex->Find(EEssRecordKind::Level, GetWorld()->GetFName().ToString(), LevelName, LevelName);
+		return Entry && RecordIndex->ReadLevel(*Entry, OutLevelData);
+	}
+
+	const FEssWorldData* WorldData = FindWorldData(GetSaveGame(SlotName, UserIndex), SlotName);
+	const FEssLevelData* LevelData = WorldData ? WorldData->LevelsData.Find(LevelName) : nullptr;
+	if (!LevelData)
+		return false;
+
+	OutLevelData = *LevelData;
+	return true;
+}
 
-	AActor* SpawnedActor = Level->GetWorld()->SpawnActor<AActor>(ActorData.Class, ActorData.Transform, SpawnParams);
-	if (IsValid(SpawnedActor))
+bool UEssSubsystem::FindLevelHeader(const FString& SlotName, const int32 UserIndex, const FString& LevelName, FEssLevelData& OutLevelHeader)
+{
+	if (TSharedPtr<FEssRecordIndex> RecordIndex = GetRecordIndex(SlotName, UserIndex))
 	{
-		RestoreRuntimeActorData(ActorData, SpawnedActor);
-		Cast<IEssSavableInterface>(SpawnedActor)->Execute_PostLoadGame(SpawnedActor);
+		const FEssRecordIndexEntry* Entry = RecordIndex->Find(EEssRecordKind::Level, GetWorld()->GetFName().ToString(), LevelName, LevelName);
+		return Entry && RecordIndex->ReadLevelHeader(*Entry, OutLevelHeader);
 	}
+
+	const FEssWorldData* WorldData = FindWorldData(GetSaveGame(SlotName, UserIndex), SlotName);
+	const FEssLevelData* LevelData = WorldData ? WorldData->LevelsData.Find(LevelName) : nullptr;
+	if (!LevelData)
+		return false;
+
+	OutLevelHeader = EssUtil::GetLevelHeader(*LevelData);
+	return true;
 }
 
-void UEssSubsystem::RespawnPlacedActor(const FEssPlacedActorData& ActorData, const TObjectPtr<ULevel> Level)
+const FEssPlacedActorData* UEssSubsystem::FindPlacedActorBaseline(ULevel* Level, const FName ActorName)
 {
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.OverrideLevel = Level;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	// Baselines are captured when the level is registered
+	TrackWorld(Level->GetWorld());
+	RegisterLevel(Level);
 
-	AActor* SpawnedActor = Level->GetWorld()->SpawnActor<AActor>(ActorData.Class, ActorData.Transform, SpawnParams);\
+	const TMap<FName, FEssPlacedActorData>* Baselines = ActorRegistry.GetPlacedActorBaselines(Level);
+	return Baselines ? Baselines->Find(ActorName) : nullptr;
+}
 
-	if (IsValid(SpawnedActor))
+bool UEssSubsystem::PeekElidedPlacedActor(const FString& LevelName, const FName ActorName, const FString& SlotName, const int32 UserIndex, FEssRecordInfo& OutInfo)
+{
+	FEssLevelData LevelHeader;
+	if (!FindLevelHeader(SlotName, UserIndex, LevelName, LevelHeader) || !LevelHeader.bDefaultPlacedActorsElided ||
+		LevelHeader.DestroyedPlacedActors.Contains(ActorName))
 	{
-		RestorePlacedActorData(ActorData, SpawnedActor);
-		Cast<IEssSavableInterface>(SpawnedActor)->Execute_PostLoadGame(SpawnedActor);
+		return false;
 	}
+
+	// An elided actor was saved in the state it had when its level was loaded, which is only known while the level is loaded
+	ULevel* Level = FindLoadedLevel(LevelName);
+	const FEssPlacedActorData* Baseline = Level ? FindPlacedActorBaseline(Level, ActorName) : nullptr;
+	if (!Baseline)
+		return false;
+
+	// The record takes no space in the slot
+	OutInfo.Class = TSoftClassPtr<UObject>(Baseline->Class.ToSoftObjectPath());
+	OutInfo.Transform = Baseline->Transform;
+	OutInfo.ByteSize = 0;
+	return true;
 }
 
-void UEssSubsystem::RestoreRuntimeActorData(const FEssRuntimeActorData& ActorData, TObjectPtr<AActor> Actor)
+ULevel* UEssSubsystem::FindLoadedLevel(const FString& LevelName) const
 {
-	EssUtil::SetGuid(Actor, ActorData.Guid);
+	for (ULevel* Level : GetWorld()->GetLevels())
+	{
+		if (IsValid(Level) && EssUtil::GetLevelName(Level) == LevelName)
+			return Level;
+	}
 
-	Actor->SetActorTransform(ActorData.Transform);
+	return nullptr;
+}
 
-	// Pass saved byte array to read from
-	FMemoryReader MemoryReader(ActorData.ByteData);
+void UEssSubsystem::GetSavableActors(ULevel* Level, TArray<AActor*>& OutActors)
+{
+	TrackWorld(Level->GetWorld());
+	RegisterLevel(Level);
+	ActorRegistry.GetActors(Level, OutActors);
+}
 
-	// Find variables with "SaveGame" property
-	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
-	Archive.ArIsSaveGame = true;
-	Archive.ArNoDelta = true;
+void UEssSubsystem::RegisterLevel(ULevel* Level)
+{
+	if (!ActorRegistry.AddLevel(Level))
+		return;
 
-	// Convert actor binary data back to variables
-	Actor->Serialize(Archive);
+	// Levels are registered before anything is loaded into them, so their placed actors are still in their level-authored state
+	if (GetDefault<UEssSettings>()->bElideDefaultPlacedActors)
+		CapturePlacedActorBaselines(Level);
 
-	// Convert actor components' binary data back to variables
-	TArray<UActorComponent*> ActorComponents = Actor->GetComponentsByInterface(UEssSavableInterface::StaticClass());
-	SerializeComponents(Archive, ActorComponents);
+	CaptureInstanceComponents(Level);
 }
 
-void UEssSubsystem::RestorePlacedActorData(const FEssPlacedActorData& ActorData, TObjectPtr<AActor> Actor)
+void UEssSubsystem::TrackWorld(UWorld* World)
 {
-	Actor->SetActorTransform(ActorData.Transform);
+	if (!IsValid(World) || TrackedWorld == World)
+		return;
 
-	// Pass saved byte array to read from
-	FMemoryReader MemoryReader(ActorData.ByteData);
+	UntrackWorld();
 
-	// Find variables with "SaveGame" property
-	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
-	Archive.ArIsSaveGame = true;
-	Archive.ArNoDelta = true;
+	TrackedWorld = World;
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UEssSubsystem::OnActorSpawned));
+	ActorDestroyedHandle = World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UEssSubsystem::OnActorDestroyed));
 
-	// Convert actor binary data back to variables
-	Actor->Serialize(Archive);
+	for (ULevel* Level : World->GetLevels())
+		RegisterLevel(Level);
+}
+
+void UEssSubsystem::UntrackWorld()
+{
+	if (UWorld* World = TrackedWorld.Get())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		World->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+	}
 
-	// Convert actor components' binary data back to variables
-	TArray<UActorComponent*> ActorComponents = Actor->GetComponentsByInterface(UEssSavableInterface::StaticClass());
-	SerializeComponents(Archive, ActorComponents);
+	ActorSpawnedHandle.Reset();
+	ActorDestroyedHandle.Reset();
+	TrackedWorld.Reset();
+	ActorRegistry.Reset();
 }
 
-void UEssSubsystem::RestoreGlobalObjectData(const FEssGlobalObjectData& ObjectData, TObjectPtr<UObject> Obj)
+void UEssSubsystem::OnWorldInitializedActors(const FActorsInitializedParams& Params)
 {
-	// Pass saved byte array to read from
-	FMemoryReader MemoryReader(ObjectData.ByteData);
+	if (Params.World == GetWorld())
+		TrackWorld(Params.World);
+}
 
-	// Find variables with "SaveGame" property
-	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
-	Archive.ArIsSaveGame = true;
-	Archive.ArNoDelta = true;
+void UEssSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	if (World != TrackedWorld)
+		return;
 
-	// Convert obj binary data back to variables
-	Obj->Serialize(Archive);
+	FinishRestoreQueue(false);
+	UntrackWorld();
+	ClearSnapshots();
+}
+
+void UEssSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World == TrackedWorld)
+		RegisterLevel(Level);
+}
+
+void UEssSubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	if (World != TrackedWorld)
+		return;
+
+	// Reset actors point into the level's baselines, which are dropped with the level
+	FlushRestoreQueue();
+
+	// A null level means all levels have been removed from the world
+	if (Level)
+		ActorRegistry.RemoveLevel(Level);
+	else
+		ActorRegistry.Reset();
+}
+
+void UEssSubsystem::OnActorSpawned(AActor* Actor)
+{
+	ActorRegistry.AddActor(Actor);
+}
+
+void UEssSubsystem::OnActorDestroyed(AActor* Actor)
+{
+	ActorRegistry.RemoveActor(Actor);
 }
 
 UEssSaveGame* UEssSubsystem::GetSaveGameAndCreateIfNotExists(const FString& SlotName, const int32 UserIndex)
 {
-	if (!UGameplayStatics::DoesSaveGameExist(SlotName, UserIndex))
+	if (!FEssStorage::Get()->DoesSlotExist(SlotName, UserIndex))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("SaveGame does not exist. Creating new save game object."));
+		UE_LOG(LogEss, Log, TEXT("SaveGame does not exist. Creating new save game object."));
 
 		UEssSaveGame* SaveGame = Cast<UEssSaveGame>(UGameplayStatics::CreateSaveGameObject(UEssSaveGame::StaticClass()));
 		return SaveGame;
 	}
 	
-	UEssSaveGame* SaveGame = Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex));
-	return SaveGame;
+	return ReadSaveGame(SlotName, UserIndex);
 }
 
-UEssSaveGame* UEssSubsystem::GetSaveGame(const FString& SlotName, const int32 UserIndex)
+UEssSaveGame* UEssSubsystem::GetSaveGame(const FString& SlotName, const int32 UserIndex, int64* OutFileBytes)
 {
-	if (!UGameplayStatics::DoesSaveGameExist(SlotName, UserIndex))
+	if (!FEssStorage::Get()->DoesSlotExist(SlotName, UserIndex))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("SaveGame does not exist. Creating new save game object."));
+		UE_LOG(LogEss, Warning, TEXT("SaveGame does not exist."));
 		return nullptr;
 	}
 
-	UEssSaveGame* SaveGame = Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex));
-	return SaveGame;
+	return ReadSaveGame(SlotName, UserIndex, OutFileBytes);
+}
+
+UEssSaveGame* UEssSubsystem::ReadSaveGame(const FString& SlotName, const int32 UserIndex, int64* OutFileBytes)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotRead);
+
+	TArray<uint8> Bytes;
+	if (!FEssStorage::Get()->Read(SlotName, UserIndex, Bytes))
+		return nullptr;
+
+	FEssStats::Get().AddFileBytesRead(Bytes.Num());
+	if (OutFileBytes)
+		*OutFileBytes = Bytes.Num();
+
+	return Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromMemory(Bytes));
+}
+
+bool UEssSubsystem::WriteSaveGame(UEssSaveGame* SaveGame, const FString& SlotName, const int32 UserIndex, int64& OutFileBytes)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotWrite);
+
+	SaveGame->WriteGuid = FGuid::NewGuid();
+
+	TArray<uint8> Bytes;
+	if (!UGameplayStatics::SaveGameToMemory(SaveGame, Bytes))
+		return false;
+
+	if (!FEssStorage::Get()->Write(SlotName, UserIndex, Bytes))
+		return false;
+
+	FEssStats::Get().AddFileBytesWritten(Bytes.Num());
+	OutFileBytes = Bytes.Num();
+
+	WriteRecordIndexAsync(SaveGame, SlotName, UserIndex, MoveTemp(Bytes));
+	return true;
+}
+
+void UEssSubsystem::ReadSaveGameAsync(const FString& SlotName, const int32 UserIndex, TFunction<void(UEssSaveGame*)>&& OnRead)
+{
+	// Objects can only be created on the game thread, only the file read is moved off it
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [SlotName, UserIndex, OnRead = MoveTemp(OnRead)]() mutable
+	{
+		TSharedRef<TArray<uint8>> Bytes = MakeShared<TArray<uint8>>();
+		bool bRead = false;
+		{
+			ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotRead);
+			bRead = FEssStorage::Get()->Read(SlotName, UserIndex, *Bytes);
+		}
+
+		if (bRead)
+			FEssStats::Get().AddFileBytesRead(Bytes->Num());
+
+		AsyncTask(ENamedThreads::GameThread, [Bytes, bRead, OnRead = MoveTemp(OnRead)]()
+		{
+			OnRead(bRead ? Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromMemory(*Bytes)) : nullptr);
+		});
+	});
+}
+
+void UEssSubsystem::WriteSnapshotAsync(UEssSaveGame* SaveGame, FEssWorldData&& WorldData, const int32 SnapshotId, const FString& SlotName, const int32 UserIndex, const double StartTime)
+{
+	if (!IsValid(SaveGame))
+		SaveGame = Cast<UEssSaveGame>(UGameplayStatics::CreateSaveGameObject(UEssSaveGame::StaticClass()));
+
+	FEssOperationTiming Timing;
+	Timing.Operation = TEXT("FlushSnapshot");
+	Timing.SlotName = SlotName;
+	Timing.Time = FDateTime::Now();
+
+	for (const auto& LevelPair : WorldData.LevelsData)
+		Timing.ActorCount += LevelPair.Value.RuntimeActorsData.Num() + LevelPair.Value.PlacedActorsData.Num();
+
+	// Snapshots are kept without grids, as diffing them reorders the runtime records
+	FEssSpatialGrid::Build(WorldData);
+
+	FEssSaveData& SaveData = SaveGame->FindOrAddSaveData(SlotName);
+	SaveData.WorldsData.Add(WorldData.Name, MoveTemp(WorldData));
+
+	// Objects can only be serialized on the game thread, only the file writes are moved off it
+	SaveGame->WriteGuid = FGuid::NewGuid();
+	TSharedRef<TArray<uint8>> Bytes = MakeShared<TArray<uint8>>();
+	if (!UGameplayStatics::SaveGameToMemory(SaveGame, *Bytes))
+	{
+		Timing.DurationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		OnSnapshotFlushed(Timing, SnapshotId);
+		return;
+	}
+
+	TSharedPtr<FEssSaveData> IndexData;
+	if (GetDefault<UEssSettings>()->bWriteRecordIndex)
+		IndexData = MakeShared<FEssSaveData>(SaveData);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis = TWeakObjectPtr<UEssSubsystem>(this), Bytes, IndexData, WriteGuid = SaveGame->WriteGuid, Timing, SnapshotId,
+		SlotName, UserIndex, StartTime]() mutable
+	{
+		{
+			ESS_SCOPE_CYCLE_COUNTER(STAT_EssSlotWrite);
+			Timing.bSucceeded = FEssStorage::Get()->Write(SlotName, UserIndex, *Bytes);
+		}
+
+		if (Timing.bSucceeded)
+		{
+			Timing.FileBytes = Bytes->Num();
+			FEssStats::Get().AddFileBytesWritten(Bytes->Num());
+
+			WriteRecordIndex(IndexData.Get(), WriteGuid, SlotName, UserIndex, *Bytes);
+		}
+
+		Timing.DurationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Timing, SnapshotId]()
+		{
+			if (UEssSubsystem* This = WeakThis.Get())
+				This->OnSnapshotFlushed(Timing, SnapshotId);
+		});
+	});
+}
+
+void UEssSubsystem::OnSnapshotFlushed(const FEssOperationTiming& Timing, const int32 SnapshotId)
+{
+	FEssSnapshotFlushedDelegate OnFlushed;
+	FlushingSlots.RemoveAndCopyValue(Timing.SlotName, OnFlushed);
+	ResetRecordIndex(Timing.SlotName);
+	FEssStats::Get().RecordTiming(Timing);
+
+	if (Timing.bSucceeded)
+		UE_LOG(LogEss, Log, TEXT("Snapshot %d flushed to slot %s."), SnapshotId, *Timing.SlotName);
+	else
+		UE_LOG(LogEss, Warning, TEXT("Snapshot %d not flushed to slot %s."), SnapshotId, *Timing.SlotName);
+
+	OnFlushed.ExecuteIfBound(SnapshotId, Timing.bSucceeded);
+}
+
+void UEssSubsystem::PreloadClasses(const TSet<FSoftObjectPath>& ClassPaths)
+{
+	if (ClassPaths.Num() == 0)
+		return;
+
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssPreloadClasses);
+	INC_DWORD_STAT_BY(STAT_EssClassesPreloaded, ClassPaths.Num());
+
+	// A single request lets the packages load in parallel instead of one blocking load per spawned actor
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(ClassPaths.Array());
+	if (Handle)
+		Handle->WaitUntilComplete();
+}
+
+void UEssSubsystem::OnWorldSlotLoaded(UEssSaveGame* SaveGame, const FString& SlotName, const double StartTime, const FEssWorldLoadedDelegate& OnPlayable)
+{
+	const FEssSaveData* SaveData = IsValid(SaveGame) ? SaveGame->SaveData.Find(SlotName) : nullptr;
+	const FEssWorldData* WorldData = SaveData ? SaveData->WorldsData.Find(GetWorld()->GetFName().ToString()) : nullptr;
+
+	TSet<FSoftObjectPath> ClassPaths;
+	if (WorldData)
+		EssUtil::GetUnloadedClasses(*WorldData, ClassPaths);
+
+	if (ClassPaths.Num() == 0)
+	{
+		OnWorldClassesLoaded(SaveGame, SlotName, StartTime, OnPlayable);
+		return;
+	}
+
+	INC_DWORD_STAT_BY(STAT_EssClassesPreloaded, ClassPaths.Num());
+
+	// Keeps the save game alive until the classes are resident, the loaded classes are kept alive by the spawned actors
+	auto OnClassesLoaded = [WeakThis = TWeakObjectPtr<UEssSubsystem>(this), PinnedSaveGame = TStrongObjectPtr<UEssSaveGame>(SaveGame), SlotName, StartTime, OnPlayable]()
+	{
+		if (UEssSubsystem* This = WeakThis.Get())
+			This->OnWorldClassesLoaded(PinnedSaveGame.Get(), SlotName, StartTime, OnPlayable);
+	};
+
+	StreamableManager.RequestAsyncLoad(ClassPaths.Array(), FStreamableDelegate::CreateLambda(OnClassesLoaded));
+}
+
+void UEssSubsystem::OnWorldClassesLoaded(UEssSaveGame* SaveGame, const FString& SlotName, const double StartTime, const FEssWorldLoadedDelegate& OnPlayable)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssLoadWorld);
+
+	TSharedPtr<FEssRestoreQueue> Queue = MakeShared<FEssRestoreQueue>();
+	Queue->SaveGame.Reset(SaveGame);
+	Queue->StartTime = StartTime;
+	Queue->Timing.Operation = TEXT("LoadWorldAsync");
+	Queue->Timing.SlotName = SlotName;
+	Queue->Timing.Time = FDateTime::Now();
+
+	const FEssSaveData* SaveData = IsValid(SaveGame) ? SaveGame->SaveData.Find(SlotName) : nullptr;
+	const FEssWorldData* WorldData = SaveData ? SaveData->WorldsData.Find(GetWorld()->GetFName().ToString()) : nullptr;
+	if (!WorldData)
+	{
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. SaveGame is not valid or has no data for this world."));
+		OnPlayable.ExecuteIfBound(false);
+		RestoreQueue = Queue;
+		FinishRestoreQueue(false);
+		return;
+	}
+
+	// The actors of all levels are spawned first, so references across levels resolve as well
+	TArray<FEssLevelRestore> Restores;
+
+	for (auto Level : GetWorld()->GetLevels())
+	{
+		const FEssLevelData* LevelData = WorldData->LevelsData.Find(EssUtil::GetLevelName(Level));
+		if (LevelData)
+		{
+			PrepareLevelRestore(Level, LevelData, Restores.AddDefaulted_GetRef());
+			Queue->Timing.ActorCount += LevelData->RuntimeActorsData.Num() + LevelData->PlacedActorsData.Num();
+		}
+	}
+
+	FEssMass::Restore(GetWorld(), *WorldData);
+
+	Queue->Resolver = MakeUnique<FEssReferenceResolver>(GetWorld(), ActorRegistry);
+	for (const FEssLevelRestore& Restore : Restores)
+		Queue->Resolver->Resolve(Restore.LevelData->ObjectReferences);
+
+	for (const FEssLevelRestore& Restore : Restores)
+	{
+		GetRestoreItems(Restore, Queue->Items);
+		DestroyPlacedActors(Restore);
+	}
+
+	const int32 NumPlayableItems = SortRestoreItems(Queue->Items);
+	INC_DWORD_STAT_BY(STAT_EssActorsDeferred, Queue->Items.Num() - NumPlayableItems);
+
+	// Restoring an actor runs game code, which may flush or cancel the queue
+	RestoreQueue = Queue;
+	while (RestoreQueue == Queue && Queue->NextItem < NumPlayableItems)
+		RestoreItem(Queue->Items[Queue->NextItem++], *Queue->Resolver);
+
+	UE_LOG(LogEss, Log, TEXT("World playable, %d actors left to restore."), Queue->Items.Num() - Queue->NextItem);
+	OnPlayable.ExecuteIfBound(true);
+
+	if (RestoreQueue != Queue)
+		return;
+
+	if (Queue->NextItem >= Queue->Items.Num())
+		FinishRestoreQueue(true);
+	else
+		Queue->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UEssSubsystem::TickRestoreQueue));
+}
+
+bool UEssSubsystem::TickRestoreQueue(float DeltaTime)
+{
+	ESS_SCOPE_CYCLE_COUNTER(STAT_EssTickRestoreQueue);
+
+	// Holds the queue while its actors are restored, in case game code finishes it in the meantime
+	TSharedPtr<FEssRestoreQueue> Queue = RestoreQueue;
+	if (!Queue)
+		return false;
+
+	// At least one actor is restored per frame, so the queue drains even with a tiny budget
+	const double EndTime = FPlatformTime::Seconds() + GetDefault<UEssSettings>()->RestoreBudgetMs / 1000.0;
+	do
+	{
+		if (Queue->NextItem < Queue->Items.Num())
+			RestoreItem(Queue->Items[Queue->NextItem++], *Queue->Resolver);
+	}
+	while (RestoreQueue == Queue && Queue->NextItem < Queue->Items.Num() && FPlatformTime::Seconds() < EndTime);
+
+	if (RestoreQueue == Queue && Queue->NextItem >= Queue->Items.Num())
+		FinishRestoreQueue(true);
+
+	return RestoreQueue == Queue;
+}
+
+void UEssSubsystem::FlushRestoreQueue()
+{
+	TSharedPtr<FEssRestoreQueue> Queue = RestoreQueue;
+	if (!Queue)
+		return;
+
+	while (RestoreQueue == Queue && Queue->NextItem < Queue->Items.Num())
+		RestoreItem(Queue->Items[Queue->NextItem++], *Queue->Resolver);
+
+	if (RestoreQueue == Queue)
+		FinishRestoreQueue(true);
+}
+
+void UEssSubsystem::FinishRestoreQueue(const bool bSucceeded)
+{
+	TSharedPtr<FEssRestoreQueue> Queue = MoveTemp(RestoreQueue);
+	if (!Queue)
+		return;
+
+	if (Queue->TickerHandle.IsValid())
+		FTSTicker::GetCoreTicker().RemoveTicker(Queue->TickerHandle);
+
+	FEssOperationTiming& Timing = Queue->Timing;
+	Timing.bSucceeded = bSucceeded;
+	Timing.DurationMs = (FPlatformTime::Seconds() - Queue->StartTime) * 1000.0;
+	FEssStats::Get().RecordTiming(Timing);
+
+	if (bSucceeded)
+		UE_LOG(LogEss, Log, TEXT("World loaded."));
+	else if (Queue->NextItem < Queue->Items.Num())
+		UE_LOG(LogEss, Warning, TEXT("World not loaded. Restore was cancelled with %d actors left."), Queue->Items.Num() - Queue->NextItem);
+
+	FEssWorldLoadedDelegate OnLoaded;
+	LoadingSlots.RemoveAndCopyValue(Timing.SlotName, OnLoaded);
+	OnLoaded.ExecuteIfBound(bSucceeded);
 }
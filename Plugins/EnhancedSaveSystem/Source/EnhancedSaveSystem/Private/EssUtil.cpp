@@ -1,8 +1,13 @@
 // Copyright 2023 devran. All Rights Reserved.
 
 #include "EssUtil.h"
+#include "EssSaveData.h"
+#include "EssStats.h"
+#include "Algo/BinarySearch.h"
 #include "GameFramework/GameModeBase.h"
 #include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
 #include "GameFramework/PlayerState.h"
 
 bool EssUtil::IsRuntimeActor(const AActor* Actor)
@@ -16,7 +21,7 @@ FGuid EssUtil::GetGuid(const UObject* Obj)
 	if (Prop)
 		return *Prop->ContainerPtrToValuePtr<FGuid>(Obj);
 
-	UE_LOG(LogTemp, Warning, TEXT("Object %s has no EssGuid property and can therefore not be saved."), *Obj->GetFName().ToString());
+	UE_LOG(LogEss, Warning, TEXT("Object %s has no EssGuid property and can therefore not be saved."), *Obj->GetFName().ToString());
 	FGuid Guid = FGuid::NewGuid();
 	Guid.Invalidate();
 	return Guid;
@@ -32,7 +37,7 @@ bool EssUtil::SetGuid(UObject* Obj, const FGuid& NewGuid)
 	FProperty* Prop = GetGuidProperty(Obj);
 	if (!Prop)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Object %s has no EssGuid property and can therefore not be saved."), *Obj->GetFName().ToString());
+		UE_LOG(LogEss, Warning, TEXT("Object %s has no EssGuid property and can therefore not be saved."), *Obj->GetFName().ToString());
 		return false;
 	}
 
@@ -57,8 +62,116 @@ FString EssUtil::GetLevelName(const ULevel* Level)
 	return Level->GetOutermost()->GetName();
 }
 
+APlayerState* EssUtil::GetOwningPlayerState(AActor* Actor)
+{
+	for (AActor* Owner = Actor; Owner; Owner = Owner->GetOwner())
+	{
+		if (APlayerState* PlayerState = Cast<APlayerState>(Owner))
+			return PlayerState;
+
+		if (const APlayerController* PlayerController = Cast<APlayerController>(Owner))
+			return PlayerController->PlayerState;
+
+		if (const APawn* Pawn = Cast<APawn>(Owner))
+		{
+			if (APlayerState* PlayerState = Pawn->GetPlayerState())
+				return PlayerState;
+		}
+	}
+
+	return nullptr;
+}
+
+FEssLevelData EssUtil::GetLevelHeader(const FEssLevelData& LevelData)
+{
+	FEssLevelData Header;
+	for (TFieldIterator<FProperty> It(FEssLevelData::StaticStruct()); It; ++It)
+	{
+		const FName PropertyName = It->GetFName();
+		if (PropertyName != GET_MEMBER_NAME_CHECKED(FEssLevelData, RuntimeActorsData) &&
+			PropertyName != GET_MEMBER_NAME_CHECKED(FEssLevelData, PlacedActorsData))
+		{
+			It->CopyCompleteValue_InContainer(&Header, &LevelData);
+		}
+	}
+
+	return Header;
+}
+
+void EssUtil::PruneObjectReferences(FEssLevelData& LevelData)
+{
+	TBitArray<> Used(false, LevelData.ObjectReferences.Num());
+	auto MarkUsed = [&Used](const TArray<int32>& ReferenceIndices)
+	{
+		for (const int32 Index : ReferenceIndices)
+		{
+			if (Used.IsValidIndex(Index))
+				Used[Index] = true;
+		}
+	};
+
+	for (const FEssRuntimeActorData& ActorData : LevelData.RuntimeActorsData)
+		MarkUsed(ActorData.ReferenceIndices);
+
+	for (const auto& PlacedPair : LevelData.PlacedActorsData)
+		MarkUsed(PlacedPair.Value.ReferenceIndices);
+
+	// Entries are emptied rather than removed, records refer to the other entries by their index
+	for (int32 Index = 0; Index < LevelData.ObjectReferences.Num(); ++Index)
+	{
+		if (!Used[Index])
+			LevelData.ObjectReferences[Index] = FEssObjectReference();
+	}
+
+	LevelData.ObjectReferences.SetNum(Used.FindLast(true) + 1);
+}
+
 void EssUtil::SetGuid(UObject* Obj, const FGuid& NewGuid, FProperty* Prop)
 {
 	FGuid* GuidPtr = Prop->ContainerPtrToValuePtr<FGuid>(Obj);
 	*GuidPtr = NewGuid;
 }
+
+UClass* EssUtil::GetLoadedClass(const TSoftClassPtr<AActor>& Class)
+{
+	if (UClass* LoadedClass = Class.Get())
+		return LoadedClass;
+
+	if (Class.IsNull())
+		return nullptr;
+
+	UE_LOG(LogEss, Verbose, TEXT("Class %s was not preloaded and is loaded synchronously."), *Class.ToString());
+
+	UClass* LoadedClass = Class.LoadSynchronous();
+	if (!LoadedClass)
+		UE_LOG(LogEss, Warning, TEXT("Class %s could not be loaded."), *Class.ToString());
+
+	return LoadedClass;
+}
+
+void EssUtil::GetUnloadedClasses(const FEssLevelData& LevelData, TSet<FSoftObjectPath>& OutClassPaths)
+{
+	for (const FEssRuntimeActorData& ActorData : LevelData.RuntimeActorsData)
+	{
+		if (!ActorData.Class.IsNull() && !ActorData.Class.Get())
+			OutClassPaths.Add(ActorData.Class.ToSoftObjectPath());
+	}
+
+	for (const auto& PlacedPair : LevelData.PlacedActorsData)
+	{
+		if (!PlacedPair.Value.Class.IsNull() && !PlacedPair.Value.Class.Get())
+			OutClassPaths.Add(PlacedPair.Value.Class.ToSoftObjectPath());
+	}
+}
+
+void EssUtil::GetUnloadedClasses(const FEssWorldData& WorldData, TSet<FSoftObjectPath>& OutClassPaths)
+{
+	for (const auto& LevelPair : WorldData.LevelsData)
+		GetUnloadedClasses(LevelPair.Value, OutClassPaths);
+}
+
+const FEssComponentData* EssUtil::FindComponentData(const TArray<FEssComponentData>& ComponentsData, const FName Name)
+{
+	const int32 Index = Algo::LowerBoundBy(ComponentsData, Name, &FEssComponentData::Name, FNameLexicalLess());
+	return ComponentsData.IsValidIndex(Index) && ComponentsData[Index].Name == Name ? &ComponentsData[Index] : nullptr;
+}
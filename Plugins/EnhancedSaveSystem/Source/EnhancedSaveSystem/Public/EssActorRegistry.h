@@ -0,0 +1,150 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "EssSaveArchive.h"
+#include "EssSaveData.h"
+
+class AActor;
+class ULevel;
+class UActorComponent;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Savable instanced static mesh component of a level with the instances it had when the level was registered.
+ */
+struct FEssInstanceComponent
+{
+	TWeakObjectPtr<UInstancedStaticMeshComponent> Component;
+
+	/** Level-authored instances, packed like FEssInstancesData::AddedInstances. */
+	TArray<float> AuthoredInstances;
+
+	/** Indices of the level-authored instances by the hash of their packed floats. */
+	TMultiMap<uint32, int32> AuthoredLookup;
+};
+
+/**
+ * Savable actors of a single level, kept contiguous for iteration.
+ */
+struct FEssLevelActors
+{
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TMap<TObjectKey<AActor>, int32> Indices;
+
+	/** Key of each actor, parallel to Actors, so that indices stay correct for actors which have already been garbage collected. */
+	TArray<TObjectKey<AActor>> Keys;
+
+	/** Owner each actor is indexed under, parallel to Actors. */
+	TArray<TObjectKey<AActor>> Owners;
+
+	/** State of the level's placed actors when the level was registered, used to elide unchanged placed actors. */
+	TOptional<TMap<FName, FEssPlacedActorData>> PlacedActorBaselines;
+
+	/** Reference table the baselines refer to by index. Placed actors compared against their baselines add their references to it as well. */
+	FEssReferenceTable PlacedActorBaselineReferences;
+
+	/** Frame in which the baselines were captured, until something is restored into the level. */
+	uint64 BaselineFrame = MAX_uint64;
+
+	TArray<FEssInstanceComponent> InstanceComponents;
+};
+
+/**
+ * Live per-level registry of actors which implement EssSavableInterface.
+ * Kept up to date from level add/remove and actor spawn/destroy events so that saving and loading
+ * only touch savable actors instead of scanning every actor of a level.
+ */
+class ENHANCEDSAVESYSTEM_API FEssActorRegistry
+{
+public:
+	/**
+	 * Registers a level and all of its savable actors. Does nothing if the level is already registered.
+	 * @return Level newly registered.
+	 */
+	bool AddLevel(ULevel* Level);
+	void RemoveLevel(const ULevel* Level);
+	bool ContainsLevel(const ULevel* Level) const;
+
+	void AddActor(AActor* Actor);
+	void RemoveActor(const AActor* Actor);
+	bool ContainsActor(const AActor* Actor) const;
+
+	/**
+	 * Moves actors whose owner has changed since they were indexed to their new owner.
+	 * Actors don't report owner changes, so this compares the owner of every registered actor. Call before querying owners.
+	 */
+	void RefreshOwners();
+
+	/**
+	 * Gets the valid actors which own at least one registered actor.
+	 */
+	void GetOwners(TArray<AActor*>& OutOwners) const;
+
+	/**
+	 * Gets the valid registered actors directly owned by the actor.
+	 */
+	void GetOwnedActors(const AActor* Owner, TArray<AActor*>& OutActors) const;
+
+	void Reset();
+
+	/**
+	 * Copies the valid savable actors of a level. A copy is returned so that callers can destroy and spawn actors while iterating.
+	 */
+	void GetActors(const ULevel* Level, TArray<AActor*>& OutActors) const;
+
+	int32 GetNumActors(const ULevel* Level) const;
+	int32 GetNumActors() const;
+	int32 GetNumLevels() const { return Levels.Num(); }
+
+	void SetPlacedActorBaselines(const ULevel* Level, TMap<FName, FEssPlacedActorData>&& Baselines, FEssReferenceTable&& References);
+
+	/**
+	 * @return Null if no baselines have been captured for the level.
+	 */
+	const TMap<FName, FEssPlacedActorData>* GetPlacedActorBaselines(const ULevel* Level) const;
+
+	/**
+	 * @return Null if no baselines have been captured for the level.
+	 */
+	FEssReferenceTable* GetPlacedActorBaselineReferences(const ULevel* Level);
+
+	/**
+	 * @return The level's baselines were captured during this frame and nothing has been restored into the level since,
+	 * so its placed actors still match their baselines.
+	 */
+	bool MatchesPlacedActorBaselines(const ULevel* Level) const;
+
+	/**
+	 * Called whenever save data is restored into an actor of the level.
+	 */
+	void MarkRestored(const ULevel* Level);
+
+	void SetInstanceComponents(const ULevel* Level, TArray<FEssInstanceComponent>&& InstanceComponents);
+
+	/**
+	 * @return Null if the level isn't registered.
+	 */
+	const TArray<FEssInstanceComponent>* GetInstanceComponents(const ULevel* Level) const;
+
+	static bool IsSavable(const AActor* Actor);
+
+	/**
+	 * Calls the function for every valid component of the actor which implements EssSavableInterface, without allocating.
+	 * Whether a component class implements the interface is looked up once per class.
+	 */
+	void ForEachSavableComponent(const AActor* Actor, TFunctionRef<void(UActorComponent*)> Function);
+
+private:
+	void AddOwnedActor(const TObjectKey<AActor> Owner, const TObjectKey<AActor> Actor);
+	void RemoveOwnedActor(const TObjectKey<AActor> Owner, const TObjectKey<AActor> Actor);
+
+	TMap<TObjectKey<ULevel>, FEssLevelActors> Levels;
+
+	/** Registered actors by their owner, so actors of an owner can be found without going through every actor. */
+	TMap<TObjectKey<AActor> /*Owner*/, TArray<TObjectKey<AActor>>> OwnedActors;
+
+	TMap<TObjectKey<UClass>, bool> SavableComponentClasses;
+};
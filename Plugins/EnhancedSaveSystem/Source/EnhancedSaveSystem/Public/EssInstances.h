@@ -0,0 +1,54 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FEssInstanceComponent;
+struct FEssInstancesData;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Bulk save and restore of the instances of instanced static mesh components.
+ * Instances are compared against the ones a component had when its level was loaded, so only the removed level-authored
+ * instances and the new or moved instances are stored. A component is restored with one batched removal and one batched addition.
+ */
+class ENHANCEDSAVESYSTEM_API FEssInstances
+{
+public:
+	/** Floats per packed instance: location, rotation quaternion, and scale. */
+	static constexpr int32 NumPackedFloats = 10;
+
+	/** Component tag which makes ESS save the instances of an instanced static mesh component of a placed actor. */
+	static const FName ComponentTag;
+
+	static bool IsSavable(const UInstancedStaticMeshComponent* Component);
+
+	/**
+	 * Captures the component's current instances as its level-authored ones.
+	 */
+	static FEssInstanceComponent CaptureAuthored(UInstancedStaticMeshComponent* Component);
+
+	/**
+	 * @return False if the component still has exactly its level-authored instances.
+	 */
+	static bool Extract(const FEssInstanceComponent& InstanceComponent, FEssInstancesData& OutData);
+
+	/**
+	 * Restores the component's instances from a record, or its level-authored instances if there is no record.
+	 * @return Number of instances the component has afterwards. INDEX_NONE if the component was left untouched.
+	 */
+	static int32 Restore(const FEssInstanceComponent& InstanceComponent, const FEssInstancesData* Data);
+
+private:
+	static void PackInstances(const UInstancedStaticMeshComponent* Component, TArray<float>& OutInstances);
+	static void BuildLookup(const TArray<float>& Instances, TMultiMap<uint32, int32>& OutLookup);
+
+	/**
+	 * Matches the instances of From against the ones of To. Collects the indices of the instances of either side without a match.
+	 */
+	static void MatchInstances(const TArray<float>& From, const TArray<float>& To, const TMultiMap<uint32, int32>& ToLookup,
+		TArray<int32>& OutUnmatchedFrom, TArray<int32>& OutUnmatchedTo);
+
+	static uint32 HashInstance(const float* Instance);
+};
@@ -0,0 +1,30 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FEssMassArchetypeData;
+struct FEssWorldData;
+class UWorld;
+
+/**
+ * Bulk save and restore of Mass entities.
+ * Entities are saved per archetype, one column per saved fragment type. Columns of plain old data are copied chunk by chunk
+ * with a single memory copy, and entities are recreated per archetype with a single batched creation.
+ */
+class ENHANCEDSAVESYSTEM_API FEssMass
+{
+public:
+	/**
+	 * Saves all entities of the world which have any of the fragment types listed in MassFragments of the settings.
+	 * @return Number of saved entities. INDEX_NONE if no fragment types are saved or the world has no Mass entities.
+	 */
+	static int32 Extract(UWorld* World, TArray<FEssMassArchetypeData>& OutArchetypesData);
+
+	/**
+	 * Destroys all entities of the world which have any of the saved fragment types and recreates the saved ones of the world data.
+	 * @return Number of recreated entities. INDEX_NONE if the entities were left untouched.
+	 */
+	static int32 Restore(UWorld* World, const FEssWorldData& WorldData);
+};
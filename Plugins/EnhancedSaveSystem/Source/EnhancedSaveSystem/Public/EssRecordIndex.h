@@ -0,0 +1,149 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "EssRecordIndex.generated.h"
+
+struct FEssSaveData;
+struct FEssLevelData;
+class IEssStorageBackend;
+
+UENUM(BlueprintType)
+enum class EEssRecordKind : uint8
+{
+	RuntimeActor,
+	PlacedActor,
+	GlobalObject,
+	Level
+};
+
+/**
+ * Information about a single record of a slot, read without restoring it.
+ */
+USTRUCT(BlueprintType)
+struct ENHANCEDSAVESYSTEM_API FEssRecordInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Enhanced Save System")
+	EEssRecordKind Kind = EEssRecordKind::RuntimeActor;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Enhanced Save System")
+	FString LevelName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Enhanced Save System")
+	FString Key;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Enhanced Save System")
+	TSoftClassPtr<UObject> Class;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Enhanced Save System")
+	FTransform Transform;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Enhanced Save System")
+	int64 ByteSize = 0;
+};
+
+struct FEssRecordIndexEntry
+{
+	EEssRecordKind Kind = EEssRecordKind::RuntimeActor;
+	FString World;
+	FString Level;
+	FString Key;
+	FString ClassPath;
+
+	/** Range of the record in the slot. Spans all actor records of a level record. */
+	int64 Offset = 0;
+	int64 Size = 0;
+
+	/** Range of the level header in the index, for level records. */
+	int64 HeaderOffset = 0;
+	int64 HeaderSize = 0;
+
+	/** Number of actor records of a level record, which directly follow it in the entry table. */
+	int32 NumRecords = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FEssRecordIndexEntry& Entry);
+};
+
+/**
+ * Record index written through the storage backend next to a slot, as slot <SlotName>.essidx of the same user.
+ * Holds the range of every record within the slot, so a single actor, level or global object can be read and decoded
+ * without reading the whole slot. Records aren't copied into the index, only the level headers are.
+ *
+ * Layout: header (magic, version, entry table offset and size, write GUID of the slot and its offset in the slot),
+ * level headers, entry table.
+ */
+class ENHANCEDSAVESYSTEM_API FEssRecordIndex
+{
+public:
+	static FString GetSlotName(const FString& SlotName);
+
+	/**
+	 * Writes the index for the save data of a slot. Safe to call off the game thread.
+	 * @param WriteGuid WriteGuid of the save game written to the slot, so the index can be matched against the slot when it's opened.
+	 * @param SlotBytes The bytes written to the slot, which the records are looked up in.
+	 * @return False if a record couldn't be found in the slot.
+	 */
+	static bool Write(const FString& SlotName, const int32 UserIndex, const FEssSaveData& SaveData, const FGuid& WriteGuid, const TArray<uint8>& SlotBytes);
+	static void Delete(const FString& SlotName, const int32 UserIndex);
+
+	/**
+	 * Reads the entry table of a slot's index and checks the write GUID of the slot against the index.
+	 * Only the index header, the entry table and the write GUID are read, unless the backend can't read ranges.
+	 * @return Null if the slot has no valid index, or if the slot was written without updating its index.
+	 */
+	static TSharedPtr<FEssRecordIndex> Open(const FString& SlotName, const int32 UserIndex);
+
+	const FEssRecordIndexEntry* Find(const EEssRecordKind Kind, const FString& World, const FString& Level, const FString& Key) const;
+
+	/**
+	 * Reads the range of a record from the slot.
+	 */
+	bool ReadBytes(const FEssRecordIndexEntry& Entry, TArray<uint8>& OutBytes) const;
+	bool ReadLevel(const FEssRecordIndexEntry& Entry, FEssLevelData& OutLevelData) const;
+
+	/**
+	 * Reads a level record without its actor records.
+	 */
+	bool ReadLevelHeader(const FEssRecordIndexEntry& Entry, FEssLevelData& OutLevelHeader) const;
+
+	template <typename StructType>
+	bool ReadRecord(const FEssRecordIndexEntry& Entry, StructType& OutRecord, const bool bLoadIfFindFails = true) const
+	{
+		TArray<uint8> Bytes;
+		if (!ReadBytes(Entry, Bytes))
+			return false;
+
+		FMemoryReader MemoryReader(Bytes, true);
+		FObjectAndNameAsStringProxyArchive Archive(MemoryReader, bLoadIfFindFails);
+		StructType::StaticStruct()->SerializeItem(Archive, &OutRecord, nullptr);
+		return !Archive.IsError();
+	}
+
+private:
+	static FString MakeLookupKey(const EEssRecordKind Kind, const FString& World, const FString& Level, const FString& Key);
+
+	/**
+	 * Reads a range of the slot or the index, out of its cached bytes if the backend can't read ranges.
+	 */
+	bool ReadRange(const FString& RangeSlotName, const TArray<uint8>& CachedBytes, const int64 Offset, const int64 Size, TArray<uint8>& OutBytes) const;
+
+	TSharedPtr<IEssStorageBackend> Storage;
+	FString SlotName;
+	FString IndexSlotName;
+	int32 UserIndex = 0;
+
+	/**
+	 * The whole slot and index, if the backend can't read ranges. The slot has to be read to check its write GUID then,
+	 * so it's kept for the records instead of reading it again for each of them.
+	 */
+	TArray<uint8> SlotData;
+	TArray<uint8> IndexData;
+
+	TArray<FEssRecordIndexEntry> Entries;
+	TMap<FString, int32> Lookup;
+};
@@ -0,0 +1,115 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "EssSaveData.h"
+
+class FEssActorRegistry;
+
+/**
+ * Resolves the object references of actor records against the current world.
+ * Lookups are cached, so every referenced actor or asset is only searched for once per load.
+ * Cached objects are held weakly, so a resolver can be kept across frames while a restore is spread over several of them.
+ */
+class ENHANCEDSAVESYSTEM_API FEssReferenceResolver
+{
+public:
+	FEssReferenceResolver(UWorld* InWorld, const FEssActorRegistry& InActorRegistry);
+
+	/**
+	 * Resolves a level's reference table in one pass. Call after all actors of the load have been spawned.
+	 * The resolved objects are kept by the table's address, so the table has to outlive the resolver.
+	 */
+	void Resolve(const TArray<FEssObjectReference>& References);
+
+	/**
+	 * Finds the object of an entry of a level's reference table, from the objects resolved for the table if it has been resolved.
+	 * @return Null if the index is out of range or the referenced object doesn't exist.
+	 */
+	UObject* Find(const TArray<FEssObjectReference>& References, const int32 Index);
+
+	/**
+	 * @return Null if the referenced object doesn't exist.
+	 */
+	UObject* Find(const FEssObjectReference& Reference);
+
+private:
+	AActor* FindRuntimeActor(const FGuid& Guid);
+	AActor* FindPlacedActor(const FString& LevelName, const FName Name);
+	UObject* FindAsset(const FSoftObjectPath& Path);
+
+	UWorld* World;
+	const FEssActorRegistry& ActorRegistry;
+
+	bool bRuntimeActorsGathered = false;
+	TMap<FGuid, TWeakObjectPtr<AActor>> RuntimeActors;
+	TMap<FString, TWeakObjectPtr<ULevel>> Levels;
+	TMap<FSoftObjectPath, TWeakObjectPtr<UObject>> Assets;
+
+	/** Objects of the resolved reference tables, by index. */
+	TMap<const TArray<FEssObjectReference>*, TArray<TWeakObjectPtr<UObject>>> ResolvedTables;
+};
+
+/**
+ * Reference table of a level while its records are written. Records refer to its entries by index.
+ */
+struct ENHANCEDSAVESYSTEM_API FEssReferenceTable
+{
+	FEssReferenceTable() = default;
+
+	/**
+	 * Continues a table, e.g. of level data records are merged into. Its empty entries are reused.
+	 */
+	explicit FEssReferenceTable(const TArray<FEssObjectReference>& InReferences);
+
+	/**
+	 * @return Index of the reference, which is added if the table doesn't hold it yet.
+	 */
+	int32 Add(const FEssObjectReference& Reference);
+
+	const TArray<FEssObjectReference>& GetReferences() const { return References; }
+
+private:
+	TArray<FEssObjectReference> References;
+	TMap<FEssObjectReference, int32> Indices;
+	TArray<int32> FreeIndices;
+};
+
+/**
+ * Archive for the SaveGame properties of actors.
+ * References to savable actors and assets are added to the level's reference table and written as their index instead of an object path.
+ * Records written before reference tables were added, which hold object paths, are still read like before.
+ */
+struct ENHANCEDSAVESYSTEM_API FEssSaveArchive : public FObjectAndNameAsStringProxyArchive
+{
+	/**
+	 * Archive for saving.
+	 * @param InReferences Table the written references are added to.
+	 * @param OutReferenceIndices Indices of the written references, each added once.
+	 */
+	FEssSaveArchive(FArchive& InInnerArchive, FEssReferenceTable& InReferences, TArray<int32>& OutReferenceIndices);
+
+	/**
+	 * Archive for loading.
+	 * @param InReferences Reference table of the level the record belongs to.
+	 */
+	FEssSaveArchive(FArchive& InInnerArchive, FEssReferenceResolver& InResolver, const TArray<FEssObjectReference>& InReferences);
+
+	using FObjectAndNameAsStringProxyArchive::operator<<;
+	virtual FArchive& operator<<(UObject*& Obj) override;
+	virtual FArchive& operator<<(FObjectPtr& Obj) override;
+
+	/**
+	 * Makes the reference an object is written as. Doesn't change the object.
+	 * @return False if the object is written as a path, e.g. a runtime actor without a GUID.
+	 */
+	static bool MakeReference(UObject* Obj, FEssObjectReference& OutReference);
+
+private:
+	FEssReferenceTable* WrittenReferences = nullptr;
+	TArray<int32>* WrittenReferenceIndices = nullptr;
+	FEssReferenceResolver* Resolver = nullptr;
+	const TArray<FEssObjectReference>* ReadReferences = nullptr;
+};
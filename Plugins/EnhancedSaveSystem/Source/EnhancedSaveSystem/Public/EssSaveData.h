@@ -17,16 +17,46 @@ struct FEssSaveSlotData
 	FDateTime DateTimeOfSave;
 };
 
+/**
+ * SaveGame properties of a single savable component of an actor, keyed by the component's name.
+ */
 USTRUCT()
-struct FEssRuntimeActorData
+struct ENHANCEDSAVESYSTEM_API FEssComponentData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FName Name;
+
+	UPROPERTY()
+	TArray<uint8> ByteData;
+
+	bool operator==(const FEssComponentData& Other) const
+	{
+		return Name == Other.Name && ByteData == Other.ByteData;
+	}
+
+	static int32 GetNumBytes(const TArray<FEssComponentData>& ComponentsData)
+	{
+		int32 NumBytes = 0;
+		for (const FEssComponentData& ComponentData : ComponentsData)
+			NumBytes += ComponentData.ByteData.Num();
+
+		return NumBytes;
+	}
+};
+
+USTRUCT()
+struct ENHANCEDSAVESYSTEM_API FEssRuntimeActorData
 {
 	GENERATED_BODY()
 
 	UPROPERTY()
 	FGuid Guid;
 
+	/** Soft so that reading a slot doesn't load every saved class. Classes are streamed in before actors are respawned. */
 	UPROPERTY()
-	TSubclassOf<AActor> Class;
+	TSoftClassPtr<AActor> Class;
 
 	UPROPERTY()
 	FTransform Transform;
@@ -34,11 +64,29 @@ struct FEssRuntimeActorData
 	UPROPERTY()
 	TArray<uint8> ByteData;
 
+	/** Savable components sorted by name. Records written before components were keyed hold them in ByteData, after the actor's properties. */
+	UPROPERTY()
+	TArray<FEssComponentData> ComponentsData;
+
+	/** Indices into the level's ObjectReferences which ByteData and ComponentsData refer to. */
+	UPROPERTY()
+	TArray<int32> ReferenceIndices;
+
 	bool operator==(const FEssRuntimeActorData& Other)
 	{
 		return Guid == Other.Guid;
 	}
 
+	bool HasSameState(const FEssRuntimeActorData& Other) const
+	{
+		return Class == Other.Class && Transform.Equals(Other.Transform, 0.0) && ByteData == Other.ByteData && ComponentsData == Other.ComponentsData;
+	}
+
+	int32 GetNumBytes() const
+	{
+		return ByteData.Num() + FEssComponentData::GetNumBytes(ComponentsData);
+	}
+
 	operator bool()
 	{
 		return Guid.IsValid();
@@ -54,7 +102,7 @@ struct ENHANCEDSAVESYSTEM_API FEssPlacedActorData
 	FName Name;
 
 	UPROPERTY()
-	TSubclassOf<AActor> Class;
+	TSoftClassPtr<AActor> Class;
 
 	UPROPERTY()
 	FTransform Transform;
@@ -62,19 +110,111 @@ struct ENHANCEDSAVESYSTEM_API FEssPlacedActorData
 	UPROPERTY()
 	TArray<uint8> ByteData;
 
+	/** Savable components sorted by name. Records written before components were keyed hold them in ByteData, after the actor's properties. */
+	UPROPERTY()
+	TArray<FEssComponentData> ComponentsData;
+
+	/** Indices into the level's ObjectReferences which ByteData and ComponentsData refer to. */
+	UPROPERTY()
+	TArray<int32> ReferenceIndices;
+
 	bool operator==(const FEssPlacedActorData& Other) const
 	{
 		return Name == Other.Name;
 	}
 
+	bool HasSameState(const FEssPlacedActorData& Other) const
+	{
+		return Class == Other.Class && Transform.Equals(Other.Transform, 0.0) && ByteData == Other.ByteData && ComponentsData == Other.ComponentsData;
+	}
+
+	int32 GetNumBytes() const
+	{
+		return ByteData.Num() + FEssComponentData::GetNumBytes(ComponentsData);
+	}
+
 	operator bool()
 	{
 		return Name.IsValid();
 	}
 };
 
+/**
+ * Object referenced from a SaveGame property of a saved actor.
+ * Savable actors are referenced by their saved GUID (runtime actors) or their level and name (placed actors), so the
+ * reference still resolves after the referenced actor has been respawned. Other objects are referenced by path.
+ */
+USTRUCT()
+struct ENHANCEDSAVESYSTEM_API FEssObjectReference
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FGuid Guid;
+
+	UPROPERTY()
+	FString LevelName;
+
+	UPROPERTY()
+	FName Name;
+
+	UPROPERTY()
+	FSoftObjectPath Path;
+
+	bool operator==(const FEssObjectReference& Other) const
+	{
+		return Guid == Other.Guid && LevelName == Other.LevelName && Name == Other.Name && Path == Other.Path;
+	}
+
+	bool operator!=(const FEssObjectReference& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	/** Empty entries of a reference table are no longer referred to by any record. */
+	bool IsNull() const
+	{
+		return !Guid.IsValid() && LevelName.IsEmpty() && Path.IsNull();
+	}
+
+	friend uint32 GetTypeHash(const FEssObjectReference& Reference)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Reference.Guid), GetTypeHash(Reference.Name));
+		Hash = HashCombine(Hash, GetTypeHash(Reference.LevelName));
+		return HashCombine(Hash, GetTypeHash(Reference.Path));
+	}
+};
+
+/**
+ * Instances of an instanced static mesh component of a placed actor, stored relative to the instances the component had when its level was loaded.
+ * Instances are packed as FEssInstances::NumPackedFloats floats: location, rotation quaternion, and scale.
+ */
+USTRUCT()
+struct ENHANCEDSAVESYSTEM_API FEssInstancesData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FName ActorName;
+
+	UPROPERTY()
+	FName ComponentName;
+
+	/** Number of level-authored instances RemovedInstances refers to. */
+	UPROPERTY()
+	int32 NumAuthoredInstances = 0;
+
+	/** Indices of level-authored instances which no longer exist, ascending. */
+	UPROPERTY()
+	TArray<int32> RemovedInstances;
+
+	/** Instances which aren't level-authored or have been moved. */
+	UPROPERTY()
+	TArray<float> AddedInstances;
+};
+
 USTRUCT()
-struct FEssGlobalObjectData
+struct ENHANCEDSAVESYSTEM_API FEssGlobalObjectData
 {
 	GENERATED_BODY()
 
@@ -98,6 +238,26 @@ struct FEssGlobalObjectData
 	}
 };
 
+/**
+ * Actor records of a level whose saved location lies within a single cell of the level's spatial grid.
+ */
+USTRUCT()
+struct ENHANCEDSAVESYSTEM_API FEssGridCellData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FIntPoint Cell = FIntPoint::ZeroValue;
+
+	/** Indices into RuntimeActorsData. */
+	UPROPERTY()
+	TArray<int32> RuntimeActors;
+
+	/** Keys of PlacedActorsData. */
+	UPROPERTY()
+	TArray<FName> PlacedActors;
+};
+
 USTRUCT()
 struct ENHANCEDSAVESYSTEM_API FEssLevelData
 {
@@ -111,6 +271,77 @@ struct ENHANCEDSAVESYSTEM_API FEssLevelData
 
 	UPROPERTY()
 	TMap<FName, FEssPlacedActorData> PlacedActorsData;
+
+	/** Placed actors which still match their level-authored state aren't stored in PlacedActorsData. */
+	UPROPERTY()
+	bool bDefaultPlacedActorsElided = false;
+
+	/** Names of placed actors which have been destroyed. Only used if bDefaultPlacedActorsElided is set. */
+	UPROPERTY()
+	TArray<FName> DestroyedPlacedActors;
+
+	/**
+	 * Every object referenced by the level's actor records, which refer to them by index. Resolved in one pass after the level's actors have been spawned.
+	 * Entries no record refers to anymore are left empty, so the indices of the other entries stay valid.
+	 */
+	UPROPERTY()
+	TArray<FEssObjectReference> ObjectReferences;
+
+	/** Savable instanced static mesh components whose instances differ from their level-authored ones. */
+	UPROPERTY()
+	TArray<FEssInstancesData> InstancesData;
+
+	/** Edge length of the cells of GridCells. Zero if the level has no spatial grid. */
+	UPROPERTY()
+	float GridCellSize = 0.f;
+
+	/** Spatial grid of the actor records by their saved location. Only cells holding records are stored. */
+	UPROPERTY()
+	TArray<FEssGridCellData> GridCells;
+};
+
+/**
+ * A single fragment type of the saved Mass entities of an archetype, stored as one column with a value per entity.
+ */
+USTRUCT()
+struct ENHANCEDSAVESYSTEM_API FEssMassFragmentData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FSoftObjectPath Struct;
+
+	/** Columns of plain old data are copied as raw bytes and only read back if the struct still has the same size. */
+	UPROPERTY()
+	bool bRawBytes = false;
+
+	UPROPERTY()
+	int32 StructSize = 0;
+
+	UPROPERTY()
+	TArray<uint8> ByteData;
+};
+
+/**
+ * Saved Mass entities sharing an archetype. The archetype is recreated from its fragment and tag types.
+ */
+USTRUCT()
+struct ENHANCEDSAVESYSTEM_API FEssMassArchetypeData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FSoftObjectPath> FragmentTypes;
+
+	UPROPERTY()
+	TArray<FSoftObjectPath> TagTypes;
+
+	UPROPERTY()
+	int32 NumEntities = 0;
+
+	/** Columns of the fragment types listed in MassFragments of the settings. */
+	UPROPERTY()
+	TArray<FEssMassFragmentData> FragmentsData;
 };
 
 USTRUCT()
@@ -123,6 +354,13 @@ struct ENHANCEDSAVESYSTEM_API FEssWorldData
 
 	UPROPERTY()
 	TMap<FString /*Level name*/, FEssLevelData> LevelsData;
+
+	UPROPERTY()
+	TArray<FEssMassArchetypeData> MassArchetypesData;
+
+	/** Mass entities were saved with the world. Loading then replaces the current entities, even if none were saved. */
+	UPROPERTY()
+	bool bMassEntitiesSaved = false;
 };
 
 USTRUCT()
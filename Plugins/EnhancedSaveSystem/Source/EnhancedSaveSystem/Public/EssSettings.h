@@ -0,0 +1,98 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "EssSettings.generated.h"
+
+/**
+ * Project settings of the Enhanced Save System.
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Enhanced Save System"))
+class ENHANCEDSAVESYSTEM_API UEssSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UEssSettings();
+
+	/**
+	 * Writes a record index file next to each slot whenever the slot is saved.
+	 * Allows single actors, levels, and global objects to be loaded by reading only their own bytes instead of the whole slot.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Storage")
+	bool bWriteRecordIndex = false;
+
+	/**
+	 * Doesn't save placed actors whose transform and SaveGame properties still match the state they had when their level was loaded.
+	 * Destroyed placed actors are saved as a list of names instead. Placed actors are reset to their loaded state when a save without their record is loaded.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Storage")
+	bool bElideDefaultPlacedActors = false;
+
+	/**
+	 * Backend slots are read from and written to. SaveGame uses the platform's save game system, IoUring writes slot files through io_uring on Linux.
+	 * Backends registered by the game can be selected as well. Can be switched at runtime with the Ess.StorageBackend console command.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Storage")
+	FName StorageBackend = TEXT("SaveGame");
+
+	/**
+	 * Maximum number of chunk writes, syncs, and renames the IoUring backend has in flight at once.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Storage", meta = (ClampMin = "4", ClampMax = "4096"))
+	int32 IoUringQueueDepth = 64;
+
+	/**
+	 * Makes the IoUring backend wait for a slot to reach the disk before it replaces the previous slot file.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Storage")
+	bool bSyncSlotWrites = true;
+
+	/**
+	 * Number of in-memory snapshots kept by CaptureSnapshot before the oldest one is dropped.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Snapshots", meta = (ClampMin = "1"))
+	int32 SnapshotCapacity = 8;
+
+	/**
+	 * Leaves actors owned by players (PlayerStates, PlayerControllers, their pawns, and everything they own) out of SaveWorld, LoadWorld, and snapshots.
+	 * Enable when players are saved to their own shards with SavePlayer.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Players")
+	bool bExcludePlayerOwnedActors = false;
+
+	/**
+	 * LoadWorldAsync restores actors within this distance of a player's viewpoint before the world is playable.
+	 * All remaining actors are restored over the following frames.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Restore", meta = (ClampMin = "0", Units = "cm"))
+	float PlayableRestoreRadius = 5000.f;
+
+	/**
+	 * Time per frame LoadWorldAsync spends on restoring actors once the world is playable.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Restore", meta = (ClampMin = "0.1", Units = "ms"))
+	float RestoreBudgetMs = 4.f;
+
+	/**
+	 * Saves the instances of all foliage components of a level, as if they were tagged EssInstances.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Instances")
+	bool bSaveFoliageInstances = false;
+
+	/**
+	 * Edge length of the cells of the spatial grid stored with every saved level, used by SaveRegion and LoadRegion to find the records of a region.
+	 * Zero stores no grid, regions are then found by going through all records of a level.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Regions", meta = (ClampMin = "0", Units = "cm"))
+	float RegionCellSize = 10000.f;
+
+	/**
+	 * Mass fragment types saved with the world. Mass entities with any of these fragments are saved per archetype and recreated in batches when loading.
+	 * Fragments of plain old data are copied in bulk, all others are serialized per entity.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Mass", meta = (AllowedClasses = "/Script/CoreUObject.ScriptStruct"))
+	TArray<FSoftObjectPath> MassFragments;
+};
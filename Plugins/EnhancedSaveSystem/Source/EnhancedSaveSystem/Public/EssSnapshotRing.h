@@ -0,0 +1,87 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EssSaveData.h"
+
+/**
+ * Changes of a single level between two consecutive snapshots.
+ */
+struct FEssLevelDelta
+{
+	/** Level data without actor records, plus the runtime and placed actor records which were added or changed. */
+	FEssLevelData ChangedData;
+	TArray<FGuid> RemovedRuntimeActors;
+	TArray<FName> RemovedPlacedActors;
+};
+
+struct FEssSnapshot
+{
+	int32 Id = INDEX_NONE;
+	FDateTime Time;
+
+	/** Only the oldest snapshot of the ring is a keyframe and holds the full world data. */
+	bool bKeyframe = false;
+	FEssWorldData Keyframe;
+
+	/** Changes relative to the previous snapshot of the ring. */
+	TArray<FEssLevelDelta> LevelDeltas;
+	TArray<FString> RemovedLevels;
+
+	/** Mass entities change nearly every frame, so every snapshot holds all of them. */
+	TArray<FEssMassArchetypeData> MassArchetypesData;
+	bool bMassEntitiesSaved = false;
+};
+
+/**
+ * Fixed-size ring of in-memory world snapshots.
+ * The oldest snapshot holds the full world data and every newer snapshot only the records which changed since its predecessor.
+ * When the ring is full the oldest snapshot is folded into the next one, which becomes the new keyframe.
+ */
+class ENHANCEDSAVESYSTEM_API FEssSnapshotRing
+{
+public:
+	/**
+	 * Resizes the ring. Drops all snapshots if the capacity changes.
+	 */
+	void SetCapacity(const int32 NewCapacity);
+	int32 GetCapacity() const { return Snapshots.Num(); }
+
+	/**
+	 * Adds a snapshot of the world data, evicting the oldest snapshot if the ring is full.
+	 * Drops all snapshots if the world data belongs to another world than the previous snapshot.
+	 * @return Id of the new snapshot.
+	 */
+	int32 Add(FEssWorldData&& WorldData);
+
+	/**
+	 * Gets the full world data of a snapshot. The newest snapshot is returned directly, older snapshots are rebuilt into OutScratch.
+	 * @return Null if the ring doesn't contain the snapshot.
+	 */
+	const FEssWorldData* Get(const int32 SnapshotId, FEssWorldData& OutScratch) const;
+
+	bool Contains(const int32 SnapshotId) const { return FindPosition(SnapshotId) != INDEX_NONE; }
+	void GetIds(TArray<int32>& OutIds) const;
+	int32 Num() const { return NumSnapshots; }
+	void Reset();
+
+	/**
+	 * Bytes held by the snapshots' records, including the full copy of the newest snapshot used for diffing.
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	int32 FindPosition(const int32 SnapshotId) const;
+	FEssSnapshot& GetAtPosition(const int32 Position) { return Snapshots[(Head + Position) % Snapshots.Num()]; }
+	const FEssSnapshot& GetAtPosition(const int32 Position) const { return Snapshots[(Head + Position) % Snapshots.Num()]; }
+	void EvictOldest();
+
+	TArray<FEssSnapshot> Snapshots;
+	int32 Head = 0;
+	int32 NumSnapshots = 0;
+	int32 NextId = 0;
+
+	/** Full world data of the newest snapshot, diffed against when adding the next snapshot. */
+	FEssWorldData Latest;
+};
@@ -0,0 +1,36 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FEssLevelData;
+struct FEssWorldData;
+
+/**
+ * Spatial grid of the actor records of saved levels, so the records within a region can be found without going through all of a level's records.
+ * The grid is two-dimensional: cells span the whole height of a level, and records are assigned to cells by the location of their saved transform.
+ */
+class ENHANCEDSAVESYSTEM_API FEssSpatialGrid
+{
+public:
+	static FIntPoint GetCell(const FVector& Location, const float CellSize);
+
+	/**
+	 * Rebuilds the grid of a level from its current records. Must be called again whenever records are added, removed, or reordered.
+	 * @param CellSize Zero removes the grid.
+	 */
+	static void Build(FEssLevelData& LevelData, const float CellSize);
+
+	/**
+	 * Rebuilds the grids of all levels of a world with the cell size of the settings.
+	 */
+	static void Build(FEssWorldData& WorldData);
+
+	/**
+	 * Collects the records of a level whose saved location lies within the bounds. Levels without a grid are searched record by record.
+	 * @param OutRuntimeActors Indices into RuntimeActorsData.
+	 * @param OutPlacedActors Keys of PlacedActorsData.
+	 */
+	static void FindRecords(const FEssLevelData& LevelData, const FBox& Bounds, TArray<int32>& OutRuntimeActors, TArray<FName>& OutPlacedActors);
+};
@@ -0,0 +1,126 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "UObject/ObjectKey.h"
+
+ENHANCEDSAVESYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogEss, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("Enhanced Save System"), STATGROUP_Ess, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SaveWorld"), STAT_EssSaveWorld, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LoadWorld"), STAT_EssLoadWorld, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SaveGlobalObject"), STAT_EssSaveGlobalObject, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LoadGlobalObject"), STAT_EssLoadGlobalObject, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetLevelData"), STAT_EssGetLevelData, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RestoreLevelData"), STAT_EssRestoreLevelData, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ExtractActorData"), STAT_EssExtractActorData, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ExtractGlobalObjectData"), STAT_EssExtractGlobalObjectData, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RestoreActorData"), STAT_EssRestoreActorData, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RestoreGlobalObjectData"), STAT_EssRestoreGlobalObjectData, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RespawnActor"), STAT_EssRespawnActor, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ResolveReferences"), STAT_EssResolveReferences, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PreloadClasses"), STAT_EssPreloadClasses, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TickRestoreQueue"), STAT_EssTickRestoreQueue, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ExtractInstances"), STAT_EssExtractInstances, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RestoreInstances"), STAT_EssRestoreInstances, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ExtractMassEntities"), STAT_EssExtractMassEntities, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RestoreMassEntities"), STAT_EssRestoreMassEntities, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BuildSpatialGrid"), STAT_EssBuildSpatialGrid, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindRegionRecords"), STAT_EssFindRegionRecords, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SlotWrite"), STAT_EssSlotWrite, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SlotRead"), STAT_EssSlotRead, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Captured"), STAT_EssActorsCaptured, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Restored"), STAT_EssActorsRestored, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Spawned"), STAT_EssActorsSpawned, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Destroyed"), STAT_EssActorsDestroyed, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("References Resolved"), STAT_EssReferencesResolved, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Classes Preloaded"), STAT_EssClassesPreloaded, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Deferred"), STAT_EssActorsDeferred, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Instances Restored"), STAT_EssInstancesRestored, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Mass Entities Restored"), STAT_EssMassEntitiesRestored, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_QWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bytes Serialized"), STAT_EssBytesSerialized, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_QWORD_ACCUMULATOR_STAT_EXTERN(TEXT("File Bytes Written"), STAT_EssFileBytesWritten, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+DECLARE_QWORD_ACCUMULATOR_STAT_EXTERN(TEXT("File Bytes Read"), STAT_EssFileBytesRead, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Snapshot Memory"), STAT_EssSnapshotMemory, STATGROUP_Ess, ENHANCEDSAVESYSTEM_API);
+
+/**
+ * Scoped cycle counter which falls back to a trace CPU scope in builds without stats,
+ * so Insights captures of live builds still show every ESS phase.
+ */
+#if STATS
+#define ESS_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define ESS_SCOPE_CYCLE_COUNTER(Stat) TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#endif
+
+struct FEssOperationTiming
+{
+	FString Operation;
+	FString SlotName;
+	FDateTime Time;
+	double DurationMs = 0.0;
+	int32 ActorCount = 0;
+	int64 FileBytes = 0;
+	bool bSucceeded = false;
+};
+
+/**
+ * Keeps the most recent save and load timings and the serialized bytes per class.
+ * Dumped with the Ess.DumpTimings and Ess.DumpClassBytes console commands.
+ */
+class ENHANCEDSAVESYSTEM_API FEssStats
+{
+public:
+	static FEssStats& Get();
+
+	void RecordTiming(const FEssOperationTiming& Timing);
+
+	/**
+	 * Counts the bytes serialized for an object of a class. Called for every extracted record, so it only touches the game thread's map.
+	 */
+	void AddClassBytes(const UClass* Class, const int64 Bytes);
+	void AddFileBytesWritten(const int64 Bytes);
+	void AddFileBytesRead(const int64 Bytes);
+
+	/**
+	 * Returns up to Count of the most recent timings, newest first.
+	 */
+	TArray<FEssOperationTiming> GetRecentTimings(const int32 Count) const;
+
+	void DumpTimings(const int32 Count, FOutputDevice& Ar) const;
+	void DumpClassBytes(const int32 Count, FOutputDevice& Ar) const;
+	void Reset();
+
+private:
+	static constexpr int32 MaxTimings = 128;
+
+	mutable FCriticalSection Lock;
+	TArray<FEssOperationTiming> Timings;
+	int32 NextTimingIndex = 0;
+
+	/** Only accessed on the game thread. Class names are resolved when dumping. */
+	TMap<TObjectKey<UClass>, int64> ClassBytes;
+
+	int64 TotalFileBytesWritten = 0;
+	int64 TotalFileBytesRead = 0;
+};
+
+/**
+ * Measures the lifetime of an operation and records it with FEssStats on destruction.
+ */
+struct ENHANCEDSAVESYSTEM_API FEssScopedTiming
+{
+	FEssScopedTiming(const TCHAR* Operation, const FString& SlotName);
+	~FEssScopedTiming();
+
+	FEssOperationTiming Timing;
+
+private:
+	double StartTime;
+};
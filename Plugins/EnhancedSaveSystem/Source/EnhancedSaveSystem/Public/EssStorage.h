@@ -0,0 +1,110 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A single slot of a batched write.
+ */
+struct FEssSlotWrite
+{
+	FString SlotName;
+	int32 UserIndex = 0;
+	const TArray<uint8>* Bytes = nullptr;
+	bool bSucceeded = false;
+};
+
+/**
+ * Storage of the bytes of save game slots. All slot reads and writes of ESS go through the active backend.
+ * Backends are called from the game thread as well as from background threads.
+ */
+class ENHANCEDSAVESYSTEM_API IEssStorageBackend
+{
+public:
+	virtual ~IEssStorageBackend() = default;
+
+	virtual bool DoesSlotExist(const FString& SlotName, const int32 UserIndex) = 0;
+	virtual bool Read(const FString& SlotName, const int32 UserIndex, TArray<uint8>& OutBytes) = 0;
+	virtual bool Delete(const FString& SlotName, const int32 UserIndex) = 0;
+
+	/**
+	 * Writes several slots at once and sets bSucceeded of each of them.
+	 */
+	virtual void WriteBatch(TArrayView<FEssSlotWrite> Writes) = 0;
+
+	/**
+	 * Reads part of a slot. The default reads the whole slot and copies the range out of it.
+	 * @return False if the slot can't be read or ends before the range does.
+	 */
+	virtual bool ReadRange(const FString& SlotName, const int32 UserIndex, const int64 Offset, const int64 Size, TArray<uint8>& OutBytes);
+
+	/**
+	 * @return ReadRange only reads the requested range, instead of the whole slot.
+	 */
+	virtual bool SupportsRangedReads() const { return false; }
+
+	bool Write(const FString& SlotName, const int32 UserIndex, const TArray<uint8>& Bytes);
+};
+
+/**
+ * Stores slots through the platform's save game system, like UGameplayStatics. Default backend.
+ */
+class ENHANCEDSAVESYSTEM_API FEssSaveGameStorageBackend : public IEssStorageBackend
+{
+public:
+	virtual bool DoesSlotExist(const FString& SlotName, const int32 UserIndex) override;
+	virtual bool Read(const FString& SlotName, const int32 UserIndex, TArray<uint8>& OutBytes) override;
+	virtual bool Delete(const FString& SlotName, const int32 UserIndex) override;
+	virtual void WriteBatch(TArrayView<FEssSlotWrite> Writes) override;
+};
+
+/**
+ * Stores slots as files in Saved/SaveGames, the same files the save game system uses on Linux.
+ * Writes of a batch are submitted through io_uring: every slot is written in chunks to a temporary file, synced, and renamed
+ * over the slot as one linked chain, with at most IoUringQueueDepth operations in flight.
+ * Falls back to the save game system where io_uring isn't available.
+ */
+class ENHANCEDSAVESYSTEM_API FEssIoUringStorageBackend : public IEssStorageBackend
+{
+public:
+	virtual bool DoesSlotExist(const FString& SlotName, const int32 UserIndex) override;
+	virtual bool Read(const FString& SlotName, const int32 UserIndex, TArray<uint8>& OutBytes) override;
+	virtual bool Delete(const FString& SlotName, const int32 UserIndex) override;
+	virtual void WriteBatch(TArrayView<FEssSlotWrite> Writes) override;
+	virtual bool ReadRange(const FString& SlotName, const int32 UserIndex, const int64 Offset, const int64 Size, TArray<uint8>& OutBytes) override;
+	virtual bool SupportsRangedReads() const override;
+
+	static FString GetFilePath(const FString& SlotName);
+
+private:
+	FEssSaveGameStorageBackend Fallback;
+};
+
+/**
+ * Registry of storage backends. The active backend is picked by StorageBackend of the settings and can be switched at runtime
+ * with SetBackend or the Ess.StorageBackend console command.
+ */
+class ENHANCEDSAVESYSTEM_API FEssStorage
+{
+public:
+	static const FName SaveGameBackend;
+	static const FName IoUringBackend;
+
+	/**
+	 * @return Active backend. Stays valid while it is used, even if another backend is selected meanwhile.
+	 */
+	static TSharedRef<IEssStorageBackend> Get();
+
+	static FName GetBackendName();
+
+	/**
+	 * @return False if no backend is registered under the name.
+	 */
+	static bool SetBackend(const FName Name);
+
+	/**
+	 * Registers a backend of the game, replacing a backend of the same name.
+	 */
+	static void RegisterBackend(const FName Name, const TSharedRef<IEssStorageBackend>& Backend);
+};
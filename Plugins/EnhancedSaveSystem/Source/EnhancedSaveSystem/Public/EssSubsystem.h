@@ -3,15 +3,36 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Engine/StreamableManager.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "EssActorRegistry.h"
+#include "EssRecordIndex.h"
+#include "EssSnapshotRing.h"
 #include "EssSubsystem.generated.h"
 
+struct FEssComponentData;
 struct FEssGlobalObjectData;
 struct FEssPlacedActorData;
 struct FEssRuntimeActorData;
 struct FEssLevelData;
+struct FEssWorldData;
 class UEssSaveGame;
 struct FObjectAndNameAsStringProxyArchive;
+struct FActorsInitializedParams;
+struct FEssOperationTiming;
+struct FEssPlayerShard;
+struct FEssLevelRestore;
+struct FEssRegionRecords;
+struct FEssRestoreItem;
+struct FEssRestoreQueue;
+struct FEssObjectReference;
+struct FEssReferenceTable;
+class FEssReferenceResolver;
+class APlayerState;
+
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FEssSnapshotFlushedDelegate, int32, SnapshotId, bool, bSucceeded);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FEssWorldLoadedDelegate, bool, bSucceeded);
 
 UCLASS()
 class ENHANCEDSAVESYSTEM_API UEssSubsystem : public UGameInstanceSubsystem
@@ -43,6 +64,42 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
 	bool LoadWorld(const FString& SlotName, const int32 UserIndex);
 
+	/**
+	 * Loads the world like LoadWorld, without blocking the game thread on file or package loads.
+	 * The slot is read asynchronously, then the saved classes which aren't loaded yet are streamed in, then the world is restored.
+	 * Actors are restored by priority: first those with a positive GetRestorePriority, then the others by distance to the players' viewpoints.
+	 * Once every actor within PlayableRestoreRadius is restored the world is playable, the remaining actors are restored over the following frames.
+	 * @param SlotName Save game slot to load from.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @param OnPlayable Called on the game thread once the actors around the players have been restored.
+	 * @param OnLoaded Called on the game thread once the whole world has been restored.
+	 * @return Load started. False if the slot doesn't exist or a world is already being loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool LoadWorldAsync(const FString& SlotName, const int32 UserIndex, const FEssWorldLoadedDelegate& OnPlayable, const FEssWorldLoadedDelegate& OnLoaded);
+
+	/**
+	 * Saves the actors within a region of the world into a slot, leaving the records of the rest of the world untouched.
+	 * Levels which have no record in the slot yet are saved as a whole.
+	 * @param Bounds Region to save. Actors are assigned to it by their location.
+	 * @param SlotName Save game slot to save to.
+	 * @param UserIndex Index used to identify the user doing the saving.
+	 * @return Saved successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool SaveRegion(const FBox& Bounds, const FString& SlotName, const int32 UserIndex);
+
+	/**
+	 * Loads the actors whose saved location lies within a region of the world, found through the spatial grid stored with every saved level.
+	 * Actors within the region without a record in the slot are destroyed, actors outside of the region are left untouched.
+	 * @param Bounds Region to load.
+	 * @param SlotName Save game slot to load from.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return Loaded successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool LoadRegion(const FBox& Bounds, const FString& SlotName, const int32 UserIndex);
+
 	/**
 	 * Deletes all of the corresponding save data and save slot based on the slot name.
 	 * @param SlotName Save game slot to delete.
@@ -75,18 +132,287 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
 	bool LoadGlobalObject(UObject* Obj, const FString& SlotName, const int32 UserIndex = 0);
 
+	/**
+	 * Save the variables that are marked as SaveGame of several objects with a single slot read and write.
+	 * Existing records of the objects are replaced by GUID. Global objects need their EssGuid set.
+	 * Automatically creates a new save game object if no corresponding one can be found based on the slot name.
+	 * @param Objects Objects to save.
+	 * @param SlotName Save game slot to save to.
+	 * @param UserIndex Index used to identify the user doing the saving.
+	 * @return All objects saved successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool SaveGlobalObjects(const TArray<UObject*>& Objects, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Load the variables that are marked as SaveGame of several objects from a single slot read. Global objects need their EssGuid set.
+	 * @param Objects Objects to load.
+	 * @param SlotName Save game slot to load from.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return All objects loaded successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool LoadGlobalObjects(const TArray<UObject*>& Objects, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Loads a single runtime actor by its EssGuid. The actor is restored if it exists in its level or respawned otherwise.
+	 * Only the actor's record is read if the slot has a record index.
+	 * @param Guid EssGuid of the actor.
+	 * @param SlotName Save game slot to load from.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return Loaded successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool LoadActorByGuid(const FGuid& Guid, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Loads a single placed actor by its name. The actor is restored if it exists in its level or respawned otherwise.
+	 * Only the actor's record is read if the slot has a record index.
+	 * If the level was saved with elided default placed actors, an actor without a record is reset to its loaded state, or destroyed if it was saved as destroyed.
+	 * @param LevelName Package name of the actor's level.
+	 * @param ActorName Name of the actor.
+	 * @param SlotName Save game slot to load from.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return Loaded successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool LoadPlacedActor(const FString& LevelName, const FName ActorName, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Loads all actors of a single level. Only the level's records are read if the slot has a record index.
+	 * @param LevelName Package name of the level.
+	 * @param SlotName Save game slot to load from.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return Loaded successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool LoadLevel(const FString& LevelName, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Reads information about a single record without restoring it.
+	 * @param Kind Kind of the record.
+	 * @param LevelName Package name of the record's level. Not needed for runtime actors and global objects.
+	 * @param Key EssGuid of runtime actors and global objects or name of placed actors.
+	 * @param SlotName Save game slot to read from.
+	 * @param OutInfo Information about the record.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return Record found. Elided placed actors are found with their loaded state and a ByteSize of 0 while their level is loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool PeekRecord(const EEssRecordKind Kind, const FString& LevelName, const FString& Key, const FString& SlotName, FEssRecordInfo& OutInfo, const int32 UserIndex = 0);
+
+	/**
+	 * Captures the world into the in-memory snapshot ring without writing to disk.
+	 * The oldest snapshot is dropped once the ring holds SnapshotCapacity snapshots. Snapshots are dropped when the world is cleaned up.
+	 * @return Id of the captured snapshot.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	int32 CaptureSnapshot();
+
+	/**
+	 * Restores the world from an in-memory snapshot without touching the file system.
+	 * @param SnapshotId Id returned by CaptureSnapshot.
+	 * @return Restored successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool RestoreSnapshot(const int32 SnapshotId);
+
+	/**
+	 * Writes an in-memory snapshot to a slot like SaveWorld would. The slot is read and written asynchronously.
+	 * @param SnapshotId Id returned by CaptureSnapshot.
+	 * @param SlotName Save game slot to save to.
+	 * @param UserIndex Index used to identify the user doing the saving.
+	 * @param OnFlushed Called on the game thread once the slot has been written.
+	 * @return Flush started. False if the snapshot doesn't exist or the slot is already being flushed to.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool FlushSnapshotToSlot(const int32 SnapshotId, const FString& SlotName, const int32 UserIndex, const FEssSnapshotFlushedDelegate& OnFlushed);
+
+	/**
+	 * Ids of the snapshots in the in-memory snapshot ring, oldest first.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Enhanced Save System")
+	TArray<int32> GetSnapshotIds() const;
+
+	/**
+	 * Drops all in-memory snapshots.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	void ClearSnapshots();
+
+	/**
+	 * Saves the actors owned by a player and the player's global objects to the player's own shard of a slot.
+	 * Only the player's shard is read and written, so the cost doesn't depend on how many other players there are.
+	 * @param PlayerState PlayerState of the player.
+	 * @param GlobalObjects Global objects belonging to the player. Need their EssGuid set.
+	 * @param SlotName Save game slot the shard belongs to.
+	 * @param UserIndex Index used to identify the user doing the saving.
+	 * @return Saved successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System", meta = (AutoCreateRefTerm = "GlobalObjects"))
+	bool SavePlayer(APlayerState* PlayerState, const TArray<UObject*>& GlobalObjects, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Saves the actors owned by several players to their shards of a slot. Shards are read and written in parallel.
+	 * @param PlayerStates PlayerStates of the players.
+	 * @param SlotName Save game slot the shards belong to.
+	 * @param UserIndex Index used to identify the user doing the saving.
+	 * @return All shards saved successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool SavePlayers(const TArray<APlayerState*>& PlayerStates, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Loads the actors owned by a player and the player's global objects from the player's shard of a slot.
+	 * Respawnable actors owned by the player are replaced by the saved ones and owned by the player's controller.
+	 * @param PlayerState PlayerState of the player.
+	 * @param GlobalObjects Global objects belonging to the player. Need their EssGuid set.
+	 * @param SlotName Save game slot the shard belongs to.
+	 * @param UserIndex Index used to identify the user doing the loading.
+	 * @return Loaded successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System", meta = (AutoCreateRefTerm = "GlobalObjects"))
+	bool LoadPlayer(APlayerState* PlayerState, const TArray<UObject*>& GlobalObjects, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Deletes a player's shard of a slot.
+	 * @param PlayerId Id of the player as returned by GetPlayerId.
+	 * @param SlotName Save game slot the shard belongs to.
+	 * @param UserIndex Index used to identify the user doing the deleting.
+	 * @return Deleted successfully.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enhanced Save System")
+	bool DeletePlayerSave(const FString& PlayerId, const FString& SlotName, const int32 UserIndex = 0);
+
+	/**
+	 * Stable id of a player, used to name the player's shards. The player's unique net id, or the PlayerState's EssGuid if it has none.
+	 * @return Empty if the player has neither.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Enhanced Save System")
+	static FString GetPlayerId(const APlayerState* PlayerState);
+
+	/**
+	 * Name of the save game slot holding a player's shard of a slot.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Enhanced Save System")
+	static FString GetPlayerSlotName(const FString& SlotName, const FString& PlayerId);
+
+	/**
+	 * Number of savable actors currently tracked across all loaded levels.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Enhanced Save System")
+	int32 GetNumSavableActors() const;
+
+	/**
+	 * Number of savable actors currently tracked in a level.
+	 */
+	int32 GetNumSavableActors(const ULevel* Level) const;
+
+	/**
+	 * Blocks until the record indices of the slots written so far, which are written in the background, have been written.
+	 */
+	void WaitForRecordIndexWrites();
+
 protected:
-	FEssLevelData GetLevelData(const TObjectPtr<ULevel> Level);
+	FEssWorldData GetWorldData(int32& OutActorCount);
+	int32 RestoreWorldData(const FEssWorldData& WorldData);
+	/**
+	 * @param Actors Subset of the level's actors to save. All of them if null.
+	 * @param ObjectReferences Reference table to continue, e.g. of level data the records are merged into.
+	 */
+	FEssLevelData GetLevelData(const TObjectPtr<ULevel> Level, const TArray<AActor*>* Actors = nullptr, const TArray<FEssObjectReference>* ObjectReferences = nullptr);
 	void RestoreLevelData(TObjectPtr<ULevel> Level, const FEssLevelData* LevelData);
-	FEssRuntimeActorData ExtractRuntimeActorData(TObjectPtr<AActor> Actor);
-	FEssPlacedActorData ExtractPlacedActorData(TObjectPtr<AActor> Actor);
+	int32 SaveLevelRegion(const TObjectPtr<ULevel> Level, const FBox& Bounds, FEssLevelData& OutLevelData);
+	void PrepareLevelRestore(TObjectPtr<ULevel> Level, const FEssLevelData* LevelData, FEssLevelRestore& OutRestore);
+	void PrepareRegionRestore(const FEssRegionRecords& Region, const FBox& Bounds, FEssLevelRestore& OutRestore);
+	void FinishLevelRestore(const FEssLevelRestore& Restore, FEssReferenceResolver& Resolver);
+	static void GetRestoreItems(const FEssLevelRestore& Restore, TArray<FEssRestoreItem>& OutItems);
+	int32 SortRestoreItems(TArray<FEssRestoreItem>& Items) const;
+	void RestoreItem(const FEssRestoreItem& Item, FEssReferenceResolver& Resolver);
+	void DestroyPlacedActors(const FEssLevelRestore& Restore);
+	FEssRuntimeActorData ExtractRuntimeActorData(TObjectPtr<AActor> Actor, FEssReferenceTable& References);
+	FEssPlacedActorData ExtractPlacedActorData(TObjectPtr<AActor> Actor, FEssReferenceTable& References);
 	FEssGlobalObjectData ExtractGlobalObjectData(TObjectPtr<UObject> Obj);
-	void SerializeComponents(FObjectAndNameAsStringProxyArchive& Archive, TArray <UActorComponent*> Components);
-	void RespawnRuntimeActor(const FEssRuntimeActorData& ActorData, const TObjectPtr<ULevel> Level);
-	void RespawnPlacedActor(const FEssPlacedActorData& ActorData, const TObjectPtr<ULevel> Level);
-	void RestoreRuntimeActorData(const FEssRuntimeActorData& ActorData, TObjectPtr<AActor> Actor);
-	void RestorePlacedActorData(const FEssPlacedActorData& ActorData, TObjectPtr<AActor> Actor);
+	void SerializeComponents(FObjectAndNameAsStringProxyArchive& Archive, const TArray<UActorComponent*>& Components);
+	void SerializeActor(TObjectPtr<AActor> Actor, TArray<uint8>& OutBytes, TArray<FEssComponentData>& OutComponentsData, FEssReferenceTable& References,
+		TArray<int32>& OutReferenceIndices);
+	void DeserializeActor(TObjectPtr<AActor> Actor, const TArray<uint8>& Bytes, const TArray<FEssComponentData>& ComponentsData, FEssReferenceResolver& Resolver,
+		const TArray<FEssObjectReference>& References, const TArray<FEssComponentData>* CurrentComponentsData = nullptr);
+	void CapturePlacedActorBaselines(ULevel* Level);
+	void CaptureInstanceComponents(ULevel* Level);
+	void GetInstancesData(const ULevel* Level, FEssLevelData& LevelData) const;
+	void RestoreInstancesData(const ULevel* Level, const FEssLevelData& LevelData);
+	void ResetPlacedActor(const FEssPlacedActorData& Baseline, TObjectPtr<AActor> Actor, FEssReferenceResolver& Resolver);
+	AActor* SpawnActorForRecord(const TSubclassOf<AActor>& Class, const FTransform& Transform, const TObjectPtr<ULevel> Level, AActor* Owner = nullptr);
+	void RespawnRuntimeActor(const FEssRuntimeActorData& ActorData, const TObjectPtr<ULevel> Level, FEssReferenceResolver& Resolver, const TArray<FEssObjectReference>& References,
+		AActor* Owner = nullptr);
+	void RespawnPlacedActor(const FEssPlacedActorData& ActorData, const TObjectPtr<ULevel> Level, FEssReferenceResolver& Resolver, const TArray<FEssObjectReference>& References);
+	void RestoreRuntimeActorData(const FEssRuntimeActorData& ActorData, TObjectPtr<AActor> Actor, FEssReferenceResolver& Resolver, const TArray<FEssObjectReference>& References);
+	void RestorePlacedActorData(const FEssPlacedActorData& ActorData, TObjectPtr<AActor> Actor, FEssReferenceResolver& Resolver, const TArray<FEssObjectReference>& References,
+		const TArray<FEssComponentData>* CurrentComponentsData = nullptr);
 	void RestoreGlobalObjectData(const FEssGlobalObjectData& ObjectData, TObjectPtr<UObject> Obj);
+	bool AddGlobalObjectsData(const TArray<UObject*>& Objects, FEssSaveData& SaveData, TArray<UObject*>& OutSavedObjects);
+	bool RestoreGlobalObjectsData(const TArray<UObject*>& Objects, const FEssSaveData& SaveData, int32& OutNumLoaded);
+	bool SavePlayerShards(TArray<FEssPlayerShard>& Shards, const int32 UserIndex, FEssOperationTiming& OutTiming);
+	void GetPlayerActors(TArray<FEssPlayerShard>& Shards);
+	bool IsExcludedPlayerActor(AActor* Actor) const;
+	TSharedPtr<FEssRecordIndex> GetRecordIndex(const FString& SlotName, const int32 UserIndex);
+	void ResetRecordIndex(const FString& SlotName);
+
+	/**
+	 * Writes the record index of a slot on a background thread, after the slot itself has been written.
+	 * @param SlotBytes The bytes written to the slot.
+	 */
+	void WriteRecordIndexAsync(const UEssSaveGame* SaveGame, const FString& SlotName, const int32 UserIndex, TArray<uint8>&& SlotBytes);
+	static void WriteRecordIndex(const FEssSaveData* SaveData, const FGuid& WriteGuid, const FString& SlotName, const int32 UserIndex, const TArray<uint8>& SlotBytes);
+	const FEssWorldData* FindWorldData(const UEssSaveGame* SaveGame, const FString& SlotName) const;
+	bool FindRuntimeActorRecord(const FString& SlotName, const int32 UserIndex, const FGuid& Guid, FEssRuntimeActorData& OutActorData, FString& OutLevelName,
+		TArray<FEssObjectReference>& OutReferences);
+	bool FindPlacedActorRecord(const FString& SlotName, const int32 UserIndex, const FString& LevelName, const FName ActorName, FEssPlacedActorData& OutActorData,
+		TArray<FEssObjectReference>& OutReferences);
+	bool FindLevelRecord(const FString& SlotName, const int32 UserIndex, const FString& LevelName, FEssLevelData& OutLevelData);
+	bool FindLevelHeader(const FString& SlotName, const int32 UserIndex, const FString& LevelName, FEssLevelData& OutLevelHeader);
+	const FEssPlacedActorData* FindPlacedActorBaseline(ULevel* Level, const FName ActorName);
+	bool PeekElidedPlacedActor(const FString& LevelName, const FName ActorName, const FString& SlotName, const int32 UserIndex, FEssRecordInfo& OutInfo);
+	ULevel* FindLoadedLevel(const FString& LevelName) const;
+	void GetSavableActors(ULevel* Level, TArray<AActor*>& OutActors);
+	void RegisterLevel(ULevel* Level);
+	void TrackWorld(UWorld* World);
+	void UntrackWorld();
+	void OnWorldInitializedActors(const FActorsInitializedParams& Params);
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
 	UEssSaveGame* GetSaveGameAndCreateIfNotExists(const FString& SlotName, const int32 UserIndex);
-	UEssSaveGame* GetSaveGame(const FString& SlotName, const int32 UserIndex);
+	UEssSaveGame* GetSaveGame(const FString& SlotName, const int32 UserIndex, int64* OutFileBytes = nullptr);
+	UEssSaveGame* ReadSaveGame(const FString& SlotName, const int32 UserIndex, int64* OutFileBytes = nullptr);
+	bool WriteSaveGame(UEssSaveGame* SaveGame, const FString& SlotName, const int32 UserIndex, int64& OutFileBytes);
+
+	/**
+	 * Reads a slot through the storage backend on a background thread and calls OnRead on the game thread with the loaded save game, or null.
+	 */
+	static void ReadSaveGameAsync(const FString& SlotName, const int32 UserIndex, TFunction<void(UEssSaveGame*)>&& OnRead);
+	void WriteSnapshotAsync(UEssSaveGame* SaveGame, FEssWorldData&& WorldData, const int32 SnapshotId, const FString& SlotName, const int32 UserIndex, const double StartTime);
+	void OnSnapshotFlushed(const FEssOperationTiming& Timing, const int32 SnapshotId);
+	void PreloadClasses(const TSet<FSoftObjectPath>& ClassPaths);
+	void OnWorldSlotLoaded(UEssSaveGame* SaveGame, const FString& SlotName, const double StartTime, const FEssWorldLoadedDelegate& OnPlayable);
+	void OnWorldClassesLoaded(UEssSaveGame* SaveGame, const FString& SlotName, const double StartTime, const FEssWorldLoadedDelegate& OnPlayable);
+	bool TickRestoreQueue(float DeltaTime);
+	void FlushRestoreQueue();
+	void FinishRestoreQueue(const bool bSucceeded);
+
+protected:
+	FEssActorRegistry ActorRegistry;
+	TWeakObjectPtr<UWorld> TrackedWorld;
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	TMap<TPair<FString /*Slot name*/, int32 /*User index*/>, TSharedPtr<FEssRecordIndex>> RecordIndices;
+	TMap<TPair<FString /*Slot name*/, int32 /*User index*/>, TFuture<void>> RecordIndexWrites;
+	FEssSnapshotRing SnapshotRing;
+	TMap<FString /*Slot name*/, FEssSnapshotFlushedDelegate> FlushingSlots;
+	TMap<FString /*Slot name*/, FEssWorldLoadedDelegate> LoadingSlots;
+	FStreamableManager StreamableManager;
+	TSharedPtr<FEssRestoreQueue> RestoreQueue;
 };
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 
+struct FEssComponentData;
+struct FEssLevelData;
+struct FEssWorldData;
+
 class ENHANCEDSAVESYSTEM_API EssUtil
 {
 public:
@@ -15,6 +19,40 @@ public:
 	static bool IsActorRespawnable(const TSubclassOf<AActor>& Class);
 	static FString GetLevelName(const ULevel* Level);
 
+	/**
+	 * Finds the player an actor belongs to by walking its owner chain up to a PlayerState, PlayerController, or possessed pawn.
+	 * @return Null if the actor isn't owned by a player.
+	 */
+	static APlayerState* GetOwningPlayerState(AActor* Actor);
+
+	/**
+	 * Copies everything of a level's data except its runtime and placed actor records.
+	 */
+	static FEssLevelData GetLevelHeader(const FEssLevelData& LevelData);
+
+	/**
+	 * Empties the entries of a level's reference table which none of its actor records refer to, and drops the empty entries at its end.
+	 */
+	static void PruneObjectReferences(FEssLevelData& LevelData);
+
+	/**
+	 * Gets the class of an actor record, loading it synchronously if it hasn't been preloaded.
+	 * @return Null if the class doesn't exist anymore.
+	 */
+	static UClass* GetLoadedClass(const TSoftClassPtr<AActor>& Class);
+
+	/**
+	 * Collects the distinct classes of the actor records which aren't loaded yet.
+	 */
+	static void GetUnloadedClasses(const FEssLevelData& LevelData, TSet<FSoftObjectPath>& OutClassPaths);
+	static void GetUnloadedClasses(const FEssWorldData& WorldData, TSet<FSoftObjectPath>& OutClassPaths);
+
+	/**
+	 * Finds the record of a component in the component records of an actor, which are sorted by name.
+	 * @return Null if the actor had no savable component of that name when it was saved.
+	 */
+	static const FEssComponentData* FindComponentData(const TArray<FEssComponentData>& ComponentsData, const FName Name);
+
 private:
 	static void SetGuid(UObject* Obj, const FGuid& NewGuid, FProperty* Prop);
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EnhancedSaveSystemDeveloper.h"
+
+#define LOCTEXT_NAMESPACE "FEnhancedSaveSystemDeveloperModule"
+
+void FEnhancedSaveSystemDeveloperModule::StartupModule()
+{
+}
+
+void FEnhancedSaveSystemDeveloperModule::ShutdownModule()
+{
+}
+
+#undef LOCTEXT_NAMESPACE
+	
+IMPLEMENT_MODULE(FEnhancedSaveSystemDeveloperModule, EnhancedSaveSystemDeveloper)
\ No newline at end of file
@@ -0,0 +1,446 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssAnalyzeCommandlet.h"
+
+#include "EssSaveData.h"
+#include "EssSaveGame.h"
+#include "EssStats.h"
+#include "EssStorage.h"
+#include "Dom/JsonObject.h"
+#include "Kismet/GameplayStatics.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/PropertyTag.h"
+
+namespace EssAnalyze
+{
+	struct FSizeEntry
+	{
+		int64 Bytes = 0;
+		int64 MaxBytes = 0;
+		int32 Count = 0;
+
+		void Add(const int64 InBytes)
+		{
+			Bytes += InBytes;
+			MaxBytes = FMath::Max(MaxBytes, InBytes);
+			++Count;
+		}
+	};
+
+	struct FRecordEntry
+	{
+		FString Kind;
+		FString World;
+		FString Level;
+		FString Id;
+		FString Class;
+		int64 Bytes = 0;
+	};
+
+	struct FBlobEntry
+	{
+		/** Byte data of the first record, owned by the analyzed save game. */
+		const TArray<uint8>* Data = nullptr;
+		int64 Bytes = 0;
+		TArray<int32> Records;
+	};
+
+	class FSaveAnalysis
+	{
+	public:
+		explicit FSaveAnalysis(const int64 InOversizedBytes)
+			: OversizedBytes(InOversizedBytes)
+		{
+		}
+
+		void Analyze(const UEssSaveGame* SaveGame)
+		{
+			for (const auto& SavePair : SaveGame->SaveData)
+			{
+				const FEssSaveData& SaveData = SavePair.Value;
+
+				for (const FEssGlobalObjectData& ObjectData : SaveData.GlobalObjectData)
+				{
+					const int64 Bytes = GetSerializedSize(FEssGlobalObjectData::StaticStruct(), &ObjectData);
+					AddRecord(TEXT("GlobalObject"), FString(), FString(), ObjectData.Guid.ToString(), FSoftObjectPath(ObjectData.Class.Get()), Bytes, ObjectData.ByteData);
+				}
+
+				for (const auto& WorldPair : SaveData.WorldsData)
+				{
+					const FEssWorldData& WorldData = WorldPair.Value;
+					Worlds.FindOrAdd(WorldData.Name).Add(GetSerializedSize(FEssWorldData::StaticStruct(), &WorldData));
+
+					for (const auto& LevelPair : WorldData.LevelsData)
+					{
+						const FEssLevelData& LevelData = LevelPair.Value;
+						Levels.FindOrAdd(WorldData.Name / LevelData.Name).Add(GetSerializedSize(FEssLevelData::StaticStruct(), &LevelData));
+
+						for (const FEssRuntimeActorData& ActorData : LevelData.RuntimeActorsData)
+						{
+							const int64 Bytes = GetSerializedSize(FEssRuntimeActorData::StaticStruct(), &ActorData);
+							AddRecord(TEXT("RuntimeActor"), WorldData.Name, LevelData.Name, ActorData.Guid.ToString(), ActorData.Class.ToSoftObjectPath(), Bytes, ActorData.ByteData, ActorData.ComponentsData);
+						}
+
+						for (const auto& PlacedPair : LevelData.PlacedActorsData)
+						{
+							const FEssPlacedActorData& ActorData = PlacedPair.Value;
+							const int64 Bytes = GetSerializedSize(FEssPlacedActorData::StaticStruct(), &ActorData);
+							AddRecord(TEXT("PlacedActor"), WorldData.Name, LevelData.Name, ActorData.Name.ToString(), ActorData.Class.ToSoftObjectPath(), Bytes, ActorData.ByteData, ActorData.ComponentsData);
+						}
+					}
+				}
+			}
+		}
+
+		FString ToText(const int64 FileBytes, const int32 Top) const
+		{
+			FString Out;
+			Out += FString::Printf(TEXT("File: %lld bytes, %d records\n"), FileBytes, Records.Num());
+
+			AppendSizes(Out, TEXT("Worlds"), Worlds, Top);
+			AppendSizes(Out, TEXT("Levels"), Levels, Top);
+			AppendSizes(Out, TEXT("Classes"), Classes, Top);
+			AppendSizes(Out, TEXT("Properties"), Properties, Top);
+
+			Out += FString::Printf(TEXT("\nLargest records (top %d)\n"), Top);
+			for (const int32 Index : GetLargestRecords(Top))
+			{
+				const FRecordEntry& Record = Records[Index];
+				Out += FString::Printf(TEXT("  %12lld  %-12s %s %s %s\n"), Record.Bytes, *Record.Kind, *(Record.World / Record.Level), *Record.Id, *Record.Class);
+			}
+
+			const TArray<const FBlobEntry*> Duplicates = GetDuplicateBlobs();
+			Out += FString::Printf(TEXT("\nDuplicate blobs (%d)\n"), Duplicates.Num());
+			for (int32 i = 0; i < Duplicates.Num() && i < Top; ++i)
+			{
+				const FBlobEntry& Blob = *Duplicates[i];
+				Out += FString::Printf(TEXT("  %d x %lld bytes (%lld redundant), e.g. %s %s\n"), Blob.Records.Num(), Blob.Bytes,
+					Blob.Bytes * (Blob.Records.Num() - 1), *Records[Blob.Records[0]].Id, *Records[Blob.Records[0]].Class);
+			}
+
+			const TArray<int32> Oversized = GetOversizedRecords();
+			Out += FString::Printf(TEXT("\nOversized records (> %lld bytes): %d\n"), OversizedBytes, Oversized.Num());
+			for (int32 i = 0; i < Oversized.Num() && i < Top; ++i)
+			{
+				const FRecordEntry& Record = Records[Oversized[i]];
+				Out += FString::Printf(TEXT("  %12lld  %s %s\n"), Record.Bytes, *Record.Id, *Record.Class);
+			}
+
+			return Out;
+		}
+
+		FString ToJson(const int64 FileBytes, const int32 Top) const
+		{
+			TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+			Root->SetNumberField(TEXT("fileBytes"), FileBytes);
+			Root->SetNumberField(TEXT("records"), Records.Num());
+			Root->SetArrayField(TEXT("worlds"), SizesToJson(Worlds, Top));
+			Root->SetArrayField(TEXT("levels"), SizesToJson(Levels, Top));
+			Root->SetArrayField(TEXT("classes"), SizesToJson(Classes, Top));
+			Root->SetArrayField(TEXT("properties"), SizesToJson(Properties, Top));
+
+			TArray<TSharedPtr<FJsonValue>> Largest;
+			for (const int32 Index : GetLargestRecords(Top))
+				Largest.Add(MakeShared<FJsonValueObject>(RecordToJson(Records[Index])));
+			Root->SetArrayField(TEXT("largestRecords"), Largest);
+
+			TArray<TSharedPtr<FJsonValue>> Duplicates;
+			for (const FBlobEntry* Blob : GetDuplicateBlobs())
+			{
+				TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+				Object->SetNumberField(TEXT("bytes"), Blob->Bytes);
+				Object->SetNumberField(TEXT("count"), Blob->Records.Num());
+				Object->SetNumberField(TEXT("redundantBytes"), Blob->Bytes * (Blob->Records.Num() - 1));
+
+				TArray<TSharedPtr<FJsonValue>> Ids;
+				for (const int32 Index : Blob->Records)
+					Ids.Add(MakeShared<FJsonValueString>(Records[Index].Id));
+				Object->SetArrayField(TEXT("records"), Ids);
+
+				Duplicates.Add(MakeShared<FJsonValueObject>(Object));
+			}
+			Root->SetArrayField(TEXT("duplicateBlobs"), Duplicates);
+
+			TArray<TSharedPtr<FJsonValue>> Oversized;
+			for (const int32 Index : GetOversizedRecords())
+				Oversized.Add(MakeShared<FJsonValueObject>(RecordToJson(Records[Index])));
+			Root->SetNumberField(TEXT("oversizedThresholdBytes"), OversizedBytes);
+			Root->SetArrayField(TEXT("oversizedRecords"), Oversized);
+
+			FString Json;
+			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+			FJsonSerializer::Serialize(Root, Writer);
+			return Json;
+		}
+
+	private:
+		static int64 GetSerializedSize(UScriptStruct* Struct, const void* Data)
+		{
+			TArray<uint8> Bytes;
+			FMemoryWriter MemoryWriter(Bytes);
+			FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, false);
+			Struct->SerializeItem(Archive, const_cast<void*>(Data), nullptr);
+			return Bytes.Num();
+		}
+
+		void AddRecord(const TCHAR* Kind, const FString& World, const FString& Level, const FString& Id, const FSoftObjectPath& ClassPath, const int64 Bytes, const TArray<uint8>& ByteData,
+			const TArray<FEssComponentData>& ComponentsData = TArray<FEssComponentData>())
+		{
+			// Class paths are used as they are, so analyzing a slot doesn't load the saved classes
+			const FString ClassName = ClassPath.IsNull() ? TEXT("<None>") : ClassPath.ToString();
+
+			const int32 Index = Records.Add({ Kind, World, Level, Id, ClassName, Bytes });
+			Classes.FindOrAdd(ClassName).Add(Bytes);
+
+			if (!ByteData.IsEmpty())
+				AddBlob(ByteData, Index);
+
+			AddProperties(ClassName, ByteData);
+
+			// Properties of components are attributed to the actor class and the component
+			for (const FEssComponentData& ComponentData : ComponentsData)
+				AddProperties(ClassName + TEXT(":") + ComponentData.Name.ToString(), ComponentData.ByteData);
+		}
+
+		/**
+		 * Groups records with identical byte data. Blobs are bucketed by hash and only counted as duplicates if their bytes are equal.
+		 */
+		void AddBlob(const TArray<uint8>& ByteData, const int32 RecordIndex)
+		{
+			TArray<FBlobEntry>& Bucket = Blobs.FindOrAdd(CityHash64(reinterpret_cast<const char*>(ByteData.GetData()), ByteData.Num()));
+			for (FBlobEntry& Blob : Bucket)
+			{
+				if (*Blob.Data == ByteData)
+				{
+					Blob.Records.Add(RecordIndex);
+					return;
+				}
+			}
+
+			FBlobEntry& Blob = Bucket.AddDefaulted_GetRef();
+			Blob.Data = &ByteData;
+			Blob.Bytes = ByteData.Num();
+			Blob.Records.Add(RecordIndex);
+		}
+
+		/**
+		 * Walks the tagged property stream at the start of a record's byte data.
+		 * Anything after the terminating tag (native data, and the component streams of records written before components were keyed) is attributed to <Other>.
+		 */
+		void AddProperties(const FString& ClassName, const TArray<uint8>& ByteData)
+		{
+			FMemoryReader MemoryReader(ByteData);
+			FObjectAndNameAsStringProxyArchive Archive(MemoryReader, false);
+			Archive.ArIsSaveGame = true;
+
+			while (!Archive.AtEnd())
+			{
+				const int64 TagStart = Archive.Tell();
+
+				FPropertyTag Tag;
+				Archive << Tag;
+
+				if (Archive.IsError() || Tag.Name.IsNone())
+					break;
+
+				const int64 ValueStart = Archive.Tell();
+				if (Tag.Size < 0 || ValueStart + Tag.Size > ByteData.Num())
+				{
+					Archive.Seek(TagStart);
+					break;
+				}
+
+				Properties.FindOrAdd(ClassName + TEXT(":") + Tag.Name.ToString()).Add(ValueStart - TagStart + Tag.Size);
+				Archive.Seek(ValueStart + Tag.Size);
+			}
+
+			const int64 Remaining = ByteData.Num() - Archive.Tell();
+			if (Remaining > 0)
+				Properties.FindOrAdd(ClassName + TEXT(":<Other>")).Add(Remaining);
+		}
+
+		TArray<int32> GetLargestRecords(const int32 Top) const
+		{
+			TArray<int32> Indices;
+			for (int32 i = 0; i < Records.Num(); ++i)
+				Indices.Add(i);
+
+			Indices.Sort([this](const int32 A, const int32 B) { return Records[A].Bytes > Records[B].Bytes; });
+			if (Indices.Num() > Top)
+				Indices.SetNum(Top);
+
+			return Indices;
+		}
+
+		TArray<const FBlobEntry*> GetDuplicateBlobs() const
+		{
+			TArray<const FBlobEntry*> Duplicates;
+			for (const auto& Pair : Blobs)
+			{
+				for (const FBlobEntry& Blob : Pair.Value)
+				{
+					if (Blob.Records.Num() > 1)
+						Duplicates.Add(&Blob);
+				}
+			}
+
+			Duplicates.Sort([](const FBlobEntry& A, const FBlobEntry& B)
+			{
+				return A.Bytes * (A.Records.Num() - 1) > B.Bytes * (B.Records.Num() - 1);
+			});
+
+			return Duplicates;
+		}
+
+		TArray<int32> GetOversizedRecords() const
+		{
+			TArray<int32> Indices;
+			for (int32 i = 0; i < Records.Num(); ++i)
+			{
+				if (Records[i].Bytes > OversizedBytes)
+					Indices.Add(i);
+			}
+
+			Indices.Sort([this](const int32 A, const int32 B) { return Records[A].Bytes > Records[B].Bytes; });
+			return Indices;
+		}
+
+		static TArray<TPair<FString, FSizeEntry>> SortSizes(const TMap<FString, FSizeEntry>& Sizes)
+		{
+			TArray<TPair<FString, FSizeEntry>> Sorted = Sizes.Array();
+			Sorted.Sort([](const TPair<FString, FSizeEntry>& A, const TPair<FString, FSizeEntry>& B) { return A.Value.Bytes > B.Value.Bytes; });
+			return Sorted;
+		}
+
+		static void AppendSizes(FString& Out, const TCHAR* Title, const TMap<FString, FSizeEntry>& Sizes, const int32 Top)
+		{
+			const TArray<TPair<FString, FSizeEntry>> Sorted = SortSizes(Sizes);
+
+			Out += FString::Printf(TEXT("\n%s (top %d of %d)\n"), Title, FMath::Min(Top, Sorted.Num()), Sorted.Num());
+			for (int32 i = 0; i < Sorted.Num() && i < Top; ++i)
+			{
+				const FSizeEntry& Entry = Sorted[i].Value;
+				Out += FString::Printf(TEXT("  %12lld bytes  %7d records  max %10lld  %s\n"), Entry.Bytes, Entry.Count, Entry.MaxBytes, *Sorted[i].Key);
+			}
+		}
+
+		static TArray<TSharedPtr<FJsonValue>> SizesToJson(const TMap<FString, FSizeEntry>& Sizes, const int32 Top)
+		{
+			const TArray<TPair<FString, FSizeEntry>> Sorted = SortSizes(Sizes);
+
+			TArray<TSharedPtr<FJsonValue>> Values;
+			for (int32 i = 0; i < Sorted.Num() && i < Top; ++i)
+			{
+				TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+				Object->SetStringField(TEXT("name"), Sorted[i].Key);
+				Object->SetNumberField(TEXT("bytes"), Sorted[i].Value.Bytes);
+				Object->SetNumberField(TEXT("count"), Sorted[i].Value.Count);
+				Object->SetNumberField(TEXT("maxBytes"), Sorted[i].Value.MaxBytes);
+				Values.Add(MakeShared<FJsonValueObject>(Object));
+			}
+
+			return Values;
+		}
+
+		static TSharedRef<FJsonObject> RecordToJson(const FRecordEntry& Record)
+		{
+			TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+			Object->SetStringField(TEXT("kind"), Record.Kind);
+			Object->SetStringField(TEXT("world"), Record.World);
+			Object->SetStringField(TEXT("level"), Record.Level);
+			Object->SetStringField(TEXT("id"), Record.Id);
+			Object->SetStringField(TEXT("class"), Record.Class);
+			Object->SetNumberField(TEXT("bytes"), Record.Bytes);
+			return Object;
+		}
+
+		int64 OversizedBytes;
+		TArray<FRecordEntry> Records;
+		TMap<FString, FSizeEntry> Worlds;
+		TMap<FString, FSizeEntry> Levels;
+		TMap<FString, FSizeEntry> Classes;
+		TMap<FString, FSizeEntry> Properties;
+		TMap<uint64 /*Hash*/, TArray<FBlobEntry>> Blobs;
+	};
+}
+
+UEssAnalyzeCommandlet::UEssAnalyzeCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UEssAnalyzeCommandlet::Main(const FString& Params)
+{
+	FString SlotName;
+	FString FilePath;
+	int32 UserIndex = 0;
+	FParse::Value(*Params, TEXT("Slot="), SlotName);
+	FParse::Value(*Params, TEXT("File="), FilePath);
+	FParse::Value(*Params, TEXT("UserIndex="), UserIndex);
+
+	FString Format = TEXT("Text");
+	FParse::Value(*Params, TEXT("Format="), Format);
+
+	int32 Top = 20;
+	FParse::Value(*Params, TEXT("Top="), Top);
+	Top = FMath::Max(1, Top);
+
+	int64 OversizedBytes = 64 * 1024;
+	FParse::Value(*Params, TEXT("OversizedBytes="), OversizedBytes);
+
+	TArray<uint8> Bytes;
+	if (!FilePath.IsEmpty())
+	{
+		if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+		{
+			UE_LOG(LogEss, Error, TEXT("Save file %s could not be read."), *FilePath);
+			return 1;
+		}
+	}
+	else if (SlotName.IsEmpty() || !FEssStorage::Get()->Read(SlotName, UserIndex, Bytes))
+	{
+		UE_LOG(LogEss, Error, TEXT("Save slot could not be read. Pass -Slot=<SlotName> or -File=<Path>."));
+		return 1;
+	}
+
+	UEssSaveGame* SaveGame = Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromMemory(Bytes));
+	if (!IsValid(SaveGame))
+	{
+		UE_LOG(LogEss, Error, TEXT("Save data is not an ESS save game."));
+		return 1;
+	}
+
+	EssAnalyze::FSaveAnalysis Analysis(OversizedBytes);
+	Analysis.Analyze(SaveGame);
+
+	const FString Report = Format.Equals(TEXT("Json"), ESearchCase::IgnoreCase) ? Analysis.ToJson(Bytes.Num(), Top) : Analysis.ToText(Bytes.Num(), Top);
+
+	FString OutputPath;
+	if (FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		if (!FFileHelper::SaveStringToFile(Report, *OutputPath))
+		{
+			UE_LOG(LogEss, Error, TEXT("Report could not be written to %s."), *OutputPath);
+			return 1;
+		}
+
+		UE_LOG(LogEss, Display, TEXT("Report written to %s."), *OutputPath);
+		return 0;
+	}
+
+	TArray<FString> Lines;
+	Report.ParseIntoArrayLines(Lines, false);
+	for (const FString& Line : Lines)
+		UE_LOG(LogEss, Display, TEXT("%s"), *Line);
+
+	return 0;
+}
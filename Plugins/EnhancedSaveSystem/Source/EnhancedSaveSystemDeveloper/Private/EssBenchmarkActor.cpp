@@ -0,0 +1,21 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssBenchmarkActor.h"
+#include "Components/SceneComponent.h"
+
+AEssBenchmarkActor::AEssBenchmarkActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AEssBenchmarkActor::InitializeState(const int32 Seed, const int32 PayloadSize)
+{
+	Counter = Seed;
+	Velocity = FVector(Seed % 100, Seed % 37, Seed % 11);
+	Tag = FName(TEXT("EssBenchmark"), Seed % 16);
+
+	Payload.SetNumUninitialized(PayloadSize);
+	for (int32 i = 0; i < PayloadSize; ++i)
+		Payload[i] = static_cast<uint8>((Seed + i) * 31);
+}
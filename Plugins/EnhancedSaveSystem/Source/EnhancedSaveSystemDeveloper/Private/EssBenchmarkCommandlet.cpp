@@ -0,0 +1,426 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssBenchmarkCommandlet.h"
+
+#include "EssBenchmarkActor.h"
+#include "EssRecordIndex.h"
+#include "EssStats.h"
+#include "EssStorage.h"
+#include "EssSubsystem.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProperties.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include <atomic>
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#elif PLATFORM_UNIX
+#include <time.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogEssBenchmark, Log, All);
+
+namespace EssBenchmark
+{
+	const TCHAR* SlotName = TEXT("EssBenchmark");
+
+	/**
+	 * Forwards to the engine allocator and counts the calls the installing thread makes through it.
+	 * Installed in front of GMalloc only for the duration of a measurement, during which it sees the allocations of the whole process.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		void Install()
+		{
+			Allocations = 0;
+			Reallocations = 0;
+			AllocatedBytes = 0;
+			ThreadId = FPlatformTLS::GetCurrentThreadId();
+			Inner = GMalloc;
+			GMalloc = this;
+		}
+
+		void Uninstall()
+		{
+			GMalloc = Inner;
+		}
+
+		void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			// Other threads, e.g. the task graph writing record indices or the memory sampler, would make the counts vary between runs
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				Allocations.fetch_add(1, std::memory_order_relaxed);
+				AllocatedBytes.fetch_add(Count, std::memory_order_relaxed);
+			}
+
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				Reallocations.fetch_add(1, std::memory_order_relaxed);
+				AllocatedBytes.fetch_add(Count, std::memory_order_relaxed);
+			}
+
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		void Free(void* Original) override { Inner->Free(Original); }
+		SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		void UpdateStats() override { Inner->UpdateStats(); }
+		void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		const TCHAR* GetDescriptiveName() override { return TEXT("EssBenchmarkCountingMalloc"); }
+
+		std::atomic<uint64> Allocations{0};
+		std::atomic<uint64> Reallocations{0};
+		std::atomic<uint64> AllocatedBytes{0};
+
+	private:
+		FMalloc* Inner = nullptr;
+		uint32 ThreadId = 0;
+	};
+
+	struct FMeasurement
+	{
+		double WallMs = 0.0;
+		double GameThreadCpuMs = 0.0;
+		uint64 Allocations = 0;
+		uint64 Reallocations = 0;
+		uint64 AllocatedBytes = 0;
+		int64 UsedPhysicalDeltaBytes = 0;
+
+		/** Highest used physical memory sampled during the measurement, in 1 ms steps. */
+		uint64 PeakUsedPhysicalBytes = 0;
+		bool bSucceeded = false;
+	};
+
+	double GetThreadCpuSeconds()
+	{
+#if PLATFORM_WINDOWS
+		FILETIME CreationTime, ExitTime, KernelTime, UserTime;
+		if (::GetThreadTimes(::GetCurrentThread(), &CreationTime, &ExitTime, &KernelTime, &UserTime))
+		{
+			const uint64 Kernel = (uint64(KernelTime.dwHighDateTime) << 32) | KernelTime.dwLowDateTime;
+			const uint64 User = (uint64(UserTime.dwHighDateTime) << 32) | UserTime.dwLowDateTime;
+			return double(Kernel + User) * 1e-7;
+		}
+#elif PLATFORM_UNIX
+		timespec Time;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time) == 0)
+			return double(Time.tv_sec) + double(Time.tv_nsec) * 1e-9;
+#endif
+		return FPlatformTime::Seconds();
+	}
+
+	/**
+	 * Polls the used physical memory on its own thread for the duration of a measurement.
+	 * PeakUsedPhysical of the platform memory stats is the peak of the whole process, so it can't tell one measurement from another.
+	 */
+	class FPeakMemorySampler
+	{
+	public:
+		explicit FPeakMemorySampler(const uint64 InitialBytes)
+			: PeakBytes(InitialBytes)
+		{
+			// Started before the counting allocator is installed, so creating the thread isn't counted
+			Sampler = Async(EAsyncExecution::Thread, [this]()
+			{
+				while (!bStopped.load(std::memory_order_relaxed))
+				{
+					Sample(FPlatformMemory::GetStats().UsedPhysical);
+					FPlatformProcess::Sleep(0.001f);
+				}
+			});
+		}
+
+		uint64 Stop(const uint64 FinalBytes)
+		{
+			bStopped = true;
+			Sampler.Wait();
+			Sample(FinalBytes);
+			return PeakBytes;
+		}
+
+	private:
+		void Sample(const uint64 Bytes)
+		{
+			uint64 Peak = PeakBytes.load(std::memory_order_relaxed);
+			while (Bytes > Peak && !PeakBytes.compare_exchange_weak(Peak, Bytes, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		std::atomic<uint64> PeakBytes;
+		std::atomic<bool> bStopped{false};
+		TFuture<void> Sampler;
+	};
+
+	template <typename FunctionType>
+	FMeasurement Measure(FunctionType&& Function)
+	{
+		// Never destroyed so that late frees through a stale GMalloc read stay valid
+		static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+
+		FMeasurement Measurement;
+		const FPlatformMemoryStats MemoryBefore = FPlatformMemory::GetStats();
+		FPeakMemorySampler PeakMemorySampler(MemoryBefore.UsedPhysical);
+
+		CountingMalloc->Install();
+		const double CpuStart = GetThreadCpuSeconds();
+		const double WallStart = FPlatformTime::Seconds();
+
+		Measurement.bSucceeded = Function();
+
+		Measurement.WallMs = (FPlatformTime::Seconds() - WallStart) * 1000.0;
+		Measurement.GameThreadCpuMs = (GetThreadCpuSeconds() - CpuStart) * 1000.0;
+		CountingMalloc->Uninstall();
+
+		const FPlatformMemoryStats MemoryAfter = FPlatformMemory::GetStats();
+		Measurement.Allocations = CountingMalloc->Allocations;
+		Measurement.Reallocations = CountingMalloc->Reallocations;
+		Measurement.AllocatedBytes = CountingMalloc->AllocatedBytes;
+		Measurement.UsedPhysicalDeltaBytes = int64(MemoryAfter.UsedPhysical) - int64(MemoryBefore.UsedPhysical);
+		Measurement.PeakUsedPhysicalBytes = PeakMemorySampler.Stop(MemoryAfter.UsedPhysical);
+
+		return Measurement;
+	}
+
+	TSharedRef<FJsonObject> ToJson(const FMeasurement& Measurement)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetBoolField(TEXT("succeeded"), Measurement.bSucceeded);
+		Object->SetNumberField(TEXT("wallMs"), Measurement.WallMs);
+		Object->SetNumberField(TEXT("gameThreadCpuMs"), Measurement.GameThreadCpuMs);
+		Object->SetNumberField(TEXT("gameThreadAllocations"), Measurement.Allocations);
+		Object->SetNumberField(TEXT("gameThreadReallocations"), Measurement.Reallocations);
+		Object->SetNumberField(TEXT("gameThreadAllocatedBytes"), Measurement.AllocatedBytes);
+		Object->SetNumberField(TEXT("usedPhysicalDeltaBytes"), Measurement.UsedPhysicalDeltaBytes);
+		Object->SetNumberField(TEXT("peakUsedPhysicalBytes"), Measurement.PeakUsedPhysicalBytes);
+		return Object;
+	}
+
+	double Median(TArray<double> Values)
+	{
+		if (Values.IsEmpty())
+			return 0.0;
+
+		Values.Sort();
+		const int32 Middle = Values.Num() / 2;
+		return Values.Num() % 2 ? Values[Middle] : (Values[Middle - 1] + Values[Middle]) * 0.5;
+	}
+
+	/**
+	 * @return Size of the record index of the slot, zero if it has none. Read through the active backend, like the slot itself.
+	 */
+	int64 GetRecordIndexBytes()
+	{
+		const TSharedRef<IEssStorageBackend> Storage = FEssStorage::Get();
+		const FString IndexSlotName = FEssRecordIndex::GetSlotName(SlotName);
+
+		TArray<uint8> Bytes;
+		return Storage->DoesSlotExist(IndexSlotName, 0) && Storage->Read(IndexSlotName, 0, Bytes) ? Bytes.Num() : 0;
+	}
+
+	void DeleteSlot()
+	{
+		FEssRecordIndex::Delete(SlotName, 0);
+		if (FEssStorage::Get()->DoesSlotExist(SlotName, 0))
+			FEssStorage::Get()->Delete(SlotName, 0);
+	}
+}
+
+UEssBenchmarkCommandlet::UEssBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UEssBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<int32> Counts = { 1000, 10000, 100000 };
+
+	FString CountsString;
+	if (FParse::Value(*Params, TEXT("Counts="), CountsString, false))
+	{
+		TArray<FString> Parts;
+		CountsString.ParseIntoArray(Parts, TEXT(","));
+
+		Counts.Reset();
+		for (const FString& Part : Parts)
+		{
+			const int32 Count = FCString::Atoi(*Part);
+			if (Count > 0)
+				Counts.Add(Count);
+		}
+	}
+
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("MinStateBytes="), MinStateBytes);
+	FParse::Value(*Params, TEXT("MaxStateBytes="), MaxStateBytes);
+	FParse::Value(*Params, TEXT("PlacedRatio="), PlacedRatio);
+
+	Iterations = FMath::Max(1, Iterations);
+	MinStateBytes = FMath::Max(0, MinStateBytes);
+	MaxStateBytes = FMath::Max(MinStateBytes, MaxStateBytes);
+	PlacedRatio = FMath::Clamp(PlacedRatio, 0.f, 1.f);
+
+	FString StorageBackend;
+	if (FParse::Value(*Params, TEXT("StorageBackend="), StorageBackend) && !FEssStorage::SetBackend(FName(*StorageBackend)))
+	{
+		UE_LOG(LogEssBenchmark, Error, TEXT("Storage backend %s does not exist."), *StorageBackend);
+		return 1;
+	}
+
+	FString OutputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+		OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("EssBenchmark-%s.json"), *FDateTime::Now().ToString());
+
+	bool bSucceeded = true;
+	TArray<TSharedPtr<FJsonValue>> Tiers;
+	for (const int32 Count : Counts)
+	{
+		UE_LOG(LogEssBenchmark, Display, TEXT("Running tier with %d actors."), Count);
+		Tiers.Add(MakeShared<FJsonValueObject>(RunTier(Count, bSucceeded)));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("benchmark"), TEXT("EssBenchmark"));
+	Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+	Root->SetStringField(TEXT("buildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetNumberField(TEXT("iterations"), Iterations);
+	Root->SetNumberField(TEXT("minStateBytes"), MinStateBytes);
+	Root->SetNumberField(TEXT("maxStateBytes"), MaxStateBytes);
+	Root->SetNumberField(TEXT("placedRatio"), PlacedRatio);
+	Root->SetStringField(TEXT("storageBackend"), FEssStorage::GetBackendName().ToString());
+	Root->SetArrayField(TEXT("tiers"), Tiers);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogEssBenchmark, Error, TEXT("Results could not be written to %s."), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogEssBenchmark, Display, TEXT("Results written to %s."), *OutputPath);
+	return bSucceeded ? 0 : 1;
+}
+
+TSharedRef<FJsonObject> UEssBenchmarkCommandlet::RunTier(const int32 ActorCount, bool& bOutSucceeded)
+{
+	EssBenchmark::DeleteSlot();
+
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->InitializeStandalone(TEXT("EssBenchmarkWorld"));
+
+	UWorld* World = GameInstance->GetWorld();
+	UEssSubsystem* Subsystem = GameInstance->GetSubsystem<UEssSubsystem>();
+
+	const int32 PlacedCount = FMath::RoundToInt32(ActorCount * PlacedRatio);
+	const int32 StateRange = MaxStateBytes - MinStateBytes + 1;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 i = 0; i < ActorCount; ++i)
+	{
+		const bool bPlaced = i < PlacedCount;
+		SpawnParams.Name = bPlaced ? FName(TEXT("EssBenchmarkPlaced"), i + 1) : NAME_None;
+
+		const FTransform Transform(FVector(i % 1000, (i / 1000) % 1000, i / 1000000) * 100.0);
+		AEssBenchmarkActor* Actor = World->SpawnActor<AEssBenchmarkActor>(AEssBenchmarkActor::StaticClass(), Transform, SpawnParams);
+		if (!IsValid(Actor))
+			continue;
+
+		// Placed actors are the ones loaded with their level
+		if (bPlaced)
+			Actor->SetFlags(RF_WasLoaded);
+
+		// Spread state sizes across the range with a cheap deterministic hash
+		Actor->InitializeState(i, MinStateBytes + int32((uint32(i) * 2654435761u) % uint32(StateRange)));
+	}
+
+	TArray<double> SaveWallMs;
+	TArray<double> LoadWallMs;
+	TArray<TSharedPtr<FJsonValue>> Runs;
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		EssBenchmark::FMeasurement Save = EssBenchmark::Measure([&]() { return Subsystem->SaveWorld(EssBenchmark::SlotName, 0); });
+
+		// The bytes the save handed to the storage backend, wherever the backend puts them
+		const TArray<FEssOperationTiming> Timings = FEssStats::Get().GetRecentTimings(1);
+		const int64 FileBytes = Save.bSucceeded && Timings.Num() > 0 ? Timings[0].FileBytes : 0;
+
+		// Record indices are written in the background after the save, outside of the measurement
+		Subsystem->WaitForRecordIndexWrites();
+		const int64 RecordIndexBytes = EssBenchmark::GetRecordIndexBytes();
+
+		CollectGarbage(RF_NoFlags);
+
+		EssBenchmark::FMeasurement Load = EssBenchmark::Measure([&]() { return Subsystem->LoadWorld(EssBenchmark::SlotName, 0); });
+
+		CollectGarbage(RF_NoFlags);
+
+		bOutSucceeded &= Save.bSucceeded && Load.bSucceeded;
+		SaveWallMs.Add(Save.WallMs);
+		LoadWallMs.Add(Load.WallMs);
+
+		TSharedRef<FJsonObject> Run = MakeShared<FJsonObject>();
+		Run->SetNumberField(TEXT("iteration"), Iteration);
+		Run->SetNumberField(TEXT("fileBytes"), FileBytes);
+		Run->SetNumberField(TEXT("recordIndexBytes"), RecordIndexBytes);
+		Run->SetObjectField(TEXT("save"), EssBenchmark::ToJson(Save));
+		Run->SetObjectField(TEXT("load"), EssBenchmark::ToJson(Load));
+		Runs.Add(MakeShared<FJsonValueObject>(Run));
+
+		UE_LOG(LogEssBenchmark, Display, TEXT("Actors %d, iteration %d: save %.2f ms, load %.2f ms, %lld bytes written, %lld bytes of record index."),
+			ActorCount, Iteration, Save.WallMs, Load.WallMs, FileBytes, RecordIndexBytes);
+	}
+
+	TSharedRef<FJsonObject> Tier = MakeShared<FJsonObject>();
+	Tier->SetNumberField(TEXT("actors"), ActorCount);
+	Tier->SetNumberField(TEXT("placedActors"), PlacedCount);
+	Tier->SetNumberField(TEXT("runtimeActors"), ActorCount - PlacedCount);
+	Tier->SetNumberField(TEXT("saveWallMsMin"), FMath::Min(SaveWallMs));
+	Tier->SetNumberField(TEXT("saveWallMsMedian"), EssBenchmark::Median(SaveWallMs));
+	Tier->SetNumberField(TEXT("loadWallMsMin"), FMath::Min(LoadWallMs));
+	Tier->SetNumberField(TEXT("loadWallMsMedian"), EssBenchmark::Median(LoadWallMs));
+	Tier->SetArrayField(TEXT("runs"), Runs);
+
+	GameInstance->Shutdown();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(RF_NoFlags);
+
+	EssBenchmark::DeleteSlot();
+
+	return Tier;
+}
@@ -0,0 +1,167 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSettings.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssAsyncLoadTests
+{
+	constexpr int32 SavedValue = 1;
+	constexpr int32 ChangedValue = 2;
+	constexpr int32 NumLowPriorityActors = 10;
+	constexpr double Timeout = 30.0;
+
+	/**
+	 * State of the test, kept alive across frames by its latent command.
+	 */
+	struct FState
+	{
+		// Without a budget each frame restores a single actor
+		TGuardValue<float> RestoreBudgetMs{ GetMutableDefault<UEssSettings>()->RestoreBudgetMs, 0.f };
+
+		TUniquePtr<EssTests::FTestWorld> TestWorld;
+		TStrongObjectPtr<UEssTestLoadListener> Listener;
+
+		/** Restored before the world is playable: a high priority actor and one of the default priority, which is within reach without any viewpoint. */
+		TArray<AEssTestActor*> PlayableActors;
+
+		/** Restored after the world is playable, those of priority -1 before those of priority -2. */
+		TArray<AEssTestActor*> DeferredActors;
+		TArray<AEssTestActor*> LastActors;
+
+		bool bPlayable = false;
+		bool bLoaded = false;
+		int32 NumFramesAfterPlayable = 0;
+		double StartTime = 0.0;
+	};
+
+	int32 GetNumRestored(const TArray<AEssTestActor*>& Actors)
+	{
+		int32 Num = 0;
+		for (const AEssTestActor* Actor : Actors)
+		{
+			if (Actor->Value == SavedValue)
+				++Num;
+		}
+
+		return Num;
+	}
+
+	/**
+	 * Checks every frame that deferred actors are restored in order of their priority, until the world has been loaded.
+	 */
+	class FWaitForRestoreCommand : public IAutomationLatentCommand
+	{
+	public:
+		FWaitForRestoreCommand(FAutomationTestBase* InTest, const TSharedRef<FState>& InState)
+			: Test(InTest)
+			, State(InState)
+		{
+		}
+
+		virtual bool Update() override
+		{
+			if (FPlatformTime::Seconds() - State->StartTime > Timeout)
+			{
+				Test->AddError(TEXT("World not loaded in time."));
+				return true;
+			}
+
+			if (!State->bPlayable)
+				return false;
+
+			++State->NumFramesAfterPlayable;
+
+			if (GetNumRestored(State->LastActors) > 0 && GetNumRestored(State->DeferredActors) < State->DeferredActors.Num())
+				Test->AddError(TEXT("Actor of priority -2 restored before all actors of priority -1."));
+
+			if (!State->bLoaded)
+				return false;
+
+			Test->TestEqual(TEXT("Deferred actors restored"), GetNumRestored(State->DeferredActors), State->DeferredActors.Num());
+			Test->TestEqual(TEXT("Last actors restored"), GetNumRestored(State->LastActors), State->LastActors.Num());
+
+			// One actor per frame, the deferred actors take a frame each
+			Test->TestTrue(TEXT("Deferred actors restored over several frames"), State->NumFramesAfterPlayable > 1);
+			return true;
+		}
+
+	private:
+		FAutomationTestBase* Test;
+		TSharedRef<FState> State;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssAsyncLoadTest, "EnhancedSaveSystem.RoundTrip.AsyncLoad",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssAsyncLoadTest::RunTest(const FString& Parameters)
+{
+	using namespace EssAsyncLoadTests;
+
+	const TSharedRef<FState> State = MakeShared<FState>();
+	State->TestWorld = MakeUnique<EssTests::FTestWorld>();
+	EssTests::FTestWorld& TestWorld = *State->TestWorld;
+
+	AEssTestActor* HighPriorityActor = TestWorld.SpawnPlacedActor(TEXT("EssTestHighPriority"), SavedValue);
+	HighPriorityActor->RestorePriority = 1;
+	State->PlayableActors.Add(HighPriorityActor);
+	State->PlayableActors.Add(TestWorld.SpawnPlacedActor(TEXT("EssTestDefaultPriority"), SavedValue));
+
+	for (int32 i = 0; i < NumLowPriorityActors; ++i)
+	{
+		AEssTestActor* DeferredActor = TestWorld.SpawnPlacedActor(*FString::Printf(TEXT("EssTestDeferred%d"), i), SavedValue);
+		DeferredActor->RestorePriority = -1;
+		State->DeferredActors.Add(DeferredActor);
+
+		AEssTestActor* LastActor = TestWorld.SpawnPlacedActor(*FString::Printf(TEXT("EssTestLast%d"), i), SavedValue);
+		LastActor->RestorePriority = -2;
+		State->LastActors.Add(LastActor);
+	}
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	for (AEssTestActor* Actor : State->PlayableActors)
+		Actor->Value = ChangedValue;
+	for (AEssTestActor* Actor : State->DeferredActors)
+		Actor->Value = ChangedValue;
+	for (AEssTestActor* Actor : State->LastActors)
+		Actor->Value = ChangedValue;
+
+	// The listener is owned by the state, so it doesn't keep the state alive
+	FState* StatePtr = &State.Get();
+	State->Listener.Reset(NewObject<UEssTestLoadListener>());
+	State->Listener->OnPlayableCallback = [this, StatePtr](bool bSucceeded)
+	{
+		TestTrue(TEXT("World playable"), bSucceeded);
+		TestEqual(TEXT("Playable actors restored before OnPlayable"), GetNumRestored(StatePtr->PlayableActors), StatePtr->PlayableActors.Num());
+		TestEqual(TEXT("Deferred actors not restored before OnPlayable"), GetNumRestored(StatePtr->DeferredActors) + GetNumRestored(StatePtr->LastActors), 0);
+		StatePtr->bPlayable = true;
+	};
+	State->Listener->OnLoadedCallback = [this, StatePtr](bool bSucceeded)
+	{
+		TestTrue(TEXT("World loaded"), bSucceeded);
+		TestTrue(TEXT("OnPlayable called before OnLoaded"), StatePtr->bPlayable);
+		StatePtr->bLoaded = true;
+	};
+
+	FEssWorldLoadedDelegate OnPlayable;
+	OnPlayable.BindUFunction(State->Listener.Get(), GET_FUNCTION_NAME_CHECKED(UEssTestLoadListener, OnPlayable));
+	FEssWorldLoadedDelegate OnLoaded;
+	OnLoaded.BindUFunction(State->Listener.Get(), GET_FUNCTION_NAME_CHECKED(UEssTestLoadListener, OnLoaded));
+
+	State->StartTime = FPlatformTime::Seconds();
+	if (!TestTrue(TEXT("World load started"), TestWorld.Subsystem->LoadWorldAsync(EssTests::SlotName, 0, OnPlayable, OnLoaded)))
+		return false;
+
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForRestoreCommand(this, State));
+	return true;
+}
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSettings.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "EssUtil.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssElisionTest, "EnhancedSaveSystem.RoundTrip.Elision",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssElisionTest::RunTest(const FString& Parameters)
+{
+	TGuardValue<bool> ElideDefaultPlacedActors(GetMutableDefault<UEssSettings>()->bElideDefaultPlacedActors, true);
+
+	EssTests::FTestWorld TestWorld;
+	const FString LevelName = EssUtil::GetLevelName(TestWorld.World->PersistentLevel);
+
+	AEssTestActor* ChangedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestChanged"), 1);
+	AEssTestActor* UnchangedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestUnchanged"), 2);
+	AEssTestActor* DestroyedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestDestroyed"), 3);
+
+	// The first save registers the level, which captures the baselines of its placed actors
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	ChangedActor->Value = 10;
+	DestroyedActor->Destroy();
+
+	if (!TestTrue(TEXT("World saved again"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	FEssRecordInfo Info;
+	TestTrue(TEXT("Changed actor has a record"), TestWorld.Subsystem->PeekRecord(EEssRecordKind::PlacedActor, LevelName, TEXT("EssTestChanged"), EssTests::SlotName, Info));
+	TestTrue(TEXT("Changed actor record takes space"), Info.ByteSize > 0);
+
+	if (TestTrue(TEXT("Unchanged actor found"), TestWorld.Subsystem->PeekRecord(EEssRecordKind::PlacedActor, LevelName, TEXT("EssTestUnchanged"), EssTests::SlotName, Info)))
+		TestEqual(TEXT("Unchanged actor record takes no space"), Info.ByteSize, static_cast<int64>(0));
+
+	TestFalse(TEXT("Destroyed actor not found"), TestWorld.Subsystem->PeekRecord(EEssRecordKind::PlacedActor, LevelName, TEXT("EssTestDestroyed"), EssTests::SlotName, Info));
+
+	// Baselines captured during the current frame are trusted to match, gameplay only changes the actors in later frames
+	++GFrameCounter;
+
+	ChangedActor->Value = 100;
+	UnchangedActor->Value = 200;
+
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	TestEqual(TEXT("Changed actor restored from its record"), ChangedActor->Value, 10);
+	TestEqual(TEXT("Unchanged actor reset to its baseline"), UnchangedActor->Value, 2);
+	TestNull(TEXT("Destroyed actor stays destroyed"), TestWorld.FindActor(FName(TEXT("EssTestDestroyed"))));
+
+	// Single actors follow the level's elision as well
+	UnchangedActor->Value = 300;
+	if (TestTrue(TEXT("Unchanged actor loaded"), TestWorld.Subsystem->LoadPlacedActor(LevelName, TEXT("EssTestUnchanged"), EssTests::SlotName)))
+		TestEqual(TEXT("Unchanged actor reset to its baseline by LoadPlacedActor"), UnchangedActor->Value, 2);
+
+	TestTrue(TEXT("Destroyed actor loaded"), TestWorld.Subsystem->LoadPlacedActor(LevelName, TEXT("EssTestDestroyed"), EssTests::SlotName));
+	TestNull(TEXT("Destroyed actor stays destroyed after LoadPlacedActor"), TestWorld.FindActor(FName(TEXT("EssTestDestroyed"))));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,89 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssInstances.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssInstancesTests
+{
+	/**
+	 * @return World transforms of the component's instances, sorted by location, as their order isn't kept.
+	 */
+	TArray<FTransform> GetInstanceTransforms(const UInstancedStaticMeshComponent* Component)
+	{
+		TArray<FTransform> Transforms;
+		for (int32 i = 0; i < Component->GetInstanceCount(); ++i)
+			Component->GetInstanceTransform(i, Transforms.AddDefaulted_GetRef(), true);
+
+		Transforms.Sort([](const FTransform& A, const FTransform& B)
+		{
+			const FVector LocationA = A.GetLocation();
+			const FVector LocationB = B.GetLocation();
+			return LocationA.X != LocationB.X ? LocationA.X < LocationB.X : LocationA.Y < LocationB.Y;
+		});
+
+		return Transforms;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssInstancesRoundTripTest, "EnhancedSaveSystem.RoundTrip.Instances",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssInstancesRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace EssInstancesTests;
+
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestActor* Actor = TestWorld.SpawnPlacedActor(TEXT("EssTestInstanced"), 1);
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(Actor, TEXT("EssTestInstances"));
+	Component->ComponentTags.Add(FEssInstances::ComponentTag);
+	Component->SetupAttachment(Actor->GetRootComponent());
+	Component->RegisterComponent();
+
+	for (int32 i = 0; i < 4; ++i)
+		Component->AddInstance(FTransform(FVector(i * 100.f, 0.f, 0.f)), true);
+
+	// The first save registers the level, which captures the instances the component has now as its level-authored ones
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	Component->RemoveInstance(1);
+
+	// Index 1 is now the instance authored at 200
+	const FTransform MovedTransform(FRotator(0.f, 90.f, 0.f), FVector(250.f, 50.f, 10.f), FVector(2.f, 2.f, 2.f));
+	Component->UpdateInstanceTransform(1, MovedTransform, true);
+
+	const FTransform AddedTransformA(FVector(500.f, 0.f, 0.f));
+	const FTransform AddedTransformB(FRotator(45.f, 0.f, 0.f), FVector(600.f, -100.f, 0.f));
+	Component->AddInstance(AddedTransformA, true);
+	Component->AddInstance(AddedTransformB, true);
+
+	const TArray<FTransform> SavedTransforms = GetInstanceTransforms(Component);
+
+	if (!TestTrue(TEXT("World saved again"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	Component->ClearInstances();
+	Component->AddInstance(FTransform(FVector(1000.f, 0.f, 0.f)), true);
+
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	const TArray<FTransform> RestoredTransforms = GetInstanceTransforms(Component);
+	if (!TestEqual(TEXT("Instances restored"), RestoredTransforms.Num(), 5) || !TestEqual(TEXT("Instances as saved"), RestoredTransforms.Num(), SavedTransforms.Num()))
+		return false;
+
+	// Instances are saved as floats
+	for (int32 i = 0; i < SavedTransforms.Num(); ++i)
+		TestTrue(FString::Printf(TEXT("Instance %d transform"), i), RestoredTransforms[i].Equals(SavedTransforms[i], 0.01));
+
+	return true;
+}
+
+#endif
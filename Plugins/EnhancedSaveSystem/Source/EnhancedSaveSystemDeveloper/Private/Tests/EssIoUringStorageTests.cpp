@@ -0,0 +1,144 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssStorage.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && PLATFORM_LINUX
+
+namespace EssIoUringStorageTests
+{
+	const TCHAR* BlockedSlotName = TEXT("EssIoUringTestBlocked");
+
+	FString GetDirectory()
+	{
+		return FPaths::GetPath(FEssIoUringStorageBackend::GetFilePath(TEXT("EssIoUringTest")));
+	}
+
+	/**
+	 * Selects the io_uring backend and removes the test's files, until it goes out of scope.
+	 */
+	class FScopedIoUringBackend
+	{
+	public:
+		FScopedIoUringBackend()
+			: PreviousBackend(FEssStorage::GetBackendName())
+		{
+			FEssStorage::SetBackend(FEssStorage::IoUringBackend);
+			DeleteFiles();
+		}
+
+		~FScopedIoUringBackend()
+		{
+			DeleteFiles();
+			FEssStorage::SetBackend(PreviousBackend);
+		}
+
+	private:
+		static void DeleteFiles()
+		{
+			TArray<FString> FileNames;
+			IFileManager::Get().FindFiles(FileNames, *(GetDirectory() / TEXT("EssIoUringTest*")), true, false);
+			for (const FString& FileName : FileNames)
+				IFileManager::Get().Delete(*(GetDirectory() / FileName), false, true, true);
+
+			IFileManager::Get().DeleteDirectory(*FEssIoUringStorageBackend::GetFilePath(BlockedSlotName), false, true);
+		}
+
+		FName PreviousBackend;
+	};
+
+	TArray<uint8> MakeBytes(const int32 Num, const uint8 Seed)
+	{
+		TArray<uint8> Bytes;
+		Bytes.SetNumUninitialized(Num);
+		for (int32 i = 0; i < Num; ++i)
+			Bytes[i] = static_cast<uint8>(i * 31 + Seed);
+
+		return Bytes;
+	}
+
+	/**
+	 * @return Number of temporary files of the test's slots, which are only left behind by chains that never finished.
+	 */
+	int32 GetNumTempFiles()
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *(GetDirectory() / TEXT("EssIoUringTest*.tmp")), true, false);
+		return FileNames.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssIoUringStorageTest, "EnhancedSaveSystem.Storage.IoUring",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssIoUringStorageTest::RunTest(const FString& Parameters)
+{
+	using namespace EssIoUringStorageTests;
+
+	FScopedIoUringBackend ScopedBackend;
+	if (!TestEqual(TEXT("io_uring backend selected"), FEssStorage::GetBackendName(), FEssStorage::IoUringBackend))
+		return false;
+
+	const TSharedRef<IEssStorageBackend> Storage = FEssStorage::Get();
+
+	// Slots of a single chunk, of several chunks, and without any bytes
+	const TArray<FString> SlotNames = { TEXT("EssIoUringTest0"), TEXT("EssIoUringTest1"), TEXT("EssIoUringTest2"), TEXT("EssIoUringTest3") };
+	TArray<TArray<uint8>> SlotBytes = { MakeBytes(1000, 1), MakeBytes(3 * 1024 * 1024 + 17, 2), MakeBytes(64 * 1024, 3), TArray<uint8>() };
+
+	TArray<FEssSlotWrite> Writes;
+	for (int32 i = 0; i < SlotNames.Num(); ++i)
+	{
+		FEssSlotWrite& Write = Writes.AddDefaulted_GetRef();
+		Write.SlotName = SlotNames[i];
+		Write.Bytes = &SlotBytes[i];
+	}
+
+	Storage->WriteBatch(Writes);
+
+	for (int32 i = 0; i < SlotNames.Num(); ++i)
+	{
+		TestTrue(FString::Printf(TEXT("%s written"), *SlotNames[i]), Writes[i].bSucceeded);
+
+		TArray<uint8> ReadBytes;
+		if (TestTrue(FString::Printf(TEXT("%s read"), *SlotNames[i]), Storage->Read(SlotNames[i], 0, ReadBytes)))
+			TestTrue(FString::Printf(TEXT("%s read back unchanged"), *SlotNames[i]), ReadBytes == SlotBytes[i]);
+	}
+
+	TArray<uint8> RangeBytes;
+	if (TestTrue(TEXT("Range read"), Storage->ReadRange(SlotNames[1], 0, 1024 * 1024 - 8, 16, RangeBytes)))
+		TestTrue(TEXT("Range around the first chunk border read back unchanged"), FMemory::Memcmp(RangeBytes.GetData(), SlotBytes[1].GetData() + 1024 * 1024 - 8, 16) == 0);
+
+	// A directory in place of a slot can't be renamed over, so that slot's chain fails while the others of the batch are written
+	if (!TestTrue(TEXT("Blocking directory created"), IFileManager::Get().MakeDirectory(*FEssIoUringStorageBackend::GetFilePath(BlockedSlotName), true)))
+		return false;
+
+	const TArray<uint8> BlockedBytes = MakeBytes(2 * 1024 * 1024, 4);
+	SlotBytes[0] = MakeBytes(2000, 5);
+
+	Writes.Reset();
+	FEssSlotWrite& BlockedWrite = Writes.AddDefaulted_GetRef();
+	BlockedWrite.SlotName = BlockedSlotName;
+	BlockedWrite.Bytes = &BlockedBytes;
+	FEssSlotWrite& Rewrite = Writes.AddDefaulted_GetRef();
+	Rewrite.SlotName = SlotNames[0];
+	Rewrite.Bytes = &SlotBytes[0];
+
+	Storage->WriteBatch(Writes);
+
+	TestFalse(TEXT("Blocked slot not written"), Writes[0].bSucceeded);
+	TestTrue(TEXT("Blocked slot still a directory"), IFileManager::Get().DirectoryExists(*FEssIoUringStorageBackend::GetFilePath(BlockedSlotName)));
+	TestTrue(TEXT("Slot next to the blocked slot written"), Writes[1].bSucceeded);
+
+	TArray<uint8> ReadBytes;
+	if (TestTrue(TEXT("Rewritten slot read"), Storage->Read(SlotNames[0], 0, ReadBytes)))
+		TestTrue(TEXT("Rewritten slot read back unchanged"), ReadBytes == SlotBytes[0]);
+
+	// WriteBatch only returns once every chain has completed and its temporary file is renamed or removed
+	TestEqual(TEXT("No temporary files left"), GetNumTempFiles(), 0);
+
+	return true;
+}
+
+#endif
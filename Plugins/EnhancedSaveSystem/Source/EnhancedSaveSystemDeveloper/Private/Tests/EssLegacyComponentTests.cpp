@@ -0,0 +1,120 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSaveGame.h"
+#include "EssStorage.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssLegacyComponentTests
+{
+	/**
+	 * Writes a record's byte data like saves did before components were keyed: the actor's properties followed by its components in order.
+	 */
+	void WriteLegacyByteData(AEssTestActor* Actor, TArray<uint8>& OutBytes, TArray<FEssComponentData>& OutComponentsData, TArray<int32>& OutReferenceIndices)
+	{
+		OutBytes.Reset();
+		OutComponentsData.Reset();
+		OutReferenceIndices.Reset();
+
+		FMemoryWriter MemoryWriter(OutBytes);
+		FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
+		Archive.ArIsSaveGame = true;
+		Archive.ArNoDelta = true;
+
+		Actor->Serialize(Archive);
+		for (UActorComponent* Component : Actor->GetComponentsByInterface(UEssSavableInterface::StaticClass()))
+			Component->Serialize(Archive);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssLegacyComponentRecordsTest, "EnhancedSaveSystem.RoundTrip.LegacyComponentRecords",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssLegacyComponentRecordsTest::RunTest(const FString& Parameters)
+{
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestActor* RuntimeActor = TestWorld.SpawnRuntimeActor(1);
+	RuntimeActor->Component->Value = 10;
+	const FGuid RuntimeGuid = RuntimeActor->EssGuid;
+
+	AEssTestActor* PlacedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestPlaced"), 2);
+	PlacedActor->Component->Value = 20;
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	TArray<uint8> SlotBytes;
+	if (!TestTrue(TEXT("Slot read"), FEssStorage::Get()->Read(EssTests::SlotName, 0, SlotBytes)))
+		return false;
+
+	UEssSaveGame* SaveGame = Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromMemory(SlotBytes));
+	if (!TestNotNull(TEXT("Save game read"), SaveGame))
+		return false;
+
+	FEssSaveData* SaveData = SaveGame->SaveData.Find(EssTests::SlotName);
+	if (!TestNotNull(TEXT("Slot data found"), SaveData))
+		return false;
+
+	// Rewrite the records the way saves were written before components got their own records
+	int32 NumRewritten = 0;
+	for (auto& WorldPair : SaveData->WorldsData)
+	{
+		for (auto& LevelPair : WorldPair.Value.LevelsData)
+		{
+			for (FEssRuntimeActorData& ActorData : LevelPair.Value.RuntimeActorsData)
+			{
+				if (ActorData.Guid != RuntimeGuid)
+					continue;
+
+				EssLegacyComponentTests::WriteLegacyByteData(RuntimeActor, ActorData.ByteData, ActorData.ComponentsData, ActorData.ReferenceIndices);
+				++NumRewritten;
+			}
+
+			if (FEssPlacedActorData* ActorData = LevelPair.Value.PlacedActorsData.Find(TEXT("EssTestPlaced")))
+			{
+				EssLegacyComponentTests::WriteLegacyByteData(PlacedActor, ActorData->ByteData, ActorData->ComponentsData, ActorData->ReferenceIndices);
+				++NumRewritten;
+			}
+		}
+	}
+
+	if (!TestEqual(TEXT("Records rewritten"), NumRewritten, 2))
+		return false;
+
+	if (!TestTrue(TEXT("Save game written"), UGameplayStatics::SaveGameToMemory(SaveGame, SlotBytes)) ||
+		!TestTrue(TEXT("Slot written"), FEssStorage::Get()->Write(EssTests::SlotName, 0, SlotBytes)))
+	{
+		return false;
+	}
+
+	RuntimeActor->Value = 100;
+	RuntimeActor->Component->Value = 100;
+	PlacedActor->Value = 200;
+	PlacedActor->Component->Value = 200;
+
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	// The components continue the actor's stream, without component records
+	const AEssTestActor* RestoredRuntimeActor = TestWorld.FindActor(RuntimeGuid);
+	if (TestNotNull(TEXT("Runtime actor respawned"), RestoredRuntimeActor))
+	{
+		TestEqual(TEXT("Runtime actor value"), RestoredRuntimeActor->Value, 1);
+		TestEqual(TEXT("Runtime actor component value"), RestoredRuntimeActor->Component->Value, 10);
+	}
+
+	TestEqual(TEXT("Placed actor value"), PlacedActor->Value, 2);
+	TestEqual(TEXT("Placed actor component value"), PlacedActor->Component->Value, 20);
+
+	return true;
+}
+
+#endif
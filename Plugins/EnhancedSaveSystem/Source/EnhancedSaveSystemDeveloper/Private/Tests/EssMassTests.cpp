@@ -0,0 +1,119 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssMass.h"
+#include "EssSaveData.h"
+#include "EssSettings.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Engine/World.h"
+#include "MassEntityManager.h"
+#include "MassEntityQuery.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutionContext.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssMassTests
+{
+	FMassEntityHandle CreateEntity(FMassEntityManager& EntityManager, const FMassArchetypeHandle& Archetype, const int32 Value)
+	{
+		const FMassEntityHandle Entity = EntityManager.CreateEntity(Archetype);
+		FEssTestPodFragment& PodFragment = EntityManager.GetFragmentDataChecked<FEssTestPodFragment>(Entity);
+		PodFragment.Value = Value;
+		PodFragment.Location = FVector(Value, 0.f, 0.f);
+		EntityManager.GetFragmentDataChecked<FEssTestNameFragment>(Entity).Name = FString::Printf(TEXT("Entity%d"), Value);
+		return Entity;
+	}
+
+	/**
+	 * @return Values and names of all entities with both test fragments, sorted by value.
+	 */
+	TArray<TPair<int32, FString>> GetEntities(FMassEntityManager& EntityManager)
+	{
+		TArray<TPair<int32, FString>> Entities;
+
+		FMassEntityQuery Query(EntityManager.AsShared());
+		Query.AddRequirement<FEssTestPodFragment>(EMassFragmentAccess::ReadOnly);
+		Query.AddRequirement<FEssTestNameFragment>(EMassFragmentAccess::ReadOnly);
+
+		FMassExecutionContext ExecutionContext(EntityManager);
+		Query.ForEachEntityChunk(EntityManager, ExecutionContext, [&Entities](FMassExecutionContext& Context)
+		{
+			const TConstArrayView<FEssTestPodFragment> PodFragments = Context.GetFragmentView<FEssTestPodFragment>();
+			const TConstArrayView<FEssTestNameFragment> NameFragments = Context.GetFragmentView<FEssTestNameFragment>();
+			for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+			{
+				// The location is only checked against the value, so a broken raw copy doesn't go unnoticed
+				const int32 Value = PodFragments[i].Location.X == PodFragments[i].Value ? PodFragments[i].Value : INDEX_NONE;
+				Entities.Emplace(Value, NameFragments[i].Name);
+			}
+		});
+
+		Entities.Sort([](const TPair<int32, FString>& A, const TPair<int32, FString>& B) { return A.Key < B.Key; });
+		return Entities;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssMassRoundTripTest, "EnhancedSaveSystem.RoundTrip.Mass",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssMassRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace EssMassTests;
+
+	TGuardValue<TArray<FSoftObjectPath>> MassFragments(GetMutableDefault<UEssSettings>()->MassFragments,
+		{ FSoftObjectPath(FEssTestPodFragment::StaticStruct()), FSoftObjectPath(FEssTestNameFragment::StaticStruct()) });
+
+	EssTests::FTestWorld TestWorld;
+
+	UMassEntitySubsystem* EntitySubsystem = TestWorld.World->GetSubsystem<UMassEntitySubsystem>();
+	if (!TestNotNull(TEXT("Mass entity subsystem"), EntitySubsystem))
+		return false;
+
+	FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+	const FMassArchetypeHandle Archetype = EntityManager.CreateArchetype({ FEssTestPodFragment::StaticStruct(), FEssTestNameFragment::StaticStruct() });
+
+	TArray<FMassEntityHandle> Entities;
+	for (int32 Value = 1; Value <= 3; ++Value)
+		Entities.Add(CreateEntity(EntityManager, Archetype, Value));
+
+	// One column of the archetype is copied as raw bytes, the other is serialized value by value
+	TArray<FEssMassArchetypeData> ArchetypesData;
+	if (!TestEqual(TEXT("Entities extracted"), FEssMass::Extract(TestWorld.World, ArchetypesData), 3) || !TestEqual(TEXT("Archetypes extracted"), ArchetypesData.Num(), 1))
+		return false;
+
+	for (const FEssMassFragmentData& FragmentData : ArchetypesData[0].FragmentsData)
+	{
+		if (FragmentData.Struct == FSoftObjectPath(FEssTestPodFragment::StaticStruct()))
+			TestTrue(TEXT("Plain old data fragment saved as raw bytes"), FragmentData.bRawBytes);
+		else
+			TestFalse(TEXT("Fragment owning memory serialized"), FragmentData.bRawBytes);
+	}
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	EntityManager.DestroyEntity(Entities[1]);
+	EntityManager.GetFragmentDataChecked<FEssTestNameFragment>(Entities[0]).Name = TEXT("Changed");
+	CreateEntity(EntityManager, Archetype, 4);
+
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	const TArray<TPair<int32, FString>> Expected = { { 1, TEXT("Entity1") }, { 2, TEXT("Entity2") }, { 3, TEXT("Entity3") } };
+	const TArray<TPair<int32, FString>> Restored = GetEntities(EntityManager);
+	if (TestEqual(TEXT("Entities restored"), Restored.Num(), Expected.Num()))
+	{
+		for (int32 i = 0; i < Expected.Num(); ++i)
+		{
+			TestEqual(FString::Printf(TEXT("Entity %d value"), i), Restored[i].Key, Expected[i].Key);
+			TestEqual(FString::Printf(TEXT("Entity %d name"), i), Restored[i].Value, Expected[i].Value);
+		}
+	}
+
+	return true;
+}
+
+#endif
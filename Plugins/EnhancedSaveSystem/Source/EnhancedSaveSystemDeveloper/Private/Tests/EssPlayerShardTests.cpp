@@ -0,0 +1,59 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssPlayerShardTest, "EnhancedSaveSystem.RoundTrip.PlayerShard",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssPlayerShardTest::RunTest(const FString& Parameters)
+{
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestPlayerState* PlayerState = TestWorld.World->SpawnActor<AEssTestPlayerState>();
+	PlayerState->EssGuid = FGuid::NewGuid();
+
+	// Owners are set after spawning, like items handed to a player during play
+	AEssTestActor* Item = TestWorld.SpawnRuntimeActor(1);
+	AEssTestActor* NestedItem = TestWorld.SpawnRuntimeActor(2);
+	AEssTestActor* WorldActor = TestWorld.SpawnRuntimeActor(3);
+	const FGuid ItemGuid = Item->EssGuid;
+	const FGuid NestedItemGuid = NestedItem->EssGuid;
+
+	// Registers the world's actors before their owners change
+	TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0));
+
+	Item->SetOwner(PlayerState);
+	NestedItem->SetOwner(Item);
+
+	const FString PlayerId = UEssSubsystem::GetPlayerId(PlayerState);
+	if (!TestTrue(TEXT("Player saved"), TestWorld.Subsystem->SavePlayer(PlayerState, {}, EssTests::SlotName)))
+		return false;
+
+	Item->Value = 10;
+	NestedItem->Value = 20;
+	WorldActor->Value = 30;
+
+	if (TestTrue(TEXT("Player loaded"), TestWorld.Subsystem->LoadPlayer(PlayerState, {}, EssTests::SlotName)))
+	{
+		const AEssTestActor* LoadedItem = TestWorld.FindActor(ItemGuid);
+		if (TestNotNull(TEXT("Item found"), LoadedItem))
+			TestEqual(TEXT("Item value"), LoadedItem->Value, 1);
+
+		const AEssTestActor* LoadedNestedItem = TestWorld.FindActor(NestedItemGuid);
+		if (TestNotNull(TEXT("Nested item found"), LoadedNestedItem))
+			TestEqual(TEXT("Nested item value"), LoadedNestedItem->Value, 2);
+
+		TestEqual(TEXT("Actor not owned by the player left alone"), WorldActor->Value, 30);
+	}
+
+	TestWorld.Subsystem->DeletePlayerSave(PlayerId, EssTests::SlotName);
+	return true;
+}
+
+#endif
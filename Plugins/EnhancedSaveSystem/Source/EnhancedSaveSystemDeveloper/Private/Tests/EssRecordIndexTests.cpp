@@ -0,0 +1,57 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssRecordIndex.h"
+#include "EssSettings.h"
+#include "EssStorage.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssStaleRecordIndexTest, "EnhancedSaveSystem.RoundTrip.StaleRecordIndex",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssStaleRecordIndexTest::RunTest(const FString& Parameters)
+{
+	TGuardValue<bool> WriteRecordIndex(GetMutableDefault<UEssSettings>()->bWriteRecordIndex, true);
+
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestActor* Actor = TestWorld.SpawnRuntimeActor(1);
+	const FGuid Guid = Actor->EssGuid;
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	TestWorld.Subsystem->WaitForRecordIndexWrites();
+	TestTrue(TEXT("Record index written"), FEssStorage::Get()->DoesSlotExist(FEssRecordIndex::GetSlotName(EssTests::SlotName), 0));
+
+	TArray<uint8> FirstSlotBytes;
+	if (!TestTrue(TEXT("Slot read"), FEssStorage::Get()->Read(EssTests::SlotName, 0, FirstSlotBytes)))
+		return false;
+
+	Actor->Value = 2;
+	if (!TestTrue(TEXT("World saved again"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	TestWorld.Subsystem->WaitForRecordIndexWrites();
+
+	// Put the first save back without its index, the index now describes a different slot
+	if (!TestTrue(TEXT("Slot overwritten"), FEssStorage::Get()->Write(EssTests::SlotName, 0, FirstSlotBytes)))
+		return false;
+
+	TestWorld.FindActor(Guid)->Value = 3;
+
+	if (!TestTrue(TEXT("Actor loaded"), TestWorld.Subsystem->LoadActorByGuid(Guid, EssTests::SlotName)))
+		return false;
+
+	const AEssTestActor* LoadedActor = TestWorld.FindActor(Guid);
+	if (TestNotNull(TEXT("Actor found"), LoadedActor))
+		TestEqual(TEXT("Actor value read from the slot instead of the stale index"), LoadedActor->Value, 1);
+
+	return true;
+}
+
+#endif
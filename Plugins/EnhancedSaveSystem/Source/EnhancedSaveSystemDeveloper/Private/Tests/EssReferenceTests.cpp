@@ -0,0 +1,74 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSaveArchive.h"
+#include "EssSettings.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "EssUtil.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssReferenceFixupTest, "EnhancedSaveSystem.RoundTrip.ReferenceFixup",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssReferenceFixupTest::RunTest(const FString& Parameters)
+{
+	TGuardValue<bool> WriteRecordIndex(GetMutableDefault<UEssSettings>()->bWriteRecordIndex, true);
+
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestActor* ReferencingActor = TestWorld.SpawnRuntimeActor(1);
+	AEssTestActor* ReferencedActor = TestWorld.SpawnRuntimeActor(2);
+	AEssTestActor* PlacedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestPlaced"), 3);
+	const FGuid ReferencingGuid = ReferencingActor->EssGuid;
+	const FGuid ReferencedGuid = ReferencedActor->EssGuid;
+
+	ReferencingActor->Reference = ReferencedActor;
+	ReferencedActor->Reference = PlacedActor;
+	PlacedActor->Reference = ReferencedActor;
+
+	// Making a reference must not hand out GUIDs, only saving an actor gives it one
+	AEssTestActor* UnsavedActor = TestWorld.SpawnRuntimeActor(4);
+	UnsavedActor->EssGuid = FGuid();
+	FEssObjectReference Reference;
+	TestFalse(TEXT("Runtime actor without a GUID is referenced by path"), FEssSaveArchive::MakeReference(UnsavedActor, Reference));
+	TestFalse(TEXT("Runtime actor keeps its missing GUID"), UnsavedActor->EssGuid.IsValid());
+	UnsavedActor->Destroy();
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	// The respawned actors are new objects, references have to be fixed up to point at them
+	ReferencingActor->Destroy();
+	ReferencedActor->Destroy();
+	PlacedActor->Reference = nullptr;
+
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	AEssTestActor* LoadedReferencingActor = TestWorld.FindActor(ReferencingGuid);
+	AEssTestActor* LoadedReferencedActor = TestWorld.FindActor(ReferencedGuid);
+	if (!TestNotNull(TEXT("Referencing actor respawned"), LoadedReferencingActor) || !TestNotNull(TEXT("Referenced actor respawned"), LoadedReferencedActor))
+		return false;
+
+	TestTrue(TEXT("Runtime actor refers to the respawned runtime actor"), LoadedReferencingActor->Reference == LoadedReferencedActor);
+	TestTrue(TEXT("Runtime actor refers to the placed actor"), LoadedReferencedActor->Reference == PlacedActor);
+	TestTrue(TEXT("Placed actor refers to the respawned runtime actor"), PlacedActor->Reference == LoadedReferencedActor);
+
+	// Single records read through the record index look up the reference table of their level
+	LoadedReferencingActor->Reference = nullptr;
+	if (TestTrue(TEXT("Referencing actor loaded"), TestWorld.Subsystem->LoadActorByGuid(ReferencingGuid, EssTests::SlotName)))
+		TestTrue(TEXT("Reference restored by LoadActorByGuid"), LoadedReferencingActor->Reference == LoadedReferencedActor);
+
+	const FString LevelName = EssUtil::GetLevelName(TestWorld.World->PersistentLevel);
+	PlacedActor->Reference = nullptr;
+	if (TestTrue(TEXT("Placed actor loaded"), TestWorld.Subsystem->LoadPlacedActor(LevelName, TEXT("EssTestPlaced"), EssTests::SlotName)))
+		TestTrue(TEXT("Reference restored by LoadPlacedActor"), PlacedActor->Reference == LoadedReferencedActor);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,204 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSaveData.h"
+#include "EssSaveGame.h"
+#include "EssSettings.h"
+#include "EssSpatialGrid.h"
+#include "EssStorage.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "EssUtil.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssRegionTests
+{
+	const FBox Region(FVector(-500.f, -500.f, -500.f), FVector(500.f, 500.f, 500.f));
+	const FVector Inside(100.f, 100.f, 0.f);
+	const FVector Outside(5000.f, 0.f, 0.f);
+
+	/**
+	 * @return Record of the test world's persistent level in the test slot as it's stored, null if there is none.
+	 */
+	const FEssLevelData* ReadLevelData(const EssTests::FTestWorld& TestWorld)
+	{
+		TArray<uint8> SlotBytes;
+		if (!FEssStorage::Get()->Read(EssTests::SlotName, 0, SlotBytes))
+			return nullptr;
+
+		const UEssSaveGame* SaveGame = Cast<UEssSaveGame>(UGameplayStatics::LoadGameFromMemory(SlotBytes));
+		const FEssSaveData* SaveData = SaveGame ? SaveGame->SaveData.Find(EssTests::SlotName) : nullptr;
+		const FEssWorldData* WorldData = SaveData ? SaveData->WorldsData.Find(TestWorld.World->GetFName().ToString()) : nullptr;
+		return WorldData ? WorldData->LevelsData.Find(EssUtil::GetLevelName(TestWorld.World->PersistentLevel)) : nullptr;
+	}
+
+	int32 GetNumUsedReferences(const FEssLevelData& LevelData)
+	{
+		int32 Num = 0;
+		for (const FEssObjectReference& Reference : LevelData.ObjectReferences)
+		{
+			if (Reference != FEssObjectReference())
+				++Num;
+		}
+
+		return Num;
+	}
+
+	void AddRuntimeRecord(FEssLevelData& LevelData, const FVector& Location)
+	{
+		FEssRuntimeActorData& ActorData = LevelData.RuntimeActorsData.AddDefaulted_GetRef();
+		ActorData.Guid = FGuid::NewGuid();
+		ActorData.Transform.SetLocation(Location);
+	}
+
+	void AddPlacedRecord(FEssLevelData& LevelData, const FName Name, const FVector& Location)
+	{
+		FEssPlacedActorData& ActorData = LevelData.PlacedActorsData.Add(Name);
+		ActorData.Name = Name;
+		ActorData.Transform.SetLocation(Location);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssRegionRoundTripTest, "EnhancedSaveSystem.RoundTrip.Region",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssRegionRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace EssRegionTests;
+
+	TGuardValue<float> RegionCellSize(GetMutableDefault<UEssSettings>()->RegionCellSize, 1000.f);
+
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestActor* InsideRuntimeActor = TestWorld.SpawnRuntimeActor(1, Inside);
+	AEssTestActor* OutsideRuntimeActor = TestWorld.SpawnRuntimeActor(2, Outside);
+	AEssTestActor* InsidePlacedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestPlacedInside"), 3, Inside);
+	AEssTestActor* OutsidePlacedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestPlacedOutside"), 4, Outside);
+	const FGuid InsideGuid = InsideRuntimeActor->EssGuid;
+	const FGuid OutsideGuid = OutsideRuntimeActor->EssGuid;
+
+	// One reference from within the region which the region save drops, and one from outside which it must keep
+	InsidePlacedActor->Reference = OutsideRuntimeActor;
+	OutsidePlacedActor->Reference = InsideRuntimeActor;
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	const FEssLevelData* WorldLevelData = ReadLevelData(TestWorld);
+	if (!TestNotNull(TEXT("Level record read"), WorldLevelData))
+		return false;
+
+	TestEqual(TEXT("References of the world save"), GetNumUsedReferences(*WorldLevelData), 2);
+
+	InsideRuntimeActor->Value = 10;
+	OutsideRuntimeActor->Value = 20;
+	InsidePlacedActor->Value = 30;
+	OutsidePlacedActor->Value = 40;
+	InsidePlacedActor->Reference = nullptr;
+
+	if (!TestTrue(TEXT("Region saved"), TestWorld.Subsystem->SaveRegion(Region, EssTests::SlotName, 0)))
+		return false;
+
+	const FEssLevelData* RegionLevelData = ReadLevelData(TestWorld);
+	if (!TestNotNull(TEXT("Level record read after the region save"), RegionLevelData))
+		return false;
+
+	TestEqual(TEXT("Runtime records after the region save"), RegionLevelData->RuntimeActorsData.Num(), 2);
+	TestEqual(TEXT("Placed records after the region save"), RegionLevelData->PlacedActorsData.Num(), 2);
+	TestEqual(TEXT("Dropped reference pruned from the table"), GetNumUsedReferences(*RegionLevelData), 1);
+
+	InsideRuntimeActor->Value = 100;
+	OutsideRuntimeActor->Value = 200;
+	InsidePlacedActor->Value = 300;
+	OutsidePlacedActor->Value = 400;
+
+	// Runtime actors without a record are destroyed within the region only
+	const FGuid NewInsideGuid = TestWorld.SpawnRuntimeActor(5, Inside)->EssGuid;
+	const FGuid NewOutsideGuid = TestWorld.SpawnRuntimeActor(6, Outside)->EssGuid;
+
+	if (!TestTrue(TEXT("Region loaded"), TestWorld.Subsystem->LoadRegion(Region, EssTests::SlotName, 0)))
+		return false;
+
+	const AEssTestActor* RestoredInsideActor = TestWorld.FindActor(InsideGuid);
+	if (TestNotNull(TEXT("Runtime actor inside the region restored"), RestoredInsideActor))
+		TestEqual(TEXT("Runtime actor inside the region value"), RestoredInsideActor->Value, 10);
+
+	TestEqual(TEXT("Placed actor inside the region value"), InsidePlacedActor->Value, 30);
+	TestNull(TEXT("New runtime actor inside the region destroyed"), TestWorld.FindActor(NewInsideGuid));
+
+	TestEqual(TEXT("Runtime actor outside the region untouched"), OutsideRuntimeActor->Value, 200);
+	TestEqual(TEXT("Placed actor outside the region untouched"), OutsidePlacedActor->Value, 400);
+	TestNotNull(TEXT("New runtime actor outside the region kept"), TestWorld.FindActor(NewOutsideGuid));
+
+	// Records outside of the region are still the ones of the world save
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	const AEssTestActor* LoadedInsideActor = TestWorld.FindActor(InsideGuid);
+	const AEssTestActor* LoadedOutsideActor = TestWorld.FindActor(OutsideGuid);
+	if (!TestNotNull(TEXT("Runtime actor inside the region loaded"), LoadedInsideActor) || !TestNotNull(TEXT("Runtime actor outside the region loaded"), LoadedOutsideActor))
+		return false;
+
+	TestEqual(TEXT("Runtime actor inside the region value from the region save"), LoadedInsideActor->Value, 10);
+	TestEqual(TEXT("Runtime actor outside the region value from the world save"), LoadedOutsideActor->Value, 2);
+	TestEqual(TEXT("Placed actor inside the region value from the region save"), InsidePlacedActor->Value, 30);
+	TestEqual(TEXT("Placed actor outside the region value from the world save"), OutsidePlacedActor->Value, 4);
+	TestNull(TEXT("Dropped reference stays dropped"), InsidePlacedActor->Reference.Get());
+	TestTrue(TEXT("Kept reference resolves to the respawned actor"), OutsidePlacedActor->Reference == LoadedInsideActor);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssRegionGridBoundaryTest, "EnhancedSaveSystem.Region.GridBoundary",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssRegionGridBoundaryTest::RunTest(const FString& Parameters)
+{
+	using namespace EssRegionTests;
+
+	FEssLevelData LevelData;
+	AddRuntimeRecord(LevelData, FVector(99.9f, 10.f, 0.f));    // 0: last cell before the bounds
+	AddRuntimeRecord(LevelData, FVector(100.f, 10.f, 0.f));    // 1: on the minimum, first cell of the bounds
+	AddRuntimeRecord(LevelData, FVector(200.f, 50.f, 0.f));    // 2: on the maximum corner, which starts the next cell
+	AddRuntimeRecord(LevelData, FVector(150.f, 10.f, 5000.f)); // 3: in a cell of the bounds, above them
+	AddRuntimeRecord(LevelData, FVector(-50.f, 10.f, 0.f));    // 4: negative cell
+	AddPlacedRecord(LevelData, TEXT("OnMaximum"), FVector(200.f, 0.f, 0.f));
+	AddPlacedRecord(LevelData, TEXT("PastMaximum"), FVector(200.1f, 0.f, 0.f));
+
+	const FBox Bounds(FVector(100.f, 0.f, -100.f), FVector(200.f, 50.f, 100.f));
+
+	FEssSpatialGrid::Build(LevelData, 100.f);
+
+	TArray<int32> RuntimeActors;
+	TArray<FName> PlacedActors;
+	FEssSpatialGrid::FindRecords(LevelData, Bounds, RuntimeActors, PlacedActors);
+	RuntimeActors.Sort();
+
+	TestEqual(TEXT("Runtime records on the bounds found"), RuntimeActors, TArray<int32>({ 1, 2 }));
+	TestEqual(TEXT("Placed records on the bounds found"), PlacedActors, TArray<FName>({ TEXT("OnMaximum") }));
+
+	// Bounds covering a negative cell only in part
+	RuntimeActors.Reset();
+	PlacedActors.Reset();
+	FEssSpatialGrid::FindRecords(LevelData, FBox(FVector(-60.f, 0.f, -100.f), FVector(-40.f, 20.f, 100.f)), RuntimeActors, PlacedActors);
+	TestEqual(TEXT("Runtime record in a negative cell found"), RuntimeActors, TArray<int32>({ 4 }));
+
+	// Slots without a grid are searched record by record and must find the same records
+	FEssSpatialGrid::Build(LevelData, 0.f);
+
+	TArray<int32> UngriddedRuntimeActors;
+	TArray<FName> UngriddedPlacedActors;
+	FEssSpatialGrid::FindRecords(LevelData, Bounds, UngriddedRuntimeActors, UngriddedPlacedActors);
+	UngriddedRuntimeActors.Sort();
+
+	TestEqual(TEXT("Runtime records found without a grid"), UngriddedRuntimeActors, TArray<int32>({ 1, 2 }));
+	TestEqual(TEXT("Placed records found without a grid"), UngriddedPlacedActors, TArray<FName>({ TEXT("OnMaximum") }));
+
+	return true;
+}
+
+#endif
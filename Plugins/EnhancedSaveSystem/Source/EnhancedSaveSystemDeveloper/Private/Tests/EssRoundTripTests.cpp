@@ -0,0 +1,95 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "EssTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssWorldRoundTripTest, "EnhancedSaveSystem.RoundTrip.World",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssWorldRoundTripTest::RunTest(const FString& Parameters)
+{
+	EssTests::FTestWorld TestWorld;
+
+	AEssTestActor* RuntimeActor = TestWorld.SpawnRuntimeActor(1, FVector(100.0, 0.0, 0.0));
+	RuntimeActor->Component->Value = 10;
+	const FGuid RuntimeGuid = RuntimeActor->EssGuid;
+
+	AEssTestActor* PlacedActor = TestWorld.SpawnPlacedActor(TEXT("EssTestPlaced"), 2);
+	PlacedActor->Component->Value = 20;
+
+	if (!TestTrue(TEXT("World saved"), TestWorld.Subsystem->SaveWorld(EssTests::SlotName, 0)))
+		return false;
+
+	RuntimeActor->Value = 100;
+	RuntimeActor->Component->Value = 100;
+	RuntimeActor->SetActorLocation(FVector(500.0, 0.0, 0.0));
+	PlacedActor->Value = 200;
+	PlacedActor->Component->Value = 200;
+	TWeakObjectPtr<AEssTestActor> UnsavedActor = TestWorld.SpawnRuntimeActor(3);
+
+	if (!TestTrue(TEXT("World loaded"), TestWorld.Subsystem->LoadWorld(EssTests::SlotName, 0)))
+		return false;
+
+	// Respawnable runtime actors are destroyed and spawned again from their records
+	const AEssTestActor* RestoredRuntimeActor = TestWorld.FindActor(RuntimeGuid);
+	if (TestNotNull(TEXT("Runtime actor respawned"), RestoredRuntimeActor))
+	{
+		TestEqual(TEXT("Runtime actor value"), RestoredRuntimeActor->Value, 1);
+		TestEqual(TEXT("Runtime actor component value"), RestoredRuntimeActor->Component->Value, 10);
+		TestEqual(TEXT("Runtime actor location"), RestoredRuntimeActor->GetActorLocation(), FVector(100.0, 0.0, 0.0));
+	}
+
+	TestFalse(TEXT("Runtime actor spawned after the save destroyed"), UnsavedActor.IsValid());
+
+	// Placed actors are restored where they are
+	TestTrue(TEXT("Placed actor kept"), IsValid(PlacedActor));
+	TestEqual(TEXT("Placed actor value"), PlacedActor->Value, 2);
+	TestEqual(TEXT("Placed actor component value"), PlacedActor->Component->Value, 20);
+	TestEqual(TEXT("Number of actors"), TestWorld.GetNumActors(), 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssGlobalObjectRoundTripTest, "EnhancedSaveSystem.RoundTrip.GlobalObject",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssGlobalObjectRoundTripTest::RunTest(const FString& Parameters)
+{
+	EssTests::FTestWorld TestWorld;
+
+	UEssTestObject* Object = NewObject<UEssTestObject>(TestWorld.GameInstance);
+	Object->EssGuid = FGuid::NewGuid();
+	Object->Value = 1;
+	Object->Text = TEXT("Saved");
+
+	UEssTestObject* OtherObject = NewObject<UEssTestObject>(TestWorld.GameInstance);
+	OtherObject->EssGuid = FGuid::NewGuid();
+	OtherObject->Value = 2;
+
+	if (!TestTrue(TEXT("Objects saved"), TestWorld.Subsystem->SaveGlobalObjects({ Object, OtherObject }, EssTests::SlotName)))
+		return false;
+
+	Object->Value = 100;
+	Object->Text = TEXT("Changed");
+	OtherObject->Value = 200;
+
+	if (!TestTrue(TEXT("Object loaded"), TestWorld.Subsystem->LoadGlobalObject(Object, EssTests::SlotName)))
+		return false;
+
+	TestEqual(TEXT("Object value"), Object->Value, 1);
+	TestEqual(TEXT("Object text"), Object->Text, FString(TEXT("Saved")));
+
+	// Loading one object leaves the others alone
+	TestEqual(TEXT("Other object value"), OtherObject->Value, 200);
+
+	if (TestTrue(TEXT("Other object loaded"), TestWorld.Subsystem->LoadGlobalObjects({ OtherObject }, EssTests::SlotName)))
+		TestEqual(TEXT("Other object value"), OtherObject->Value, 2);
+
+	return true;
+}
+
+#endif
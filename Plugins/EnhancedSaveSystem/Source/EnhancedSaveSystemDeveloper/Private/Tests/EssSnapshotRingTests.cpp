@@ -0,0 +1,193 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssSnapshotRing.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssSnapshotRingTests
+{
+	void SetRuntimeActor(FEssLevelData& LevelData, const int32 Id, const uint8 Value)
+	{
+		const FGuid Guid(Id, 0, 0, 0);
+		FEssRuntimeActorData* ActorData = LevelData.RuntimeActorsData.FindByPredicate([&Guid](const FEssRuntimeActorData& Data) { return Data.Guid == Guid; });
+		if (!ActorData)
+		{
+			ActorData = &LevelData.RuntimeActorsData.AddDefaulted_GetRef();
+			ActorData->Guid = Guid;
+		}
+
+		ActorData->ByteData = { Value };
+	}
+
+	void RemoveRuntimeActor(FEssLevelData& LevelData, const int32 Id)
+	{
+		LevelData.RuntimeActorsData.RemoveAll([Guid = FGuid(Id, 0, 0, 0)](const FEssRuntimeActorData& Data) { return Data.Guid == Guid; });
+	}
+
+	void SetPlacedActor(FEssLevelData& LevelData, const FName Name, const uint8 Value)
+	{
+		FEssPlacedActorData& ActorData = LevelData.PlacedActorsData.FindOrAdd(Name);
+		ActorData.Name = Name;
+		ActorData.ByteData = { Value };
+	}
+
+	FEssLevelData& AddLevel(FEssWorldData& WorldData, const FString& Name)
+	{
+		FEssLevelData& LevelData = WorldData.LevelsData.Add(Name);
+		LevelData.Name = Name;
+		return LevelData;
+	}
+
+	void SetNumEntities(FEssWorldData& WorldData, const int32 NumEntities)
+	{
+		WorldData.MassArchetypesData.SetNum(1);
+		WorldData.MassArchetypesData[0].NumEntities = NumEntities;
+	}
+
+	/**
+	 * Compares records by key, as applying deltas doesn't keep the order of the records.
+	 */
+	bool AreEqual(const FEssWorldData& A, const FEssWorldData& B, FString& OutDifference)
+	{
+		if (A.Name != B.Name || A.LevelsData.Num() != B.LevelsData.Num())
+		{
+			OutDifference = TEXT("Levels differ");
+			return false;
+		}
+
+		if (A.MassArchetypesData.Num() != B.MassArchetypesData.Num() ||
+			(A.MassArchetypesData.Num() > 0 && A.MassArchetypesData[0].NumEntities != B.MassArchetypesData[0].NumEntities))
+		{
+			OutDifference = TEXT("Mass entities differ");
+			return false;
+		}
+
+		for (const auto& LevelPair : A.LevelsData)
+		{
+			const FEssLevelData& LevelA = LevelPair.Value;
+			const FEssLevelData* LevelB = B.LevelsData.Find(LevelPair.Key);
+			if (!LevelB || LevelA.DestroyedPlacedActors != LevelB->DestroyedPlacedActors)
+			{
+				OutDifference = FString::Printf(TEXT("Level %s differs"), *LevelPair.Key);
+				return false;
+			}
+
+			if (LevelA.RuntimeActorsData.Num() != LevelB->RuntimeActorsData.Num() || LevelA.PlacedActorsData.Num() != LevelB->PlacedActorsData.Num())
+			{
+				OutDifference = FString::Printf(TEXT("Number of actors of level %s differs"), *LevelPair.Key);
+				return false;
+			}
+
+			for (const FEssRuntimeActorData& ActorA : LevelA.RuntimeActorsData)
+			{
+				const FEssRuntimeActorData* ActorB = LevelB->RuntimeActorsData.FindByPredicate([&ActorA](const FEssRuntimeActorData& Data) { return Data.Guid == ActorA.Guid; });
+				if (!ActorB || !ActorA.HasSameState(*ActorB))
+				{
+					OutDifference = FString::Printf(TEXT("Runtime actor %s differs"), *ActorA.Guid.ToString());
+					return false;
+				}
+			}
+
+			for (const auto& PlacedPair : LevelA.PlacedActorsData)
+			{
+				const FEssPlacedActorData* ActorB = LevelB->PlacedActorsData.Find(PlacedPair.Key);
+				if (!ActorB || !PlacedPair.Value.HasSameState(*ActorB))
+				{
+					OutDifference = FString::Printf(TEXT("Placed actor %s differs"), *PlacedPair.Key.ToString());
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEssSnapshotRingTest, "EnhancedSaveSystem.Snapshots.DeltaApplyAndEvict",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEssSnapshotRingTest::RunTest(const FString& Parameters)
+{
+	using namespace EssSnapshotRingTests;
+
+	constexpr int32 Capacity = 3;
+
+	FEssSnapshotRing Ring;
+	Ring.SetCapacity(Capacity);
+
+	// Every step changes the world in a different way, each snapshot after the first only holds the changes
+	TArray<FEssWorldData> Worlds;
+
+	FEssWorldData WorldData;
+	WorldData.Name = TEXT("EssTestWorld");
+	FEssLevelData& FirstLevel = AddLevel(WorldData, TEXT("First"));
+	SetRuntimeActor(FirstLevel, 1, 1);
+	SetRuntimeActor(FirstLevel, 2, 2);
+	SetPlacedActor(FirstLevel, TEXT("PlacedA"), 1);
+	SetPlacedActor(FirstLevel, TEXT("PlacedB"), 2);
+	SetRuntimeActor(AddLevel(WorldData, TEXT("Second")), 3, 3);
+	SetNumEntities(WorldData, 10);
+	Worlds.Add(WorldData);
+
+	// Changed, removed and added actors
+	SetRuntimeActor(WorldData.LevelsData[TEXT("First")], 1, 10);
+	RemoveRuntimeActor(WorldData.LevelsData[TEXT("First")], 2);
+	SetRuntimeActor(WorldData.LevelsData[TEXT("First")], 4, 4);
+	WorldData.LevelsData[TEXT("First")].PlacedActorsData.Remove(TEXT("PlacedA"));
+	SetPlacedActor(WorldData.LevelsData[TEXT("First")], TEXT("PlacedC"), 3);
+	SetNumEntities(WorldData, 11);
+	Worlds.Add(WorldData);
+
+	// Removed and added levels
+	WorldData.LevelsData.Remove(TEXT("Second"));
+	SetRuntimeActor(AddLevel(WorldData, TEXT("Third")), 5, 5);
+	SetPlacedActor(WorldData.LevelsData[TEXT("First")], TEXT("PlacedB"), 20);
+	Worlds.Add(WorldData);
+
+	// Changed level header only
+	WorldData.LevelsData[TEXT("First")].DestroyedPlacedActors.Add(TEXT("PlacedD"));
+	SetRuntimeActor(WorldData.LevelsData[TEXT("First")], 4, 40);
+	SetNumEntities(WorldData, 0);
+	Worlds.Add(WorldData);
+
+	// A level which was removed comes back, nothing else changes
+	SetRuntimeActor(AddLevel(WorldData, TEXT("Second")), 3, 30);
+	Worlds.Add(WorldData);
+
+	TArray<int32> Ids;
+	for (int32 Step = 0; Step < Worlds.Num(); ++Step)
+	{
+		Ids.Add(Ring.Add(CopyTemp(Worlds[Step])));
+		TestEqual(FString::Printf(TEXT("Number of snapshots after step %d"), Step), Ring.Num(), FMath::Min(Step + 1, Capacity));
+
+		// Every snapshot still in the ring is rebuilt from the keyframe and the deltas after it, including after evictions
+		for (int32 i = 0; i <= Step; ++i)
+		{
+			const bool bEvicted = i <= Step - Capacity;
+			TestEqual(FString::Printf(TEXT("Snapshot %d contained after step %d"), i, Step), Ring.Contains(Ids[i]), !bEvicted);
+			if (bEvicted)
+				continue;
+
+			FEssWorldData Scratch;
+			const FEssWorldData* Snapshot = Ring.Get(Ids[i], Scratch);
+			if (!TestNotNull(FString::Printf(TEXT("Snapshot %d after step %d"), i, Step), Snapshot))
+				continue;
+
+			FString Difference;
+			if (!AreEqual(*Snapshot, Worlds[i], Difference))
+				AddError(FString::Printf(TEXT("Snapshot %d after step %d: %s."), i, Step, *Difference));
+		}
+	}
+
+	// Another world drops the snapshots of the previous one
+	FEssWorldData OtherWorldData;
+	OtherWorldData.Name = TEXT("EssOtherWorld");
+	Ring.Add(MoveTemp(OtherWorldData));
+	TestEqual(TEXT("Number of snapshots after changing worlds"), Ring.Num(), 1);
+	TestFalse(TEXT("Snapshot of the previous world dropped"), Ring.Contains(Ids.Last()));
+
+	return true;
+}
+
+#endif
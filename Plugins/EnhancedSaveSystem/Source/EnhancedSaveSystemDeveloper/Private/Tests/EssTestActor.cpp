@@ -0,0 +1,11 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssTestActor.h"
+#include "Components/SceneComponent.h"
+
+AEssTestActor::AEssTestActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	Component = CreateDefaultSubobject<UEssTestComponent>(TEXT("TestComponent"));
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerState.h"
+#include "MassEntityTypes.h"
+#include "EssSavableInterface.h"
+#include "EssTestActor.generated.h"
+
+/**
+ * Savable component of AEssTestActor.
+ */
+UCLASS(NotBlueprintable, Transient)
+class UEssTestComponent : public UActorComponent, public IEssSavableInterface
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(SaveGame)
+	int32 Value = 0;
+};
+
+/**
+ * Savable actor used by the automation tests. Spawned as a runtime actor, or as a placed actor by setting RF_WasLoaded.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class AEssTestActor : public AActor, public IEssSavableInterface
+{
+	GENERATED_BODY()
+
+public:
+	AEssTestActor();
+
+	UPROPERTY()
+	FGuid EssGuid;
+
+	UPROPERTY(SaveGame)
+	int32 Value = 0;
+
+	UPROPERTY(SaveGame)
+	TObjectPtr<AActor> Reference;
+
+	UPROPERTY()
+	TObjectPtr<UEssTestComponent> Component;
+
+	/** Returned by GetRestorePriority. */
+	UPROPERTY()
+	int32 RestorePriority = 0;
+
+	virtual int32 GetRestorePriority_Implementation() const override { return RestorePriority; }
+};
+
+/**
+ * PlayerState identified by its EssGuid, as the test world has no online subsystem to give it a unique net id.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class AEssTestPlayerState : public APlayerState
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	FGuid EssGuid;
+};
+
+/**
+ * Savable global object used by the automation tests.
+ */
+UCLASS(NotBlueprintable, Transient)
+class UEssTestObject : public UObject, public IEssSavableInterface
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	FGuid EssGuid;
+
+	UPROPERTY(SaveGame)
+	int32 Value = 0;
+
+	UPROPERTY(SaveGame)
+	FString Text;
+};
+
+/**
+ * Receives the dynamic delegates of LoadWorldAsync and forwards them to the test.
+ */
+UCLASS(Transient)
+class UEssTestLoadListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION()
+	void OnPlayable(bool bSucceeded) { OnPlayableCallback(bSucceeded); }
+
+	UFUNCTION()
+	void OnLoaded(bool bSucceeded) { OnLoadedCallback(bSucceeded); }
+
+	TFunction<void(bool)> OnPlayableCallback = [](bool) {};
+	TFunction<void(bool)> OnLoadedCallback = [](bool) {};
+};
+
+/**
+ * Mass fragment of plain old data, saved as raw bytes.
+ */
+USTRUCT()
+struct FEssTestPodFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Value = 0;
+
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+};
+
+template<>
+struct TStructOpsTypeTraits<FEssTestPodFragment> : public TStructOpsTypeTraitsBase2<FEssTestPodFragment>
+{
+	enum
+	{
+		IsPlainOldData = true,
+	};
+};
+
+/**
+ * Mass fragment which owns memory, saved by serializing each value.
+ */
+USTRUCT()
+struct FEssTestNameFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString Name;
+};
@@ -0,0 +1,108 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "EssTestWorld.h"
+
+#include "EssRecordIndex.h"
+#include "EssStorage.h"
+#include "EssSubsystem.h"
+#include "EssTestActor.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EssTests
+{
+	const TCHAR* SlotName = TEXT("EssTest");
+
+	void DeleteSlot()
+	{
+		FEssRecordIndex::Delete(SlotName, 0);
+		if (FEssStorage::Get()->DoesSlotExist(SlotName, 0))
+			FEssStorage::Get()->Delete(SlotName, 0);
+	}
+
+	FTestWorld::FTestWorld()
+	{
+		// A slot left behind by an aborted run would be merged into the first save
+		DeleteSlot();
+
+		GameInstance = NewObject<UGameInstance>(GEngine);
+		GameInstance->AddToRoot();
+		GameInstance->InitializeStandalone(TEXT("EssTestWorld"));
+
+		World = GameInstance->GetWorld();
+		Subsystem = GameInstance->GetSubsystem<UEssSubsystem>();
+	}
+
+	FTestWorld::~FTestWorld()
+	{
+		GameInstance->Shutdown();
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		GameInstance->RemoveFromRoot();
+
+		DeleteSlot();
+	}
+
+	AEssTestActor* FTestWorld::SpawnRuntimeActor(const int32 Value, const FVector& Location)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AEssTestActor* Actor = World->SpawnActor<AEssTestActor>(AEssTestActor::StaticClass(), FTransform(Location), SpawnParams);
+		Actor->EssGuid = FGuid::NewGuid();
+		Actor->Value = Value;
+		return Actor;
+	}
+
+	AEssTestActor* FTestWorld::SpawnPlacedActor(const FName Name, const int32 Value, const FVector& Location)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Name = Name;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AEssTestActor* Actor = World->SpawnActor<AEssTestActor>(AEssTestActor::StaticClass(), FTransform(Location), SpawnParams);
+		Actor->SetFlags(RF_WasLoaded);
+		Actor->Value = Value;
+		return Actor;
+	}
+
+	AEssTestActor* FTestWorld::FindActor(const FGuid& Guid) const
+	{
+		for (TActorIterator<AEssTestActor> It(World); It; ++It)
+		{
+			if (IsValid(*It) && It->EssGuid == Guid)
+				return *It;
+		}
+
+		return nullptr;
+	}
+
+	AEssTestActor* FTestWorld::FindActor(const FName Name) const
+	{
+		for (TActorIterator<AEssTestActor> It(World); It; ++It)
+		{
+			if (IsValid(*It) && It->GetFName() == Name)
+				return *It;
+		}
+
+		return nullptr;
+	}
+
+	int32 FTestWorld::GetNumActors() const
+	{
+		int32 Num = 0;
+		for (TActorIterator<AEssTestActor> It(World); It; ++It)
+		{
+			if (IsValid(*It))
+				++Num;
+		}
+
+		return Num;
+	}
+}
+
+#endif
\ No newline at end of file
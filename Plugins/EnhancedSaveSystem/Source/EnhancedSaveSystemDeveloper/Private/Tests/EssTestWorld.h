@@ -0,0 +1,55 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class AEssTestActor;
+class UEssSubsystem;
+class UGameInstance;
+class UWorld;
+
+namespace EssTests
+{
+	extern const TCHAR* SlotName;
+
+	/**
+	 * Standalone game world with its own save subsystem. The world and the test slot are destroyed when it goes out of scope.
+	 */
+	class FTestWorld
+	{
+	public:
+		FTestWorld();
+		~FTestWorld();
+
+		AEssTestActor* SpawnRuntimeActor(const int32 Value, const FVector& Location = FVector::ZeroVector);
+
+		/**
+		 * Spawns an actor which is treated like an actor loaded with its level.
+		 */
+		AEssTestActor* SpawnPlacedActor(const FName Name, const int32 Value, const FVector& Location = FVector::ZeroVector);
+
+		/**
+		 * @return Live actor with the GUID, which isn't the saved one if the actor has been respawned. Null if there is none.
+		 */
+		AEssTestActor* FindActor(const FGuid& Guid) const;
+
+		/**
+		 * @return Live actor with the name. Null if there is none.
+		 */
+		AEssTestActor* FindActor(const FName Name) const;
+
+		/**
+		 * @return Number of live test actors.
+		 */
+		int32 GetNumActors() const;
+
+		UGameInstance* GameInstance = nullptr;
+		UWorld* World = nullptr;
+		UEssSubsystem* Subsystem = nullptr;
+	};
+}
+
+#endif
@@ -0,0 +1,25 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EssAnalyzeCommandlet.generated.h"
+
+/**
+ * Offline analyzer for ESS slot files.
+ * Reports bytes per world, level, actor class and SaveGame property, the largest records, duplicate blobs and oversized actors.
+ *
+ * Usage: UnrealEditor-Cmd <Project>.uproject -run=EssAnalyze -nullrhi (-Slot=<SlotName> [-UserIndex=0] | -File=<Path>.sav)
+ *        [-Format=Text|Json] [-Top=20] [-OversizedBytes=65536] [-Output=<Path>]
+ */
+UCLASS()
+class UEssAnalyzeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEssAnalyzeCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
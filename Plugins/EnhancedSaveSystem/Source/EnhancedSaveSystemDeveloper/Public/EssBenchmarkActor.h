@@ -0,0 +1,43 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EssSavableInterface.h"
+#include "EssBenchmarkActor.generated.h"
+
+/**
+ * Synthetic savable actor used by the EssBenchmark commandlet to populate levels.
+ * Its SaveGame state size is controlled through the payload.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class ENHANCEDSAVESYSTEMDEVELOPER_API AEssBenchmarkActor : public AActor, public IEssSavableInterface
+{
+	GENERATED_BODY()
+
+public:
+	AEssBenchmarkActor();
+
+	/**
+	 * Fills the SaveGame variables with deterministic data.
+	 * @param Seed Value used to vary the generated state between actors.
+	 * @param PayloadSize Number of payload bytes to generate.
+	 */
+	void InitializeState(const int32 Seed, const int32 PayloadSize);
+
+	UPROPERTY()
+	FGuid EssGuid;
+
+	UPROPERTY(SaveGame)
+	int32 Counter = 0;
+
+	UPROPERTY(SaveGame)
+	FVector Velocity = FVector::ZeroVector;
+
+	UPROPERTY(SaveGame)
+	FName Tag;
+
+	UPROPERTY(SaveGame)
+	TArray<uint8> Payload;
+};
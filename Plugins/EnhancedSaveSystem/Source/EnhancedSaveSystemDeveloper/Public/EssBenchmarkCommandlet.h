@@ -0,0 +1,42 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EssBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+
+/**
+ * Headless benchmark for SaveWorld and LoadWorld.
+ * Populates a game world with synthetic runtime and placed savable actors and writes the results as JSON.
+ *
+ * Usage: UnrealEditor-Cmd <Project>.uproject -run=EssBenchmark -nullrhi -unattended
+ *        [-Counts=1000,10000,100000] [-Iterations=3] [-MinStateBytes=16] [-MaxStateBytes=4096]
+ *        [-PlacedRatio=0.5] [-Output=<Path>.json]
+ */
+UCLASS()
+class UEssBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEssBenchmarkCommandlet();
+
+	int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * Runs all iterations for one actor count in a freshly created world.
+	 * @param ActorCount Number of savable actors to spawn.
+	 * @param bOutSucceeded Set to false if any save or load failed.
+	 * @return Results of this tier.
+	 */
+	TSharedRef<FJsonObject> RunTier(const int32 ActorCount, bool& bOutSucceeded);
+
+	int32 Iterations = 3;
+	int32 MinStateBytes = 16;
+	int32 MaxStateBytes = 4096;
+	float PlacedRatio = 0.5f;
+};